@@ -0,0 +1,34 @@
+-- Behaviours run by the ScriptSystem, one update call per behaviour per frame
+-- with every entity that uses it (see src/Scripting/ScriptEngine.h)
+
+local HOVER_SPEED = 20.0		-- pixels per second at the top of the swing
+local HOVER_PERIOD = 2.0		-- seconds per swing
+
+local hoverTime = 0.0
+
+Behaviours.hover = {
+	update = function(batch, deltaTime)
+		hoverTime = hoverTime + deltaTime
+		local vy = HOVER_SPEED * math.sin(hoverTime * 2.0 * math.pi / HOVER_PERIOD)
+		for i = 1, batch.count do
+			local vx = batch:velocity(i)
+			batch:set_velocity(i, vx, vy)
+		end
+	end
+}
+
+-- Back and forth along x, turning around every PATROL_LEG seconds or when it runs into something
+-- A coroutine per entity: between turns it waits in the engine's timer wheel and costs nothing
+local PATROL_SPEED = 40.0
+local PATROL_LEG = 3.0
+
+Behaviours.patrol = {
+	run = function(entity)
+		local direction = 1
+		while true do
+			entity:set_velocity(direction * PATROL_SPEED, 0)
+			wait(PATROL_LEG)
+			direction = -direction
+		end
+	end
+}
@@ -0,0 +1,58 @@
+-- Level 1, loaded by LevelLoader (see src/LevelLoader/LevelLoader.h for the format)
+-- Window.width and Window.height are set by the engine before this runs
+
+Level = {
+	assets = {
+		{ type = "texture", id = "tank-image", file = "./assets/images/tank-panther-right.png" },
+		{ type = "texture", id = "chopper-image", file = "./assets/images/chopper.png" },
+		{ type = "texture", id = "tilemap-image", file = "./assets/tilemaps/jungle.png" },
+		{ type = "texture", id = "radar-image", file = "./assets/images/radar.png" },
+		{ type = "texture", id = "truck-image", file = "./assets/images/truck-ford-left.png" }
+	},
+
+	scripts = {
+		"./assets/scripts/Behaviours.lua"
+	},
+
+	-- The region map is streamed when it exists, the text map is the fallback
+	tilemap = {
+		map = "./assets/tilemaps/jungle.map",
+		world = "./assets/tilemaps/jungle.vworld"
+	},
+
+	entities = {
+		{ -- tank
+			components = {
+				transform = { position = { x = 20, y = 20 }, scale = { x = 2, y = 2 }, rotation = 0 },
+				rigidbody = { velocity = { x = 20, y = 0 } },
+				sprite = { texture = "tank-image", width = 32, height = 32, z_index = 1 },
+				box_collider = { width = 32, height = 32 }
+			}
+		},
+		{ -- truck
+			components = {
+				transform = { position = { x = 300, y = 20 }, scale = { x = 2, y = 2 }, rotation = 0 },
+				rigidbody = { velocity = { x = -20, y = 0 } },
+				sprite = { texture = "truck-image", width = 32, height = 32, z_index = 1 },
+				box_collider = { width = 32, height = 32 }
+			}
+		},
+		{ -- chopper
+			components = {
+				transform = { position = { x = 520, y = 200 }, scale = { x = 2, y = 2 }, rotation = 0 },
+				rigidbody = { velocity = { x = 0, y = 0 } },
+				sprite = { texture = "chopper-image", width = 32, height = 32, z_index = 2 },
+				animation = { frames = 2, frame_rate = 15, looping = true },
+				script = { behaviour = "hover" }
+			}
+		},
+		{ -- radar screen
+			components = {
+				transform = { position = { x = Window.width - 3 * 64, y = Window.height - 3 * 64 }, scale = { x = 2, y = 2 }, rotation = 0 },
+				rigidbody = { velocity = { x = 0, y = 0 } },
+				sprite = { texture = "radar-image", width = 64, height = 64, z_index = 3 },
+				animation = { frames = 8, frame_rate = 8, looping = true }
+			}
+		}
+	}
+}
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <functional>
+#include <chrono>
+#include <cstddef>
+
+////////////////////////////////////////////////////////////////////////////////
+/// BENCHMARK HARNESS
+////////////////////////////////////////////////////////////////////////////////
+/// Every case is warmed up once, then run until it has MIN_SAMPLES samples and
+/// MIN_DURATION_MS of total runtime. The median sample is reported, per run and
+/// per item, as a table on stdout and optionally as JSON (--json <file>) so runs
+/// can be diffed between commits.
+////////////////////////////////////////////////////////////////////////////////
+const int		BENCHMARK_MIN_SAMPLES		= 5;
+const double	BENCHMARK_MIN_DURATION_MS	= 200.0;
+
+struct BenchmarkResult {
+	std::string group;
+	std::string name;
+	size_t items;				// work items per run (tiles, entities, events...)
+	int samples;
+	double medianNs;			// per run
+	double minNs;
+	double nsPerItem;			// median / items
+};
+
+// Keeps the optimizer from dropping a result that is never read
+template <typename T>
+inline void DoNotOptimize(const T& value) {
+#if defined(__GNUC__) || defined(__clang__)
+	asm volatile("" : : "g"(&value) : "memory");
+#else
+	static volatile const void* sink;
+	sink = &value;
+#endif
+}
+
+// Size part of a case name: 1000 -> "1k", 1000000 -> "1M", so --filter 1k matches every group
+inline std::string SizeLabel(size_t count) {
+	if (count >= 1000000 && count % 1000000 == 0) {
+		return std::to_string(count / 1000000) + "M";
+	}
+	if (count >= 1000 && count % 1000 == 0) {
+		return std::to_string(count / 1000) + "k";
+	}
+	return std::to_string(count);
+}
+
+class BenchmarkSuite {
+private:
+	std::string filter;
+	std::vector<BenchmarkResult> results;
+
+public:
+	explicit BenchmarkSuite(std::string filter = "");
+
+	// Runs body repeatedly (skipped if group/name doesn't contain the filter)
+	// reset runs untimed before every sample, e.g. to drain a queue the body fills
+	void Run(const std::string& group, const std::string& name, size_t items, const std::function<void()>& body, const std::function<void()>& reset = nullptr);
+
+	const std::vector<BenchmarkResult>& GetResults() const { return results; }
+	bool WriteJson(const std::string& filepath) const;
+};
+
+/// Benchmark groups, one per file
+void RunMapParserBenchmarks(BenchmarkSuite& suite);
+void RunLoggerBenchmarks(BenchmarkSuite& suite);
+void RunEventBenchmarks(BenchmarkSuite& suite);
+void RunProfilerBenchmarks(BenchmarkSuite& suite);
+void RunEcsBenchmarks(BenchmarkSuite& suite);
+void RunCollisionBenchmarks(BenchmarkSuite& suite);
@@ -0,0 +1,103 @@
+#include "Benchmark.h"
+
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <algorithm>
+
+BenchmarkSuite::BenchmarkSuite(std::string filter) : filter(std::move(filter)) {
+}
+
+void BenchmarkSuite::Run(const std::string& group, const std::string& name, size_t items, const std::function<void()>& body, const std::function<void()>& reset) {
+	const std::string fullName = group + "/" + name;
+	if (!filter.empty() && fullName.find(filter) == std::string::npos) {
+		return;
+	}
+
+	if (reset) {
+		reset();
+	}
+	body();	// warm up caches and allocators
+
+	std::vector<double> samples;
+	double totalMs = 0.0;
+	while (static_cast<int>(samples.size()) < BENCHMARK_MIN_SAMPLES || totalMs < BENCHMARK_MIN_DURATION_MS) {
+		if (reset) {
+			reset();
+		}
+		const auto start = std::chrono::steady_clock::now();
+		body();
+		const auto end = std::chrono::steady_clock::now();
+		const double ns = std::chrono::duration<double, std::nano>(end - start).count();
+		samples.push_back(ns);
+		totalMs += ns / 1e6;
+	}
+	std::sort(samples.begin(), samples.end());
+
+	BenchmarkResult result;
+	result.group		= group;
+	result.name			= name;
+	result.items		= items;
+	result.samples		= static_cast<int>(samples.size());
+	result.medianNs		= samples[samples.size() / 2];
+	result.minNs		= samples.front();
+	result.nsPerItem	= result.medianNs / std::max<size_t>(items, 1);
+	results.push_back(result);
+
+	std::cout << std::left << std::setw(48) << fullName
+		<< std::right << std::setw(10) << items << " items"
+		<< std::setw(14) << std::fixed << std::setprecision(3) << result.medianNs / 1e6 << " ms"
+		<< std::setw(12) << std::setprecision(2) << result.nsPerItem << " ns/item"
+		<< std::setw(8) << result.samples << " samples" << std::endl;
+}
+
+bool BenchmarkSuite::WriteJson(const std::string& filepath) const {
+	std::ofstream file(filepath, std::ios::trunc);
+	if (!file) {
+		return false;
+	}
+	file << "{\n  \"benchmarks\": [\n";
+	for (size_t i = 0; i < results.size(); i++) {
+		const BenchmarkResult& result = results[i];
+		file << "    { \"group\": \"" << result.group << "\", \"name\": \"" << result.name << "\""
+			<< ", \"items\": " << result.items
+			<< ", \"samples\": " << result.samples
+			<< std::fixed << std::setprecision(1)
+			<< ", \"median_ns\": " << result.medianNs
+			<< ", \"min_ns\": " << result.minNs
+			<< std::setprecision(3)
+			<< ", \"ns_per_item\": " << result.nsPerItem << " }"
+			<< (i + 1 < results.size() ? ",\n" : "\n");
+	}
+	file << "  ]\n}\n";
+	return static_cast<bool>(file);
+}
+
+// VagahoBenchmarks [--filter <substring>] [--json <output file>]
+int main(int argc, char* argv[]) {
+	std::string filter;
+	std::string jsonPath;
+	for (int i = 1; i + 1 < argc; i += 2) {
+		const std::string option = argv[i];
+		if (option == "--filter") {
+			filter = argv[i + 1];
+		}
+		else if (option == "--json") {
+			jsonPath = argv[i + 1];
+		}
+	}
+
+	BenchmarkSuite suite(filter);
+	RunMapParserBenchmarks(suite);
+	RunLoggerBenchmarks(suite);
+	RunEventBenchmarks(suite);
+	RunProfilerBenchmarks(suite);
+	RunEcsBenchmarks(suite);
+	RunCollisionBenchmarks(suite);
+
+	if (!jsonPath.empty() && !suite.WriteJson(jsonPath)) {
+		std::cerr << "Can't write " << jsonPath << std::endl;
+		return EXIT_FAILURE;
+	}
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,64 @@
+#include "Benchmark.h"
+
+#include "../src/ECS/ECS.h"
+#include "../src/EventManager/EventManager.h"
+#include "../src/Components/TransformComponent.h"
+#include "../src/Components/BoxColliderComponent.h"
+#include "../src/Systems/CollisionSystem.h"
+
+#include <cmath>
+#include <memory>
+#include <random>
+
+namespace {
+
+	// CollisionSystem tests every pair: 10k entities already take seconds per frame
+	const size_t COLLIDER_COUNTS[] = { 1000, 2000, 5000 };
+	const int COLLIDER_SIZE = 32;
+
+	struct Density {
+		const char* label;
+		double coverage;			// sum of the box areas over the world area
+	};
+
+	const Density DENSITIES[] = {
+		{ "sparse", 0.01 },
+		{ "medium", 0.1 },
+		{ "dense", 0.5 },
+	};
+}
+
+void RunCollisionBenchmarks(BenchmarkSuite& suite) {
+	Logger::SetConsoleOutput(false);
+
+	for (const size_t count : COLLIDER_COUNTS) {
+		for (const Density& density : DENSITIES) {
+			ECSManager ecsManager;
+			ecsManager.AddSystem<CollisionSystem>();
+			std::unique_ptr<EventManager> eventManager = std::make_unique<EventManager>();
+
+			// Square world sized for the coverage, boxes spread uniformly
+			const double worldSize = std::sqrt(count * COLLIDER_SIZE * COLLIDER_SIZE / density.coverage);
+			std::mt19937 random(1234);
+			std::uniform_real_distribution<float> positions(0.0f, static_cast<float>(worldSize));
+			for (size_t i = 0; i < count; i++) {
+				Entity entity = ecsManager.CreateEntity();
+				entity.AddComponent<TransformComponent>(glm::vec2(positions(random), positions(random)));
+				entity.AddComponent<BoxColliderComponent>(COLLIDER_SIZE, COLLIDER_SIZE);
+			}
+			ecsManager.Update();
+
+			// Items are pair tests, the collisions found are queued as events and dropped between samples
+			CollisionSystem& collisionSystem = ecsManager.GetSystem<CollisionSystem>();
+			const size_t pairCount = count * (count - 1) / 2;
+			suite.Run("collision", std::string("update_") + density.label + "/" + SizeLabel(count), pairCount, [&]() {
+				collisionSystem.Update(eventManager);
+			}, [&]() {
+				eventManager->DispatchQueuedEvents();
+			});
+		}
+	}
+
+	Logger::Flush();
+	Logger::SetConsoleOutput(true);
+}
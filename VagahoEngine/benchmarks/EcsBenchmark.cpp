@@ -0,0 +1,136 @@
+#include "Benchmark.h"
+
+#include "../src/ECS/ECS.h"
+#include "../src/Components/TransformComponent.h"
+#include "../src/Components/RigidbodyComponent.h"
+#include "../src/Systems/MovementSystem.h"
+
+#include <memory>
+#include <random>
+#include <algorithm>
+
+namespace {
+
+	const size_t ENTITY_COUNTS[] = { 1000, 10000, 100000, 1000000 };
+	// System::RemoveEntityFromSystem scans the system's entity list, so a mass destroy is
+	// destroyed * alive: 1M entities would take minutes per sample
+	const size_t MASS_DESTROY_MAX_ENTITIES = 100000;
+	// Every DESTROY_STRIDE-th entity is destroyed by the mass destroy case
+	const size_t DESTROY_STRIDE = 10;
+
+	struct World {
+		std::unique_ptr<ECSManager> ecsManager;
+		std::vector<Entity> entities;
+	};
+
+	// count moving entities, registered with a MovementSystem
+	void PopulateWorld(World& world, size_t count) {
+		world.ecsManager = std::make_unique<ECSManager>();
+		world.ecsManager->AddSystem<MovementSystem>();
+		world.entities = world.ecsManager->CreateEntities(count);
+
+		std::mt19937 random(1234);
+		std::uniform_real_distribution<float> positions(0.0f, 4096.0f);
+		std::uniform_real_distribution<float> velocities(-50.0f, 50.0f);
+		std::vector<TransformComponent> transforms;
+		std::vector<RigidbodyComponent> rigidbodies;
+		transforms.reserve(count);
+		rigidbodies.reserve(count);
+		for (size_t i = 0; i < count; i++) {
+			transforms.emplace_back(glm::vec2(positions(random), positions(random)));
+			rigidbodies.emplace_back(glm::vec2(velocities(random), velocities(random)));
+		}
+		world.ecsManager->AddComponents(world.entities.data(), transforms.data(), count);
+		world.ecsManager->AddComponents(world.entities.data(), rigidbodies.data(), count);
+		world.ecsManager->Update();
+	}
+
+	std::string CaseName(const char* name, size_t count) {
+		return std::string(name) + "/" + SizeLabel(count);
+	}
+}
+
+void RunEcsBenchmarks(BenchmarkSuite& suite) {
+	// Every world logs from its constructor and destructor
+	Logger::SetConsoleOutput(false);
+
+	for (const size_t count : ENTITY_COUNTS) {
+		World world;
+
+		// Items are entities, each with two components; registering with the systems is left to Update
+		suite.Run("ecs", CaseName("create_add_component", count), count, [&]() {
+			for (size_t i = 0; i < count; i++) {
+				Entity entity = world.ecsManager->CreateEntity();
+				entity.AddComponent<TransformComponent>(glm::vec2(static_cast<float>(i), 0.0f));
+				entity.AddComponent<RigidbodyComponent>(glm::vec2(1.0f, 0.0f));
+			}
+		}, [&]() {
+			world.ecsManager = std::make_unique<ECSManager>();
+			world.ecsManager->AddSystem<MovementSystem>();
+		});
+
+		// Same work through the batch functions
+		std::vector<TransformComponent> transforms(count);
+		std::vector<RigidbodyComponent> rigidbodies(count, RigidbodyComponent(glm::vec2(1.0f, 0.0f)));
+		suite.Run("ecs", CaseName("create_add_component_batch", count), count, [&]() {
+			world.entities = world.ecsManager->CreateEntities(count);
+			world.ecsManager->AddComponents(world.entities.data(), transforms.data(), count);
+			world.ecsManager->AddComponents(world.entities.data(), rigidbodies.data(), count);
+		}, [&]() {
+			world.ecsManager = std::make_unique<ECSManager>();
+			world.ecsManager->AddSystem<MovementSystem>();
+		});
+
+		// The created entities joining the MovementSystem
+		suite.Run("ecs", CaseName("update_add_to_systems", count), count, [&]() {
+			world.ecsManager->Update();
+		}, [&]() {
+			world.ecsManager = std::make_unique<ECSManager>();
+			world.ecsManager->AddSystem<MovementSystem>();
+			world.entities = world.ecsManager->CreateEntities(count);
+			world.ecsManager->AddComponents(world.entities.data(), transforms.data(), count);
+			world.ecsManager->AddComponents(world.entities.data(), rigidbodies.data(), count);
+		});
+
+		PopulateWorld(world, count);
+
+		suite.Run("ecs", CaseName("get_component_linear", count), count, [&]() {
+			float sum = 0.0f;
+			for (const Entity& entity : world.entities) {
+				sum += entity.GetComponent<TransformComponent>().position.x;
+			}
+			DoNotOptimize(sum);
+		});
+
+		// Same entities in a shuffled order, every access is a cache miss once the pool outgrows the cache
+		std::vector<Entity> shuffled = world.entities;
+		std::shuffle(shuffled.begin(), shuffled.end(), std::mt19937(4321));
+		suite.Run("ecs", CaseName("get_component_random", count), count, [&]() {
+			float sum = 0.0f;
+			for (const Entity& entity : shuffled) {
+				sum += entity.GetComponent<TransformComponent>().position.x;
+			}
+			DoNotOptimize(sum);
+		});
+
+		MovementSystem& movementSystem = world.ecsManager->GetSystem<MovementSystem>();
+		suite.Run("ecs", CaseName("system_iteration", count), count, [&]() {
+			movementSystem.Update(1.0 / 60.0);
+		});
+
+		// Items are destroyed entities, removed from the systems and their ids freed in one Update
+		if (count <= MASS_DESTROY_MAX_ENTITIES) {
+			suite.Run("ecs", CaseName("update_mass_destroy", count), count / DESTROY_STRIDE, [&]() {
+				for (size_t i = 0; i < count; i += DESTROY_STRIDE) {
+					world.entities[i].Destroy();
+				}
+				world.ecsManager->Update();
+			}, [&]() {
+				PopulateWorld(world, count);
+			});
+		}
+	}
+
+	Logger::Flush();
+	Logger::SetConsoleOutput(true);
+}
@@ -0,0 +1,191 @@
+#include "Benchmark.h"
+
+#include "../src/EventManager/EventManager.h"
+
+#include <map>
+#include <typeindex>
+#include <memory>
+#include <list>
+#include <functional>
+#include <thread>
+
+namespace {
+
+	// The event manager the engine used before dense event ids: a std::map keyed by type_index,
+	// a std::list of heap allocated listeners and a virtual call per listener
+	class LegacyEventListenerBase {
+	public:
+		virtual ~LegacyEventListenerBase() = default;
+		virtual void NotifyListener(Event& event) = 0;
+	};
+
+	template <typename TOwner, typename TEvent>
+	class LegacyEventListener : public LegacyEventListenerBase {
+	private:
+		typedef void (TOwner::* EventHandlerFunction)(TEvent&);
+		TOwner* ownerPtr;
+		EventHandlerFunction handlerFunc;
+
+	public:
+		LegacyEventListener(TOwner* ownerPtr, EventHandlerFunction handlerFunc) : ownerPtr(ownerPtr), handlerFunc(handlerFunc) {}
+
+		void NotifyListener(Event& event) override {
+			std::invoke(handlerFunc, ownerPtr, static_cast<TEvent&>(event));
+		}
+	};
+
+	class LegacyEventManager {
+	private:
+		std::map<std::type_index, std::unique_ptr<std::list<std::unique_ptr<LegacyEventListenerBase>>>> listeners;
+
+	public:
+		template <typename TEvent, typename TOwner>
+		void Subscribe(TOwner* ownerPtr, void (TOwner::* handlerFunc)(TEvent&)) {
+			if (!listeners[typeid(TEvent)].get()) {
+				listeners[typeid(TEvent)] = std::make_unique<std::list<std::unique_ptr<LegacyEventListenerBase>>>();
+			}
+			listeners[typeid(TEvent)]->push_back(std::make_unique<LegacyEventListener<TOwner, TEvent>>(ownerPtr, handlerFunc));
+		}
+
+		template <typename TEvent, typename ...TArgs>
+		void BroadcastEvent(TArgs && ...args) {
+			auto currentListeners = listeners[typeid(TEvent)].get();
+			if (currentListeners) {
+				for (auto it = currentListeners->begin(); it != currentListeners->end(); it++) {
+					TEvent event(std::forward<TArgs>(args)...);
+					(*it)->NotifyListener(event);
+				}
+			}
+		}
+	};
+
+	class DamageEvent : public Event {
+	public:
+		int amount;
+		DamageEvent(int amount) : amount(amount) {}
+	};
+
+	// A few unrelated event types, so the legacy map isn't a single node
+	class EventA : public Event {};
+	class EventB : public Event {};
+	class EventC : public Event {};
+
+	class DamageListener {
+	public:
+		int64_t total = 0;
+		void OnDamage(DamageEvent& event) { total += event.amount; }
+		void OnA(EventA&) {}
+		void OnB(EventB&) {}
+		void OnC(EventC&) {}
+	};
+
+	const size_t BROADCASTS_PER_SAMPLE = 100000;
+	const int LISTENER_COUNT = 4;
+	const int PUBLISHER_THREADS = 4;
+	// One listener per entity, for the scaling cases
+	const size_t ENTITY_LISTENER_COUNTS[] = { 1000, 10000, 100000, 1000000 };
+	const size_t DELIVERIES_PER_SAMPLE = 1000000;
+}
+
+void RunEventBenchmarks(BenchmarkSuite& suite) {
+	std::vector<DamageListener> owners(LISTENER_COUNT);
+
+	// Keeps the EventManager constructor message out of the results
+	Logger::SetConsoleOutput(false);
+	LegacyEventManager legacyManager;
+	EventManager eventManager;
+	Logger::Flush();
+	Logger::SetConsoleOutput(true);
+
+	std::vector<EventConnection> connections;
+	for (auto& owner : owners) {
+		legacyManager.Subscribe(&owner, &DamageListener::OnDamage);
+		legacyManager.Subscribe(&owner, &DamageListener::OnA);
+		legacyManager.Subscribe(&owner, &DamageListener::OnB);
+		legacyManager.Subscribe(&owner, &DamageListener::OnC);
+		connections.push_back(eventManager.Subscribe<&DamageListener::OnDamage>(&owner));
+		connections.push_back(eventManager.Subscribe<&DamageListener::OnA>(&owner));
+		connections.push_back(eventManager.Subscribe<&DamageListener::OnB>(&owner));
+		connections.push_back(eventManager.Subscribe<&DamageListener::OnC>(&owner));
+	}
+
+	// Items are broadcasts, each one reaching LISTENER_COUNT listeners
+	suite.Run("events", "legacy_broadcast", BROADCASTS_PER_SAMPLE, [&]() {
+		for (size_t i = 0; i < BROADCASTS_PER_SAMPLE; i++) {
+			legacyManager.BroadcastEvent<DamageEvent>(static_cast<int>(i));
+		}
+		DoNotOptimize(owners[0].total);
+	});
+
+	suite.Run("events", "indexed_broadcast", BROADCASTS_PER_SAMPLE, [&]() {
+		for (size_t i = 0; i < BROADCASTS_PER_SAMPLE; i++) {
+			eventManager.BroadcastEvent<DamageEvent>(static_cast<int>(i));
+		}
+		DoNotOptimize(owners[0].total);
+	});
+
+	// Queued during the sample and delivered in one pass at the end, the queue keeps its capacity between samples
+	suite.Run("events", "queued_dispatch", BROADCASTS_PER_SAMPLE, [&]() {
+		for (size_t i = 0; i < BROADCASTS_PER_SAMPLE; i++) {
+			eventManager.QueueEvent<DamageEvent>(static_cast<int>(i));
+		}
+		eventManager.DispatchQueuedEvents();
+		DoNotOptimize(owners[0].total);
+	});
+
+	// Workers publish into their own buffers, merged, sorted by key and delivered at the sync point
+	// Thread start-up is part of the sample
+	suite.Run("events", "publish_" + std::to_string(PUBLISHER_THREADS) + "_threads", BROADCASTS_PER_SAMPLE, [&]() {
+		std::vector<std::thread> publishers;
+		for (int t = 0; t < PUBLISHER_THREADS; t++) {
+			publishers.emplace_back([&, t]() {
+				for (size_t i = t; i < BROADCASTS_PER_SAMPLE; i += PUBLISHER_THREADS) {
+					eventManager.PublishEvent<DamageEvent>(i, static_cast<int>(i));
+				}
+			});
+		}
+		for (auto& publisher : publishers) {
+			publisher.join();
+		}
+		eventManager.DispatchQueuedEvents();
+		DoNotOptimize(owners[0].total);
+	});
+
+	// No listener at all: the legacy manager still does a map lookup (and inserts on the first miss)
+	class UnheardEvent : public Event {};
+	suite.Run("events", "legacy_no_listener", BROADCASTS_PER_SAMPLE, [&]() {
+		for (size_t i = 0; i < BROADCASTS_PER_SAMPLE; i++) {
+			legacyManager.BroadcastEvent<UnheardEvent>();
+		}
+	});
+
+	suite.Run("events", "indexed_no_listener", BROADCASTS_PER_SAMPLE, [&]() {
+		for (size_t i = 0; i < BROADCASTS_PER_SAMPLE; i++) {
+			eventManager.BroadcastEvent<UnheardEvent>();
+		}
+	});
+
+	// Every entity listening to the same event, items are deliveries
+	Logger::SetConsoleOutput(false);
+	for (const size_t listenerCount : ENTITY_LISTENER_COUNTS) {
+		std::vector<DamageListener> entityOwners(listenerCount);
+		// Declared before the manager so they outlive it: a connection of a destroyed manager doesn't search its list
+		std::vector<EventConnection> entityConnections;
+		EventManager entityEventManager;
+
+		entityConnections.reserve(listenerCount);
+		for (auto& owner : entityOwners) {
+			entityConnections.push_back(entityEventManager.Subscribe<&DamageListener::OnDamage>(&owner));
+		}
+
+		const size_t broadcastCount = DELIVERIES_PER_SAMPLE / listenerCount;
+		suite.Run("events", "broadcast_listeners/" + SizeLabel(listenerCount), broadcastCount * listenerCount, [&]() {
+			for (size_t i = 0; i < broadcastCount; i++) {
+				entityEventManager.BroadcastEvent<DamageEvent>(static_cast<int>(i));
+			}
+			DoNotOptimize(entityOwners.back().total);
+		});
+	}
+	Logger::Flush();
+	Logger::SetConsoleOutput(true);
+}
@@ -0,0 +1,135 @@
+#include "Benchmark.h"
+
+#include "../src/Logger/Logger.h"
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <ctime>
+#include <filesystem>
+#include <thread>
+
+namespace {
+
+	// The synchronous logger the engine used before the ring buffer: path parsing, local time and
+	// string concatenation on the calling thread, then a flushing console write per call
+	void LegacyLog(const std::string& message, const char* file, int line) {
+		std::string filename = std::filesystem::path(file).filename().string();
+		std::string line_str = std::to_string(line);
+
+		auto now = std::chrono::system_clock::now();
+		std::time_t now_time = std::chrono::system_clock::to_time_t(now);
+		std::tm local_time;
+		localtime_r(&now_time, &local_time);
+		std::ostringstream oss;
+		oss << std::put_time(&local_time, "%Y-%m-%d %H:%M:%S");
+
+		LogEntry logEntry;
+		logEntry.type = INFO;
+		logEntry.message = "[INFO   ][" + oss.str() + "]:" + "\033[90m" +
+							"[File: " + filename + ", Line: " + line_str + "]: "
+							+ "\033[92m" + message;
+
+		std::cout << "\033[92m" << logEntry.message << "\033[0m" << std::endl;
+	}
+
+	// Fits in the ring buffer, so every call of a sample takes the push path and none is dropped
+	const size_t CALLS_PER_SAMPLE = 4096;
+	const int PRODUCER_THREADS = 4;
+}
+
+void RunLoggerBenchmarks(BenchmarkSuite& suite) {
+	const std::string message = "Entity created with id = 12345";
+
+	// Console output goes to /dev/null for both loggers, so the numbers don't depend on the terminal
+	std::ofstream devNull("/dev/null");
+	suite.Run("logger", "legacy_sync", CALLS_PER_SAMPLE, [&]() {
+		std::streambuf* consoleBuffer = std::cout.rdbuf(devNull.rdbuf());
+		for (size_t i = 0; i < CALLS_PER_SAMPLE; i++) {
+			LegacyLog(message, __FILE__, __LINE__);
+		}
+		std::cout.rdbuf(consoleBuffer);
+	});
+
+	Logger::SetConsoleOutput(false);
+	suite.Run("logger", "ring_single_thread", CALLS_PER_SAMPLE, [&]() {
+		for (size_t i = 0; i < CALLS_PER_SAMPLE; i++) {
+			LOG_INFO(message);
+		}
+	}, []() {
+		Logger::Flush();
+	});
+
+	// Arguments are encoded on the calling thread and only formatted by the writer
+	suite.Run("logger", "ring_format_args", CALLS_PER_SAMPLE, [&]() {
+		for (size_t i = 0; i < CALLS_PER_SAMPLE; i++) {
+			LOG_INFO("Entity created with id = {} at ({}, {})", i, 12.5, -3.0);
+		}
+	}, []() {
+		Logger::Flush();
+	});
+
+	// A category filtered out at runtime costs one relaxed load, the arguments aren't touched
+	Logger::SetCategoryLevel(LogCategory::ECS, WARNING);
+	suite.Run("logger", "filtered_category", CALLS_PER_SAMPLE, [&]() {
+		for (size_t i = 0; i < CALLS_PER_SAMPLE; i++) {
+			LOG_AT(INFO, ECS, "Entity created with id = {}", i);
+		}
+	});
+	Logger::SetCategoryLevel(LogCategory::ECS, INFO);
+
+	// Below VAGAHO_MIN_LOG_LEVEL (VERBOSE in release builds) nothing is left of the call
+	suite.Run("logger", "compiled_out_level", CALLS_PER_SAMPLE, [&]() {
+		for (size_t i = 0; i < CALLS_PER_SAMPLE; i++) {
+			LOG_AT(VERBOSE, ECS, "Entity created with id = {}", i);
+		}
+	});
+
+	// Thread start-up is part of the sample, it adds a few ns per call on top of the contention
+	suite.Run("logger", "ring_" + std::to_string(PRODUCER_THREADS) + "_threads", CALLS_PER_SAMPLE, [&]() {
+		std::vector<std::thread> producers;
+		for (int t = 0; t < PRODUCER_THREADS; t++) {
+			producers.emplace_back([&]() {
+				for (size_t i = 0; i < CALLS_PER_SAMPLE / PRODUCER_THREADS; i++) {
+					LOG_INFO(message);
+				}
+			});
+		}
+		for (auto& producer : producers) {
+			producer.join();
+		}
+	}, []() {
+		Logger::Flush();
+	});
+
+	// Writer side: push a sample, then wait for the writer to drain it. The text path formats every
+	// record into the console batch and the history, the binary path only appends its encoded arguments
+	suite.Run("logger", "drain_text", CALLS_PER_SAMPLE, [&]() {
+		for (size_t i = 0; i < CALLS_PER_SAMPLE; i++) {
+			LOG_INFO("Entity created with id = {} at ({}, {})", i, 12.5, -3.0);
+		}
+		Logger::Flush();
+	});
+
+	const std::string binaryLogPath = (std::filesystem::temp_directory_path() / "vagaho_benchmark.vlog").string();
+	if (Logger::EnableBinaryOutput(binaryLogPath)) {
+		Logger::SetTextOutputLevel(ERROR);
+		suite.Run("logger", "drain_binary", CALLS_PER_SAMPLE, [&]() {
+			for (size_t i = 0; i < CALLS_PER_SAMPLE; i++) {
+				LOG_INFO("Entity created with id = {} at ({}, {})", i, 12.5, -3.0);
+			}
+			Logger::Flush();
+		});
+		Logger::SetTextOutputLevel(VERBOSE);
+		Logger::DisableBinaryOutput();
+		std::filesystem::remove(binaryLogPath);
+	}
+
+	Logger::Flush();
+	Logger::SetConsoleOutput(true);
+
+	if (Logger::GetDroppedCount() != 0) {
+		std::cerr << "logger: " << Logger::GetDroppedCount() << " records dropped during the benchmark" << std::endl;
+	}
+}
@@ -0,0 +1,101 @@
+#include "Benchmark.h"
+
+#include "../src/MapLoader/MapLoader.h"
+
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <random>
+
+namespace {
+
+	// The text map loader the game used before MapLoader: getline + istringstream per row into nested vectors,
+	// flattened afterwards for the tilemap
+	std::vector<int> LegacyReadMapFile(const std::string& filepath) {
+		std::vector<std::vector<int>> mapData;
+		std::ifstream mapFile(filepath);
+		std::string line;
+
+		while (std::getline(mapFile, line)) {
+			std::vector<int> row;
+			std::istringstream iss(line);
+			int tileId;
+			while (iss >> tileId) {
+				row.push_back(tileId);
+				if (iss.peek() == ',')
+					iss.ignore();
+			}
+			mapData.push_back(row);
+		}
+		mapFile.close();
+
+		std::vector<int> tiles;
+		for (const auto& row : mapData) {
+			tiles.insert(tiles.end(), row.begin(), row.end());
+		}
+		return tiles;
+	}
+
+	std::string GenerateCsv(int columns, int rows) {
+		std::mt19937 random(1234);
+		std::uniform_int_distribution<int> tileIds(0, 29);
+		std::string text;
+		for (int y = 0; y < rows; y++) {
+			for (int x = 0; x < columns; x++) {
+				text += std::to_string(tileIds(random));
+				text += (x + 1 < columns) ? "," : "\n";
+			}
+		}
+		return text;
+	}
+
+	struct MapSize {
+		const char* label;
+		int columns;
+		int rows;
+	};
+}
+
+void RunMapParserBenchmarks(BenchmarkSuite& suite) {
+	const MapSize sizes[] = {
+		{ "1k", 32, 32 },
+		{ "100k", 316, 316 },
+		{ "1M", 1000, 1000 }
+	};
+	const std::filesystem::path directory = std::filesystem::temp_directory_path();
+
+	for (const MapSize& size : sizes) {
+		const size_t tileCount = static_cast<size_t>(size.columns) * size.rows;
+		const std::string csv = GenerateCsv(size.columns, size.rows);
+		const std::string csvPath = (directory / ("vagaho_bench_" + std::string(size.label) + ".map")).string();
+		const std::string binaryPath = (directory / ("vagaho_bench_" + std::string(size.label) + ".vmap")).string();
+		std::ofstream(csvPath, std::ios::binary | std::ios::trunc) << csv;
+
+		MapData mapData;
+		MapLoader::ParseCsv(csv.data(), csv.data() + csv.size(), mapData);
+		MapLoader::SaveBinary(binaryPath, mapData);
+
+		suite.Run("map", std::string("istringstream_file/") + size.label, tileCount, [&]() {
+			std::vector<int> tiles = LegacyReadMapFile(csvPath);
+			DoNotOptimize(tiles);
+		});
+		suite.Run("map", std::string("csv_file/") + size.label, tileCount, [&]() {
+			MapData loaded;
+			MapLoader::LoadCsv(csvPath, loaded);
+			DoNotOptimize(loaded);
+		});
+		suite.Run("map", std::string("csv_parse/") + size.label, tileCount, [&]() {
+			MapData parsed;
+			MapLoader::ParseCsv(csv.data(), csv.data() + csv.size(), parsed);
+			DoNotOptimize(parsed);
+		});
+		suite.Run("map", std::string("binary_file/") + size.label, tileCount, [&]() {
+			MapData loaded;
+			MapLoader::LoadBinary(binaryPath, loaded);
+			DoNotOptimize(loaded);
+		});
+
+		std::filesystem::remove(csvPath);
+		std::filesystem::remove(binaryPath);
+	}
+}
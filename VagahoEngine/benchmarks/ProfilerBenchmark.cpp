@@ -0,0 +1,31 @@
+#include "Benchmark.h"
+
+#include "../src/Profiler/Profiler.h"
+
+namespace {
+
+	// Fits in a thread's buffer, every scope of a sample is recorded
+	const size_t SCOPES_PER_SAMPLE = 4096;
+}
+
+void RunProfilerBenchmarks(BenchmarkSuite& suite) {
+	// Items are scopes: two clock reads and a sample written to the thread's buffer
+	suite.Run("profiler", "scope", SCOPES_PER_SAMPLE, [&]() {
+		for (size_t i = 0; i < SCOPES_PER_SAMPLE; i++) {
+			PROFILE_SCOPE("Benchmark");
+		}
+	}, []() {
+		Profiler::BeginFrame();
+		Profiler::EndFrame();
+	});
+
+	// Draining a full frame of samples and updating the scope stats
+	suite.Run("profiler", "end_frame", SCOPES_PER_SAMPLE, [&]() {
+		Profiler::EndFrame();
+	}, []() {
+		Profiler::BeginFrame();
+		for (size_t i = 0; i < SCOPES_PER_SAMPLE; i++) {
+			PROFILE_SCOPE("Benchmark");
+		}
+	});
+}
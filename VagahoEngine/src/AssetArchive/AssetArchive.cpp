@@ -0,0 +1,101 @@
+#include "AssetArchive.h"
+
+#include "../Logger/Logger.h"
+#include "../MapLoader/MapLoader.h"
+
+#include <cstring>
+#include <algorithm>
+
+namespace {
+
+	// The rows a texture or map entry describes must fit in its blob, surfaces and maps read them in place
+	bool bHasValidDimensions(const ArchiveEntry& entry) {
+		const uint64_t rowsBytes = static_cast<uint64_t>(entry.pitch) * entry.height;
+		switch (entry.type) {
+		case ArchiveEntryType::Texture:
+			// ARGB8888 pixels
+			return entry.pitch >= static_cast<uint64_t>(entry.width) * sizeof(uint32_t) && rowsBytes <= entry.size;
+		case ArchiveEntryType::Map:
+			// int32 tile ids after the BinaryMapHeader
+			return entry.pitch >= static_cast<uint64_t>(entry.width) * sizeof(int32_t) &&
+				entry.size >= sizeof(BinaryMapHeader) && rowsBytes <= entry.size - sizeof(BinaryMapHeader);
+		default:
+			return true;
+		}
+	}
+}
+
+bool AssetArchive::Open(const std::string& filepath) {
+	Close();
+
+	if (!file.Open(filepath)) {
+		return false;
+	}
+
+	const uint8_t* data = file.GetData();
+	const size_t size = file.GetSize();
+	const ArchiveHeader* fileHeader = reinterpret_cast<const ArchiveHeader*>(data);
+
+	if (size < sizeof(ArchiveHeader) ||
+		std::memcmp(fileHeader->magic, ARCHIVE_MAGIC, sizeof(ARCHIVE_MAGIC)) != 0 ||
+		fileHeader->version != ARCHIVE_VERSION) {
+		LOG_AT(ERROR, Assets, "'{}' is not a version {} asset archive", filepath, ARCHIVE_VERSION);
+		file.Close();
+		return false;
+	}
+
+	const uint64_t tocEnd = sizeof(ArchiveHeader) + static_cast<uint64_t>(fileHeader->entryCount) * sizeof(ArchiveEntry);
+	if (tocEnd > size) {
+		LOG_AT(ERROR, Assets, "Asset archive '{}' is truncated", filepath);
+		file.Close();
+		return false;
+	}
+
+	// Validate every blob once here, so lookups never have to check bounds again
+	const ArchiveEntry* fileEntries = reinterpret_cast<const ArchiveEntry*>(data + sizeof(ArchiveHeader));
+	for (uint32_t i = 0; i < fileHeader->entryCount; i++) {
+		const ArchiveEntry& entry = fileEntries[i];
+		if (entry.offset < tocEnd || entry.offset > size || entry.size > size - entry.offset ||
+			entry.path[ARCHIVE_MAX_PATH_LENGTH - 1] != '\0' || !bHasValidDimensions(entry)) {
+			LOG_AT(ERROR, Assets, "Asset archive '{}' has a corrupt entry at index {}", filepath, i);
+			file.Close();
+			return false;
+		}
+	}
+
+	header = fileHeader;
+	entries = fileEntries;
+	LOG_AT(INFO, Assets, "Mounted asset archive '{}' with {} entries", filepath, header->entryCount);
+	return true;
+}
+
+void AssetArchive::Close() {
+	file.Close();
+	header = nullptr;
+	entries = nullptr;
+}
+
+const ArchiveEntry* AssetArchive::FindEntry(const std::string& path) const {
+	if (!header) {
+		return nullptr;
+	}
+
+	const ArchiveEntry* begin = entries;
+	const ArchiveEntry* end = entries + header->entryCount;
+	const ArchiveEntry* found = std::lower_bound(begin, end, path, [](const ArchiveEntry& entry, const std::string& key) {
+		return std::strcmp(entry.path, key.c_str()) < 0;
+	});
+
+	if (found != end && path == found->path) {
+		return found;
+	}
+	return nullptr;
+}
+
+const uint8_t* AssetArchive::GetEntryData(const ArchiveEntry& entry) const {
+	return file.GetData() + entry.offset;
+}
+
+uint32_t AssetArchive::GetEntryCount() const {
+	return header ? header->entryCount : 0;
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+#include "../Utils/MappedFile.h"
+
+////////////////////////////////////////////////////////////////////////////////
+/// ASSET ARCHIVE (.vpak)
+////////////////////////////////////////////////////////////////////////////////
+/// One file holding every asset of the game, built offline by the packer
+/// (VagahoEngine --pack <assets dir> <archive>).
+///
+/// Layout (little-endian):
+///   ArchiveHeader
+///   ArchiveEntry[entryCount]  - table of contents, sorted by path for binary search
+///   entry data                - each blob starts on an ARCHIVE_DATA_ALIGNMENT boundary
+///
+/// Textures are stored decoded as ARGB8888 rows, so a surface can point straight
+/// at the mapped bytes. Maps are stored as .vmap binary maps (see MapLoader).
+////////////////////////////////////////////////////////////////////////////////
+
+const char		ARCHIVE_MAGIC[4]			= { 'V', 'P', 'A', 'K' };
+const uint32_t	ARCHIVE_VERSION				= 2;
+const uint32_t	ARCHIVE_DATA_ALIGNMENT		= 16;
+const size_t	ARCHIVE_MAX_PATH_LENGTH		= 96;
+
+enum class ArchiveEntryType : uint32_t {
+	Raw		= 0,	// bytes of the original file
+	Texture	= 1,	// width * height ARGB8888 pixels, pitch bytes per row
+	Map		= 2		// BinaryMapHeader + width (columns) * height (rows) int32 tile ids
+};
+
+struct ArchiveHeader {
+	char		magic[4];
+	uint32_t	version;
+	uint32_t	entryCount;
+	uint32_t	reserved;
+};
+
+struct ArchiveEntry {
+	char				path[ARCHIVE_MAX_PATH_LENGTH];	// relative to the packed directory, '/' separated, zero padded
+	ArchiveEntryType	type;
+	uint32_t			width;
+	uint32_t			height;
+	uint32_t			pitch;
+	uint64_t			offset;							// from the start of the archive
+	uint64_t			size;
+};
+
+static_assert(sizeof(ArchiveHeader) == 16, "ArchiveHeader layout is part of the file format");
+static_assert(sizeof(ArchiveEntry) == 128, "ArchiveEntry layout is part of the file format");
+
+class AssetArchive {
+private:
+	MappedFile file;
+	const ArchiveHeader* header = nullptr;
+	const ArchiveEntry* entries = nullptr;
+
+public:
+	AssetArchive() = default;
+
+	bool Open(const std::string& filepath);
+	void Close();
+	bool bIsOpen() const { return header != nullptr; }
+
+	// Binary search in the table of contents, returns nullptr if the path is not packed
+	const ArchiveEntry* FindEntry(const std::string& path) const;
+	const uint8_t* GetEntryData(const ArchiveEntry& entry) const;
+	uint32_t GetEntryCount() const;
+};
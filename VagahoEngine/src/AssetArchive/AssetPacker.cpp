@@ -0,0 +1,178 @@
+#include "AssetPacker.h"
+#include "AssetArchive.h"
+
+#include "../Logger/Logger.h"
+#include "../MapLoader/MapLoader.h"
+
+#include <SDL2/SDL.h>
+#include <SDL_image.h>
+
+#include <vector>
+#include <fstream>
+#include <cstring>
+#include <cctype>
+#include <algorithm>
+#include <filesystem>
+
+namespace {
+
+	struct PackedAsset {
+		ArchiveEntry entry;
+		std::vector<uint8_t> data;
+	};
+
+	bool ReadFileBytes(const std::filesystem::path& filepath, std::vector<uint8_t>& bytes) {
+		std::ifstream file(filepath, std::ios::binary);
+		if (!file) {
+			return false;
+		}
+		bytes.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+		return true;
+	}
+
+	bool PackTexture(const std::filesystem::path& filepath, PackedAsset& asset) {
+		SDL_Surface* surface = IMG_Load(filepath.string().c_str());
+		if (!surface) {
+			LOG_AT(ERROR, Assets, "Packer failed to decode '{}': {}", filepath.string(), IMG_GetError());
+			return false;
+		}
+		SDL_Surface* converted = SDL_ConvertSurfaceFormat(surface, SDL_PIXELFORMAT_ARGB8888, 0);
+		SDL_FreeSurface(surface);
+		if (!converted) {
+			LOG_AT(ERROR, Assets, "Packer failed to convert '{}': {}", filepath.string(), SDL_GetError());
+			return false;
+		}
+
+		// Store tightly packed rows, SDL surfaces may pad the pitch
+		const uint32_t rowBytes = static_cast<uint32_t>(converted->w) * 4;
+		asset.entry.type	= ArchiveEntryType::Texture;
+		asset.entry.width	= static_cast<uint32_t>(converted->w);
+		asset.entry.height	= static_cast<uint32_t>(converted->h);
+		asset.entry.pitch	= rowBytes;
+		asset.data.resize(static_cast<size_t>(rowBytes) * converted->h);
+
+		SDL_LockSurface(converted);
+		for (int y = 0; y < converted->h; y++) {
+			const uint8_t* row = static_cast<const uint8_t*>(converted->pixels) + static_cast<size_t>(y) * converted->pitch;
+			std::memcpy(asset.data.data() + static_cast<size_t>(y) * rowBytes, row, rowBytes);
+		}
+		SDL_UnlockSurface(converted);
+		SDL_FreeSurface(converted);
+		return true;
+	}
+
+	bool PackMap(const std::filesystem::path& filepath, PackedAsset& asset) {
+		MapData mapData;
+		if (!MapLoader::LoadCsv(filepath.string(), mapData)) {
+			return false;
+		}
+
+		asset.entry.type	= ArchiveEntryType::Map;
+		asset.entry.width	= static_cast<uint32_t>(mapData.columns);
+		asset.entry.height	= static_cast<uint32_t>(mapData.rows);
+		asset.entry.pitch	= static_cast<uint32_t>(mapData.columns * sizeof(int32_t));
+		asset.data			= MapLoader::SerializeBinary(mapData);
+		return true;
+	}
+
+	void WritePadding(std::ofstream& output, uint64_t count) {
+		static const char zeros[ARCHIVE_DATA_ALIGNMENT] = {};
+		output.write(zeros, static_cast<std::streamsize>(count));
+	}
+}
+
+bool AssetPacker::PackDirectory(const std::string& directory, const std::string& outputPath) {
+	namespace fs = std::filesystem;
+
+	if (!fs::is_directory(directory)) {
+		LOG_AT(ERROR, Assets, "Packer: '{}' is not a directory", directory);
+		return false;
+	}
+
+	// Collect and sort first, directory iteration order is not stable between machines
+	std::vector<fs::path> files;
+	for (const auto& item : fs::recursive_directory_iterator(directory)) {
+		if (item.is_regular_file()) {
+			files.push_back(item.path());
+		}
+	}
+
+	std::vector<PackedAsset> assets;
+	assets.reserve(files.size());
+	for (const auto& filepath : files) {
+		PackedAsset asset;
+		std::memset(&asset.entry, 0, sizeof(ArchiveEntry));
+
+		const std::string relativePath = fs::relative(filepath, directory).generic_string();
+		if (relativePath.size() >= ARCHIVE_MAX_PATH_LENGTH) {
+			LOG_AT(ERROR, Assets, "Packer: path '{}' is longer than {} characters", relativePath, ARCHIVE_MAX_PATH_LENGTH - 1);
+			return false;
+		}
+		std::memcpy(asset.entry.path, relativePath.c_str(), relativePath.size());
+
+		std::string extension = filepath.extension().string();
+		std::transform(extension.begin(), extension.end(), extension.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+
+		bool bPacked;
+		if (extension == ".png" || extension == ".jpg" || extension == ".jpeg" || extension == ".bmp") {
+			bPacked = PackTexture(filepath, asset);
+		}
+		else if (extension == ".map") {
+			bPacked = PackMap(filepath, asset);
+		}
+		else {
+			asset.entry.type = ArchiveEntryType::Raw;
+			bPacked = ReadFileBytes(filepath, asset.data);
+		}
+		if (!bPacked) {
+			LOG_AT(ERROR, Assets, "Packer: failed to pack '{}'", filepath.string());
+			return false;
+		}
+		assets.push_back(std::move(asset));
+	}
+
+	std::sort(assets.begin(), assets.end(), [](const PackedAsset& a, const PackedAsset& b) {
+		return std::strcmp(a.entry.path, b.entry.path) < 0;
+	});
+
+	// Lay the blobs out after the table of contents
+	uint64_t offset = sizeof(ArchiveHeader) + assets.size() * sizeof(ArchiveEntry);
+	for (auto& asset : assets) {
+		offset = (offset + ARCHIVE_DATA_ALIGNMENT - 1) / ARCHIVE_DATA_ALIGNMENT * ARCHIVE_DATA_ALIGNMENT;
+		asset.entry.offset = offset;
+		asset.entry.size = asset.data.size();
+		offset += asset.data.size();
+	}
+
+	std::ofstream output(outputPath, std::ios::binary | std::ios::trunc);
+	if (!output) {
+		LOG_AT(ERROR, Assets, "Packer: can't open '{}' for writing", outputPath);
+		return false;
+	}
+
+	ArchiveHeader header;
+	std::memset(&header, 0, sizeof(ArchiveHeader));
+	std::memcpy(header.magic, ARCHIVE_MAGIC, sizeof(ARCHIVE_MAGIC));
+	header.version = ARCHIVE_VERSION;
+	header.entryCount = static_cast<uint32_t>(assets.size());
+	output.write(reinterpret_cast<const char*>(&header), sizeof(ArchiveHeader));
+
+	for (const auto& asset : assets) {
+		output.write(reinterpret_cast<const char*>(&asset.entry), sizeof(ArchiveEntry));
+	}
+
+	uint64_t written = sizeof(ArchiveHeader) + assets.size() * sizeof(ArchiveEntry);
+	for (const auto& asset : assets) {
+		WritePadding(output, asset.entry.offset - written);
+		output.write(reinterpret_cast<const char*>(asset.data.data()), static_cast<std::streamsize>(asset.data.size()));
+		written = asset.entry.offset + asset.entry.size;
+	}
+
+	if (!output) {
+		LOG_AT(ERROR, Assets, "Packer: failed writing '{}'", outputPath);
+		return false;
+	}
+
+	LOG_AT(INFO, Assets, "Packed {} assets from '{}' into '{}' ({} bytes)", assets.size(), directory, outputPath, written);
+	return true;
+}
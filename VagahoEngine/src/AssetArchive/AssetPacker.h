@@ -0,0 +1,16 @@
+#pragma once
+
+#include <string>
+
+////////////////////////////////////////////////////////////////////////////////
+/// ASSET PACKER
+////////////////////////////////////////////////////////////////////////////////
+/// Offline tool that turns a loose asset directory into an AssetArchive.
+/// Images are decoded to ARGB8888, .map files are converted to binary maps and
+/// everything else is copied raw. The output only depends on the input files
+/// (sorted paths, no timestamps, zero padding) so two packs of the same assets diff clean.
+////////////////////////////////////////////////////////////////////////////////
+class AssetPacker {
+public:
+	static bool PackDirectory(const std::string& directory, const std::string& outputPath);
+};
@@ -1,34 +1,387 @@
 #include "AssetManager.h"
 
 #include "../Logger/Logger.h"
+#include "../Profiler/Profiler.h"
+#include "../FileWatcher/FileWatcher.h"
 
 #include <SDL_image.h>
 
+namespace {
+
+	// Runs on the loader threads
+	SDL_Surface* DecodeImage(const std::string& filepath) {
+		PROFILE_SCOPE("DecodeImage");
+		SDL_Surface* surface = IMG_Load(filepath.c_str());
+		if (surface) {
+			// Convert to the renderer's native format here, so the upload on the main thread is a plain copy
+			SDL_Surface* converted = SDL_ConvertSurfaceFormat(surface, SDL_PIXELFORMAT_ARGB8888, 0);
+			if (converted) {
+				SDL_FreeSurface(surface);
+				surface = converted;
+			}
+		}
+		return surface;
+	}
+}
+
 AssetManager::AssetManager() {
+	loaderThreads = std::make_unique<ThreadPool>(0, "Asset loader");
 	// LOG_INFO("Asset Manager constructor called");
 }
 
 AssetManager::~AssetManager() {
+	// Join the loader threads first so nobody pushes to decodedTextures while we clean up
+	loaderThreads.reset();
+	for (auto& decodedTexture : decodedTextures) {
+		SDL_FreeSurface(decodedTexture.surface);
+		if (decodedTexture.promise) {
+			decodedTexture.promise->set_value(nullptr);
+		}
+	}
+	decodedTextures.clear();
+
 	ClearAssets();
 	// LOG_INFO("Asset Manager destructor called");
 }
 
+void AssetManager::SetRenderer(SDL_Renderer* renderer) {
+	this->renderer = renderer;
+}
+
 void AssetManager::ClearAssets() {
-	for (auto texture : textures) {
-		SDL_DestroyTexture(texture.second); // second is the value of key-value pair, the actual texture. fist is id
+	for (auto& texture : textures) {
+		// Outstanding handles keep the TextureAsset alive, make sure they don't point at a destroyed texture
+		SDL_DestroyTexture(texture.second->texture); // second is the value of key-value pair, the texture asset. fist is id
+		texture.second->texture = nullptr;
+		texture.second->sizeInBytes = 0;
 	}
 	textures.clear();
+	residentTextureBytes = 0;
 }
 
 void AssetManager::AddTexture(SDL_Renderer* renderer, const std::string& assetId, const std::string& filepath) {
-	SDL_Surface* surface = IMG_Load(filepath.c_str());
+	TextureHandle& asset = FindOrCreateAsset(assetId, filepath);
+	// Sharing policy: adding an id that is already resident reuses the texture
+	if (asset->texture) {
+		hitCount++;
+		asset->lastUsed = ++useCounter;
+		return;
+	}
+	missCount++;
+
+	SDL_Surface* surface = LoadSurface(filepath);
+	if (!surface) {
+		LOG_AT(ERROR, Assets, "Failed to load texture '{}' from {}: {}", assetId, filepath, SDL_GetError());
+		return;
+	}
 	SDL_Texture* texture = SDL_CreateTextureFromSurface(renderer, surface);
 	SDL_FreeSurface(surface);
 	// Add the texture to the map
-	textures.emplace(assetId, texture);
-	// LOG_INFO("Texture added. Texture Id: " + assetId);
+	SetResidentTexture(*asset, texture);
+	EnforceTextureBudget();
+	// LOG_AT(VERBOSE, Assets, "Texture added. Texture Id: {}", assetId);
 }
 
 SDL_Texture* AssetManager::GetTexture(const std::string& assetId) {
-	return textures[assetId];
+	auto it = textures.find(assetId);
+	if (it == textures.end()) {
+		return nullptr;
+	}
+
+	// Not a hit, it runs for every draw. Hits are counted where textures are requested
+	TextureAsset& asset = *it->second;
+	if (asset.texture) {
+		asset.lastUsed = ++useCounter;
+		return asset.texture;
+	}
+
+	// Only what the budget evicted comes back, a texture that failed to load isn't retried every draw
+	if (!asset.bIsEvicted || !renderer) {
+		return nullptr;
+	}
+
+	// Evicted earlier, bring it back synchronously
+	missCount++;
+	SDL_Surface* surface = LoadSurface(asset.filepath);
+	if (!surface) {
+		LOG_AT(ERROR, Assets, "Failed to reload texture '{}' from {}", assetId, asset.filepath);
+		asset.bIsEvicted = false;
+		return nullptr;
+	}
+	SetResidentTexture(asset, SDL_CreateTextureFromSurface(renderer, surface));
+	SDL_FreeSurface(surface);
+	EnforceTextureBudget();
+	return asset.texture;
+}
+
+TextureHandle AssetManager::AcquireTexture(const std::string& assetId) {
+	auto it = textures.find(assetId);
+	if (it == textures.end()) {
+		return nullptr;
+	}
+	// An evicted texture counts as a miss when GetTexture reloads it
+	if (it->second->texture) {
+		hitCount++;
+	}
+	it->second->lastUsed = ++useCounter;
+	return it->second;
+}
+
+void AssetManager::SetTextureMemoryBudget(size_t bytes) {
+	textureMemoryBudget = bytes;
+	EnforceTextureBudget();
+}
+
+void AssetManager::EvictUnreferencedTextures() {
+	for (auto& texture : textures) {
+		// use_count() == 1 means only this map holds the handle
+		if (texture.second->texture && texture.second.use_count() == 1) {
+			EvictTexture(*texture.second);
+		}
+	}
+}
+
+AssetStats AssetManager::GetStats() const {
+	AssetStats stats;
+	stats.residentTextureBytes	= residentTextureBytes;
+	stats.textureMemoryBudget	= textureMemoryBudget;
+	stats.residentTextureCount	= 0;
+	stats.knownTextureCount		= static_cast<int>(textures.size());
+	stats.hits					= hitCount;
+	stats.misses				= missCount;
+	stats.evictions				= evictionCount;
+	for (const auto& texture : textures) {
+		if (texture.second->texture) {
+			stats.residentTextureCount++;
+		}
+	}
+	return stats;
+}
+
+TextureHandle& AssetManager::FindOrCreateAsset(const std::string& assetId, const std::string& filepath) {
+	TextureHandle& asset = textures[assetId];
+	if (!asset) {
+		asset = std::make_shared<TextureAsset>();
+	}
+	else if (asset->filepath != filepath) {
+		// The id now points at another file, the resident texture is stale
+		SetResidentTexture(*asset, nullptr);
+	}
+	asset->filepath = filepath;
+	return asset;
+}
+
+void AssetManager::SetResidentTexture(TextureAsset& asset, SDL_Texture* texture) {
+	asset.bIsEvicted = false;
+	if (asset.texture) {
+		SDL_DestroyTexture(asset.texture);
+		residentTextureBytes -= asset.sizeInBytes;
+	}
+
+	asset.texture = texture;
+	asset.sizeInBytes = 0;
+	if (texture) {
+		Uint32 format;
+		int width, height;
+		SDL_QueryTexture(texture, &format, nullptr, &width, &height);
+		asset.sizeInBytes = static_cast<size_t>(width) * height * SDL_BYTESPERPIXEL(format);
+		asset.lastUsed = ++useCounter;
+	}
+	residentTextureBytes += asset.sizeInBytes;
+}
+
+void AssetManager::EvictTexture(TextureAsset& asset) {
+	SetResidentTexture(asset, nullptr);
+	asset.bIsEvicted = true;
+	evictionCount++;
+}
+
+void AssetManager::EnforceTextureBudget() {
+	if (textureMemoryBudget == 0) {
+		return;
+	}
+
+	while (residentTextureBytes > textureMemoryBudget) {
+		// Linear scan for the least recently used candidate, the texture count is small
+		TextureAsset* leastRecentlyUsed = nullptr;
+		for (auto& texture : textures) {
+			TextureAsset& asset = *texture.second;
+			// Skip pinned textures and the one that was just used
+			if (!asset.texture || texture.second.use_count() > 1 || asset.lastUsed == useCounter) {
+				continue;
+			}
+			if (!leastRecentlyUsed || asset.lastUsed < leastRecentlyUsed->lastUsed) {
+				leastRecentlyUsed = &asset;
+			}
+		}
+
+		if (!leastRecentlyUsed) {
+			// Everything left is referenced, the budget is too small for the working set
+			return;
+		}
+		EvictTexture(*leastRecentlyUsed);
+	}
+}
+
+TextureFuture AssetManager::AddTextureAsync(const std::string& assetId, const std::string& filepath) {
+	auto promise = std::make_shared<std::promise<TextureHandle>>();
+	TextureFuture future = promise->get_future().share();
+
+	// Already on its way, a second decode would replace the first upload
+	auto pending = pendingTextures.find(assetId);
+	if (pending != pendingTextures.end() && pending->second.filepath == filepath) {
+		return pending->second.future;
+	}
+
+	TextureHandle& asset = FindOrCreateAsset(assetId, filepath);
+	if (asset->texture) {
+		hitCount++;
+		asset->lastUsed = ++useCounter;
+		promise->set_value(asset);
+		return future;
+	}
+	missCount++;
+	requestedTextureCount++;
+	pendingTextures[assetId] = { filepath, future };
+
+	// Packed textures are already decoded, they only need the upload
+	if (const ArchiveEntry* entry = FindArchiveEntry(filepath)) {
+		std::lock_guard<std::mutex> lock(decodedTexturesMutex);
+		decodedTextures.push_back({ assetId, filepath, CreateSurfaceFromArchive(*entry), promise });
+		decodedTextureCount++;
+		return future;
+	}
+
+	loaderThreads->Enqueue([this, assetId, filepath, promise]() {
+		SDL_Surface* surface = DecodeImage(filepath);
+
+		std::lock_guard<std::mutex> lock(decodedTexturesMutex);
+		decodedTextures.push_back({ assetId, filepath, surface, promise });
+		decodedTextureCount++;
+	});
+
+	return future;
+}
+
+void AssetManager::UploadTexture(SDL_Renderer* renderer, DecodedTexture& decodedTexture) {
+	TextureHandle& asset = FindOrCreateAsset(decodedTexture.assetId, decodedTexture.filepath);
+	if (decodedTexture.surface) {
+		SetResidentTexture(*asset, SDL_CreateTextureFromSurface(renderer, decodedTexture.surface));
+		SDL_FreeSurface(decodedTexture.surface);
+		EnforceTextureBudget();
+	}
+	else {
+		LOG_AT(ERROR, Assets, "Failed to load texture '{}' from {}: {}", decodedTexture.assetId, decodedTexture.filepath, IMG_GetError());
+	}
+
+	// Hot reloads are not part of the load progress and nobody waits on them
+	if (decodedTexture.promise) {
+		uploadedTextureCount++;
+		decodedTexture.promise->set_value(asset);
+		auto pending = pendingTextures.find(decodedTexture.assetId);
+		if (pending != pendingTextures.end() && pending->second.filepath == decodedTexture.filepath) {
+			pendingTextures.erase(pending);
+		}
+	}
+}
+
+void AssetManager::ProcessPendingUploads(SDL_Renderer* renderer, double budgetMs) {
+	const Uint64 startCounter = SDL_GetPerformanceCounter();
+	const Uint64 budgetCounter = static_cast<Uint64>(budgetMs * SDL_GetPerformanceFrequency() / 1000.0);
+
+	do {
+		DecodedTexture decodedTexture;
+		{
+			std::lock_guard<std::mutex> lock(decodedTexturesMutex);
+			if (decodedTextures.empty()) {
+				return;
+			}
+			decodedTexture = std::move(decodedTextures.front());
+			decodedTextures.pop_front();
+		}
+		UploadTexture(renderer, decodedTexture);
+	} while (SDL_GetPerformanceCounter() - startCounter < budgetCounter);
+}
+
+void AssetManager::WaitForPendingLoads(SDL_Renderer* renderer) {
+	while (bIsLoading()) {
+		// No frame to protect during startup, upload in large slices
+		ProcessPendingUploads(renderer, 100.0);
+		if (uploadedTextureCount < decodedTextureCount.load()) {
+			continue;
+		}
+		// Everything decoded so far is uploaded, give the loader threads time to finish the rest
+		SDL_Delay(1);
+	}
+}
+
+float AssetManager::GetLoadProgress() const {
+	if (requestedTextureCount == 0) {
+		return 1.0f;
+	}
+	return (decodedTextureCount.load() + uploadedTextureCount) / (2.0f * requestedTextureCount);
+}
+
+bool AssetManager::bIsLoading() const {
+	return uploadedTextureCount < requestedTextureCount;
+}
+
+bool AssetManager::MountArchive(const std::string& archivePath, const std::string& mountPoint) {
+	if (!archive.Open(archivePath)) {
+		return false;
+	}
+	archiveMountPoint = mountPoint;
+	return true;
+}
+
+const ArchiveEntry* AssetManager::FindArchiveEntry(const std::string& filepath) const {
+	if (!archive.bIsOpen() || filepath.compare(0, archiveMountPoint.size(), archiveMountPoint) != 0) {
+		return nullptr;
+	}
+	return archive.FindEntry(filepath.substr(archiveMountPoint.size()));
+}
+
+const uint8_t* AssetManager::GetArchiveEntryData(const ArchiveEntry& entry) const {
+	return archive.GetEntryData(entry);
+}
+
+SDL_Surface* AssetManager::LoadSurface(const std::string& filepath) const {
+	const ArchiveEntry* entry = FindArchiveEntry(filepath);
+	return entry ? CreateSurfaceFromArchive(*entry) : IMG_Load(filepath.c_str());
+}
+
+SDL_Surface* AssetManager::CreateSurfaceFromArchive(const ArchiveEntry& entry) const {
+	if (entry.type != ArchiveEntryType::Texture) {
+		SDL_SetError("'%s' is not packed as a texture", entry.path);
+		return nullptr;
+	}
+	// The surface doesn't own the pixels (SDL_PREALLOC), SDL_FreeSurface leaves the mapping alone
+	void* pixels = const_cast<uint8_t*>(archive.GetEntryData(entry));
+	return SDL_CreateRGBSurfaceWithFormatFrom(pixels, entry.width, entry.height, 32, entry.pitch, SDL_PIXELFORMAT_ARGB8888);
+}
+
+bool AssetManager::ReloadTexture(const std::string& filepath) {
+	const std::string normalizedFilepath = FileWatcher::NormalizePath(filepath);
+
+	bool bIsUsed = false;
+	for (auto& texture : textures) {
+		const TextureAsset& asset = *texture.second;
+		if (FileWatcher::NormalizePath(asset.filepath) != normalizedFilepath) {
+			continue;
+		}
+		bIsUsed = true;
+		// Evicted textures will pick the new file up on their next miss anyway
+		if (!asset.texture) {
+			continue;
+		}
+
+		// Always decode the loose file: the archive holds the old version of anything being edited
+		loaderThreads->Enqueue([this, assetId = texture.first, filepath = asset.filepath]() {
+			SDL_Surface* surface = DecodeImage(filepath);
+			std::lock_guard<std::mutex> lock(decodedTexturesMutex);
+			decodedTextures.push_back({ assetId, filepath, surface, nullptr });
+		});
+		LOG_AT(INFO, Assets, "Hot reloading texture '{}' from {}", texture.first, asset.filepath);
+	}
+	return bIsUsed;
 }
@@ -1,24 +1,136 @@
 #pragma once
 
-#include <map>
+#include <unordered_map>
 #include <string>
+#include <deque>
+#include <mutex>
+#include <atomic>
+#include <future>
+#include <memory>
+#include <cstdint>
 #include <SDL2/SDL.h>
 
+#include "../ThreadPool/ThreadPool.h"
+#include "../AssetArchive/AssetArchive.h"
 
+// A texture known to the AssetManager. The texture may be evicted (nullptr) and reloaded from filepath later.
+struct TextureAsset {
+	SDL_Texture* texture = nullptr;
+	std::string filepath;
+	size_t sizeInBytes = 0;
+	uint64_t lastUsed = 0;		// AssetManager use counter at the last access, smallest is evicted first
+	bool bIsEvicted = false;	// freed by the memory budget, GetTexture reloads it. Failed and pending loads stay nullptr
+};
+
+// Holding a handle pins the texture: only textures nobody holds a handle to are evicted
+typedef std::shared_ptr<TextureAsset> TextureHandle;
+// Resolves to the texture handle once the main thread has uploaded it (texture is nullptr if decoding failed)
+typedef std::shared_future<TextureHandle> TextureFuture;
+
+struct AssetStats {
+	size_t residentTextureBytes;
+	size_t textureMemoryBudget;		// 0 = unlimited
+	int residentTextureCount;
+	int knownTextureCount;
+	uint64_t hits;					// texture was resident when added or acquired
+	uint64_t misses;				// texture had to be loaded, or reloaded after an eviction
+	uint64_t evictions;
+};
 
 class AssetManager {
 private:
-	std::map<std::string, SDL_Texture*> textures;
+	std::unordered_map<std::string, TextureHandle> textures;
+
+	// Image decoded by a loader thread, waiting for the main thread to upload it to the GPU
+	struct DecodedTexture {
+		std::string assetId;
+		std::string filepath;
+		SDL_Surface* surface = nullptr;
+		std::shared_ptr<std::promise<TextureHandle>> promise;	// nullptr for hot reloads
+	};
+
+	std::unique_ptr<ThreadPool> loaderThreads;
+	std::mutex decodedTexturesMutex;
+	std::deque<DecodedTexture> decodedTextures;
+
+	// Async loads not uploaded yet, by asset id. Requesting the same file again shares the load
+	struct PendingTexture {
+		std::string filepath;
+		TextureFuture future;
+	};
+	std::unordered_map<std::string, PendingTexture> pendingTextures;
+
+	// Load progress counters, requested is only written on the main thread
+	int requestedTextureCount = 0;
+	std::atomic<int> decodedTextureCount { 0 };
+	int uploadedTextureCount = 0;
 
+	// Packed assets, looked up before falling back to loose files under archiveMountPoint
+	AssetArchive archive;
+	std::string archiveMountPoint;
 
+	// Residency bookkeeping
+	SDL_Renderer* renderer = nullptr;	// used to reload evicted textures on a miss
+	size_t textureMemoryBudget = 0;
+	size_t residentTextureBytes = 0;
+	uint64_t useCounter = 0;
+	uint64_t hitCount = 0;
+	uint64_t missCount = 0;
+	uint64_t evictionCount = 0;
+
+	void UploadTexture(SDL_Renderer* renderer, DecodedTexture& decodedTexture);
+	// Wrap the mapped ARGB8888 pixels of a packed texture in a surface, no decode and no copy
+	SDL_Surface* CreateSurfaceFromArchive(const ArchiveEntry& entry) const;
+	// Load synchronously from the archive or disk, nullptr on failure
+	SDL_Surface* LoadSurface(const std::string& filepath) const;
+
+	TextureHandle& FindOrCreateAsset(const std::string& assetId, const std::string& filepath);
+	void SetResidentTexture(TextureAsset& asset, SDL_Texture* texture);
+	void EvictTexture(TextureAsset& asset);
+	// Evict unreferenced textures, least recently used first, until the resident bytes fit the budget
+	void EnforceTextureBudget();
 
 public:
 	AssetManager();
 	~AssetManager();
 
+	// Renderer used to reload evicted textures when GetTexture misses
+	void SetRenderer(SDL_Renderer* renderer);
+
 	void ClearAssets();
 	void AddTexture(SDL_Renderer* renderer, const std::string& assetId, const std::string& filepath);
 	SDL_Texture* GetTexture(const std::string& assetId);
 
-};
+	/// Sharing and residency
+	// Handle to an added texture (nullptr if the id is unknown), keeps it from being evicted while held
+	TextureHandle AcquireTexture(const std::string& assetId);
+	// 0 = unlimited
+	void SetTextureMemoryBudget(size_t bytes);
+	// Free every texture nobody holds a handle to, e.g. after switching levels
+	void EvictUnreferencedTextures();
+	AssetStats GetStats() const;
 
+	/// Async loading
+	// Decode the image on a loader thread, the texture is created later by ProcessPendingUploads()
+	TextureFuture AddTextureAsync(const std::string& assetId, const std::string& filepath);
+	// Upload decoded images to textures on the main thread until budgetMs is spent (at least one per call)
+	void ProcessPendingUploads(SDL_Renderer* renderer, double budgetMs);
+	// Block until every requested texture is decoded and uploaded (level startup)
+	void WaitForPendingLoads(SDL_Renderer* renderer);
+	// 0.0 - 1.0, counts decoding and uploading as half of the work each
+	float GetLoadProgress() const;
+	bool bIsLoading() const;
+
+	/// Asset archive
+	// Serve files under mountPoint (e.g. "./assets/") from a packed archive when they are in it
+	bool MountArchive(const std::string& archivePath, const std::string& mountPoint);
+	// Packed entry for a loose file path, nullptr when no archive is mounted or the file isn't packed
+	const ArchiveEntry* FindArchiveEntry(const std::string& filepath) const;
+	const uint8_t* GetArchiveEntryData(const ArchiveEntry& entry) const;
+
+	/// Hot reload
+	// Re-decode every resident texture loaded from filepath on a loader thread. The new texture replaces
+	// the old one inside the same TextureAsset during ProcessPendingUploads, so handles and sprites stay valid.
+	// Returns false if no texture uses that file.
+	bool ReloadTexture(const std::string& filepath);
+};
@@ -1,20 +1,18 @@
 #pragma once
 
-#include <SDL2/SDL.h>
-
 struct AnimationComponent {
 	int totalFrames;
 	int currentFrame;
 	int frameChangeRate;
 	bool bIsLooping;
-	int startTime;
+	double elapsedTime;		// seconds of game time since the animation started, advanced by the AnimationSystem
 
 	AnimationComponent(int totalFrames = 1, int frameChangeRate = 1, bool bIsLooping = true) {
 		this->totalFrames = totalFrames;
 		this->currentFrame = 1;
 		this->frameChangeRate = frameChangeRate;
 		this->bIsLooping = bIsLooping;
-		this->startTime = SDL_GetTicks();
+		this->elapsedTime = 0.0;
 	}
 
 };
@@ -0,0 +1,13 @@
+#pragma once
+
+#include <string>
+
+struct ScriptComponent {
+	std::string behaviour;		// key in the Behaviours table of the loaded scripts
+	int behaviourIndex;			// resolved by the ScriptSystem on its first update, -1 until then
+
+	ScriptComponent(std::string behaviour = "") {
+		this->behaviour = behaviour;
+		this->behaviourIndex = -1;
+	}
+};
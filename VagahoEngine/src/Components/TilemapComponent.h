@@ -0,0 +1,53 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cstdint>
+
+// Tiles per chunk side, the TilemapSystem bakes every chunk into one cached texture
+const int TILEMAP_CHUNK_SIZE = 16;
+
+struct TilemapComponent {
+	std::string assetId;				// tileset texture
+	int columns;						// map size in tiles
+	int rows;
+	int tileSize;						// tile resolution in the tileset
+	int tilesetColumns;
+	std::vector<int> tiles;				// row major tile ids [y * columns + x], negative ids are empty
+	std::vector<uint8_t> dirtyChunks;	// chunk has to be rebaked [chunkY * GetChunkColumns() + chunkX]
+
+	TilemapComponent(std::string assetId = "", int columns = 0, int rows = 0, int tileSize = 0, int tilesetColumns = 1, std::vector<int> tiles = {}) {
+		this->assetId			= assetId;
+		this->columns			= columns;
+		this->rows				= rows;
+		this->tileSize			= tileSize;
+		this->tilesetColumns	= tilesetColumns;
+		this->tiles				= std::move(tiles);
+		this->tiles.resize(static_cast<size_t>(columns) * rows, -1);
+		this->dirtyChunks.assign(static_cast<size_t>(GetChunkColumns()) * GetChunkRows(), 1);
+	}
+
+	int GetChunkColumns() const { return (columns + TILEMAP_CHUNK_SIZE - 1) / TILEMAP_CHUNK_SIZE; }
+	int GetChunkRows() const { return (rows + TILEMAP_CHUNK_SIZE - 1) / TILEMAP_CHUNK_SIZE; }
+
+	int GetTile(int x, int y) const {
+		return tiles[static_cast<size_t>(y) * columns + x];
+	}
+
+	void SetTile(int x, int y, int tileId) {
+		int& tile = tiles[static_cast<size_t>(y) * columns + x];
+		if (tile != tileId) {
+			tile = tileId;
+			dirtyChunks[(y / TILEMAP_CHUNK_SIZE) * GetChunkColumns() + x / TILEMAP_CHUNK_SIZE] = 1;
+		}
+	}
+
+	// Replace every tile (same map size), only the chunks with a changed tile get rebaked
+	void SetTiles(const std::vector<int>& newTiles) {
+		for (int y = 0; y < rows; y++) {
+			for (int x = 0; x < columns; x++) {
+				SetTile(x, y, newTiles[static_cast<size_t>(y) * columns + x]);
+			}
+		}
+	}
+};
@@ -0,0 +1,10 @@
+#pragma once
+
+// Marks an entity created by the WorldStreamer for a region, it is destroyed when the region unloads
+struct WorldRegionComponent {
+	int regionIndex;
+
+	WorldRegionComponent(int regionIndex = -1) {
+		this->regionIndex = regionIndex;
+	}
+};
@@ -1,4 +1,5 @@
 #include "ECS.h"
+#include "../Profiler/Profiler.h"
 
 
 ComponentId IComponent::nextId = 0;
@@ -9,7 +10,7 @@ EntityId Entity::GetId() const {
 
 void Entity::Destroy() {
     ecsManager->DestroyEntity(*this);
-    LOG_INFO("Entity #" + std::to_string(this->GetId()) + " destroyed");
+    LOG_AT(VERBOSE, ECS, "Entity #{} destroyed", this->GetId());
 }
 
 void System::AddEntityToSystem(Entity entity) {
@@ -57,7 +58,7 @@ void System::RemoveEntityFromSystem(Entity entity) {
 
 }
 
-std::vector<Entity> System::GetSystemEntities() const {
+const std::vector<Entity>& System::GetSystemEntities() const {
     return entities;
 }
 
@@ -84,22 +85,50 @@ Entity ECSManager::CreateEntity() {
 
     Entity entity(entityId);
     entity.ecsManager = this;
-    entitiesToCreate.insert(entity);  
+    entitiesToCreate.push_back(entity);
 
-     LOG_INFO("Entity created with id = " + std::to_string(entityId));
+     LOG_AT(VERBOSE, ECS, "Entity created with id = {}", entityId);
 
     return entity;    
 }
 
+std::vector<Entity> ECSManager::CreateEntities(size_t count) {
+    std::vector<Entity> entities;
+    entities.reserve(count);
+
+    // Reused ids first, then a contiguous run of new ones
+    while (entities.size() < count && !freeIds.empty()) {
+        Entity entity(freeIds.front());
+        freeIds.pop_front();
+        entity.ecsManager = this;
+        entities.push_back(entity);
+    }
+    const size_t newCount = count - entities.size();
+    if (entityCount + newCount > entityComponentSignatures.size()) {
+        entityComponentSignatures.resize(entityCount + newCount);
+    }
+    for (size_t i = 0; i < newCount; i++) {
+        Entity entity(entityCount++);
+        entity.ecsManager = this;
+        entities.push_back(entity);
+    }
+
+    entitiesToCreate.insert(entitiesToCreate.end(), entities.begin(), entities.end());
+
+    LOG_AT(VERBOSE, ECS, "{} entities created", count);
+
+    return entities;
+}
+
 void ECSManager::DestroyEntity(Entity entity) {
-    entitiesToDestroy.insert(entity);
+    entitiesToDestroy.push_back(entity);
 }
 
 void ECSManager::AddEntityToSystems(Entity entity) {
     const auto entityId = entity.GetId();
     const auto& entityComponentSignature = entityComponentSignatures[entityId];
 
-    for (auto system : systems) {
+    for (const auto& system : systems) {
         const auto& sytemComponentSignature = system.second->GetComponentSignature();
 
         // bitwise sorcery
@@ -107,31 +136,39 @@ void ECSManager::AddEntityToSystems(Entity entity) {
 
         if (isInterested) {
             system.second->AddEntityToSystem(entity);
+            system.second->OnEntityAdded(entity);
         }
     }
 
 }
 
 void ECSManager::RemoveEntityFromSystems(Entity entity) {
-    for (auto system : systems) {
+    for (const auto& system : systems) {
         system.second->RemoveEntityFromSystem(entity);
+        system.second->OnEntityRemoved(entity);
     }
 }
 
 void ECSManager::Update() {
+    PROFILE_SCOPE("ECSManager::Update");
     // Process the entities waiting to be created to the active Systems
-    for (auto entity : entitiesToCreate) {
-        AddEntityToSystems(entity);
+    // By index, OnEntityAdded may create more entities, they join in this Update too
+    for (size_t i = 0; i < entitiesToCreate.size(); i++) {
+        AddEntityToSystems(entitiesToCreate[i]);
     }
     entitiesToCreate.clear();
 
-    // Process the entities waiting to be destroyed from the active Systems
-    for (auto entity : entitiesToDestroy) {
+    // Process the entities waiting to be destroyed from the active Systems, in id order and once each
+    // Entities destroyed by OnEntityRemoved wait for the next Update
+    destroyingEntities.swap(entitiesToDestroy);
+    std::sort(destroyingEntities.begin(), destroyingEntities.end());
+    destroyingEntities.erase(std::unique(destroyingEntities.begin(), destroyingEntities.end()), destroyingEntities.end());
+    for (auto entity : destroyingEntities) {
         RemoveEntityFromSystems(entity);
         entityComponentSignatures[entity.GetId()].reset();
 
         // Make the entity Id available to be reused
         freeIds.push_back(entity.GetId());
     }
-    entitiesToDestroy.clear();
+    destroyingEntities.clear();
 }
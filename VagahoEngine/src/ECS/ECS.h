@@ -92,11 +92,16 @@ private:
 	std::vector<Entity> entities;
 public:
 	System() = default;
-	~System() = default;
+	virtual ~System() = default;
 
 	void AddEntityToSystem(Entity entity);
 	void RemoveEntityFromSystem(Entity entity);
-	std::vector<Entity> GetSystemEntities() const;
+	// Called after an entity joined the system, with its components in place
+	virtual void OnEntityAdded(Entity) {}
+	// Called for every system when an entity is destroyed, to release per-entity data a system keeps
+	virtual void OnEntityRemoved(Entity) {}
+	// A reference to the system's own list, valid until an entity joins or leaves the system
+	const std::vector<Entity>& GetSystemEntities() const;
 	const Signature& GetComponentSignature() const;
 
 	// Define the component type T that entities must have
@@ -174,9 +179,11 @@ class ECSManager {
 private:
 	EntityId entityCount = 0;
 
-	// set if entities to be added or removed in the next registry Update()
-	std::set<Entity> entitiesToCreate;
-	std::set<Entity> entitiesToDestroy;
+	// Entities to be added or removed in the next registry Update()
+	// Vectors keep their capacity between frames, a steady state Update doesn't allocate
+	std::vector<Entity> entitiesToCreate;
+	std::vector<Entity> entitiesToDestroy;
+	std::vector<Entity> destroyingEntities;	// entitiesToDestroy while Update processes them
 	// Vector of component pools, each pool contains all the data for certain a component type
 	// [Vector index = component type id]
 	// [Pool index = entity id]
@@ -203,7 +210,13 @@ public:
 
 	/// Entity Functions
 	Entity CreateEntity();
+	// Create count entities at once, ids are contiguous unless freed ids are waiting to be reused
+	std::vector<Entity> CreateEntities(size_t count);
 	void DestroyEntity(Entity entity);
+	// Entity ids handed out so far, ids of destroyed entities included
+	EntityId GetEntityIdCount() const { return entityCount; }
+	// Components an entity has, none for a destroyed entity or a freed id
+	const Signature& GetEntitySignature(Entity entity) const { return entityComponentSignatures[entity.GetId()]; }
 
 	// Check the component signature of an entity and add the entity to the interested system
 	void AddEntityToSystems(Entity entity);
@@ -213,6 +226,8 @@ public:
 	/// Component Functions
 	// Add a component of type TComponent to an entity
 	template <typename TComponent, typename ...TArgs> void AddComponent(Entity entity, TArgs&& ...args);
+	// Add components[i] to entities[i] for count entities: one pool resize, then a straight copy
+	template <typename TComponent> void AddComponents(const Entity* entities, const TComponent* components, size_t count);
 	// Remove a component of type TComponent from an entity
 	template <typename TComponent> void RemoveComponent(Entity entity);
 	// Check if a certain component is attached to a certain entity
@@ -224,7 +239,10 @@ public:
 	template <typename TSystem> void RemoveSystem();
 	template <typename TSystem> bool bHasSystem() const;
 	template <typename TSystem> TSystem& GetSystem() const;
-	
+
+private:
+	// Pool of TComponent, created on first use
+	template <typename TComponent> std::shared_ptr<Pool<TComponent>> GetOrCreateComponentPool();
 };
 
 /// IMPLEMENTATION ///////////////////////////////////////////////////////////////////////////////////////////////
@@ -239,11 +257,9 @@ inline void System::AddRequiredComponent() {
 	componentSignature.set(componentId);
 }
 
-template<typename TComponent, typename ...TArgs>
-inline void ECSManager::AddComponent(Entity entity, TArgs && ...args)
-{
+template<typename TComponent>
+inline std::shared_ptr<Pool<TComponent>> ECSManager::GetOrCreateComponentPool() {
 	const auto componentId = Component<TComponent>::GetId();
-	const auto entityId = entity.GetId();
 
 	// check if componentId is greater than the current size of componentPools
 	// resize the pools vector if required
@@ -258,7 +274,16 @@ inline void ECSManager::AddComponent(Entity entity, TArgs && ...args)
 	}
 
 	// Fetch the pool of component values for that component type
-	std::shared_ptr<Pool<TComponent>> componentPool = std::static_pointer_cast<Pool<TComponent>>(componentPools[componentId]);
+	return std::static_pointer_cast<Pool<TComponent>>(componentPools[componentId]);
+}
+
+template<typename TComponent, typename ...TArgs>
+inline void ECSManager::AddComponent(Entity entity, TArgs && ...args)
+{
+	const auto componentId = Component<TComponent>::GetId();
+	const auto entityId = entity.GetId();
+
+	std::shared_ptr<Pool<TComponent>> componentPool = GetOrCreateComponentPool<TComponent>();
 
 	// Check if the entity id is greater than the current size of the component pool
 	// resize the pool if required
@@ -275,7 +300,31 @@ inline void ECSManager::AddComponent(Entity entity, TArgs && ...args)
 	// Change the component signature of the entity and set componenId on the bitset to 1
 	entityComponentSignatures[entityId].set(componentId);
 
-	// LOG_INFO("Component id = '" + std::to_string(componentId) + "' was added to Entity id = '" + std::to_string(entityId) + "'");
+	// LOG_AT(VERBOSE, ECS, "Component id = '{}' was added to Entity id = '{}'", componentId, entityId);
+}
+
+template<typename TComponent>
+inline void ECSManager::AddComponents(const Entity* entities, const TComponent* components, size_t count) {
+	if (count == 0) {
+		return;
+	}
+	const auto componentId = Component<TComponent>::GetId();
+	std::shared_ptr<Pool<TComponent>> componentPool = GetOrCreateComponentPool<TComponent>();
+
+	// Grow the pool once for the whole batch
+	EntityId maxEntityId = 0;
+	for (size_t i = 0; i < count; i++) {
+		maxEntityId = std::max(maxEntityId, entities[i].GetId());
+	}
+	if (maxEntityId >= static_cast<EntityId>(componentPool->GetComponentPoolSize())) {
+		componentPool->ResizeComponentPool(maxEntityId + 1);
+	}
+
+	for (size_t i = 0; i < count; i++) {
+		const auto entityId = entities[i].GetId();
+		componentPool->SetComponentToEntityId(entityId, components[i]);
+		entityComponentSignatures[entityId].set(componentId);
+	}
 }
 
 template<typename TComponent>
@@ -283,7 +332,7 @@ inline void ECSManager::RemoveComponent(Entity entity) {
 	const auto componentId = Component<TComponent>::GetId();
 	const auto entityId = entity.GetId();
 	entityComponentSignatures[entityId].set(componentId, false);
-	// LOG_INFO("Component id: = '" + std::to_string(componentId) + "' was removed from the Entity id = '" + std::to_string(entityId) + "'");
+	// LOG_AT(VERBOSE, ECS, "Component id: = '{}' was removed from the Entity id = '{}'", componentId, entityId);
 }
 
 template<typename TComponent>
@@ -293,10 +342,10 @@ inline bool ECSManager::bHasComponent(Entity entity) const {
 	// test checks if componentId at the specific entityId is turned on in the bitset
 	bool result = entityComponentSignatures[entityId].test(componentId);
 	/*if (result) {
-		LOG_INFO("Entity id = '" + std::to_string(entityId) + "' does have the Component id = '" + std::to_string(componentId) + "'");
+		LOG_AT(VERBOSE, ECS, "Entity id = '{}' does have the Component id = '{}'", entityId, componentId);
 	}
 	else {
-		LOG_WARNING("Entity id = '" + std::to_string(entityId) + "' doesn't have the Component id = '" + std::to_string(componentId) + "'");
+		LOG_AT(VERBOSE, ECS, "Entity id = '{}' doesn't have the Component id = '{}'", entityId, componentId);
 	}*/
 	
 	return result;
@@ -308,8 +357,9 @@ inline TComponent& ECSManager::GetComponent(Entity entity) const
 {
 	const auto componentId = Component<TComponent>::GetId();
 	const auto entityId = entity.GetId();
-	auto componentPool = std::static_pointer_cast<Pool<TComponent>>(componentPools[componentId]);
-	//LOG_INFO("Component id = '" + std::to_string(componentId) + "' was received from Entity id '" + std::to_string(entityId) + "'");
+	// No shared_ptr copy, the manager owns the pool
+	auto componentPool = static_cast<Pool<TComponent>*>(componentPools[componentId].get());
+	//LOG_AT(VERBOSE, ECS, "Component id = '{}' was received from Entity id '{}'", componentId, entityId);
 	return componentPool->GetComponentForEntityId(entityId);
 }
 
@@ -1,6 +1,28 @@
 #pragma once
 
+#include <cstdint>
+#include <atomic>
+
+using EventTypeId = uint32_t;
+
 class Event {
 public:
 	Event() = default;
 };
+
+// Dense ids for event types, the same way Component<T>::GetId works for components
+// Atomic because worker threads can publish an event type for the first time
+class IEventType {
+protected:
+	inline static std::atomic<EventTypeId> nextId { 0 };
+};
+
+template <typename TEvent>
+class EventType : public IEventType {
+public:
+	// return the unique id of EventType<TEvent>
+	static EventTypeId GetId() {
+		static auto id = nextId++;
+		return id;
+	}
+};
@@ -1,163 +1,430 @@
 #pragma once
 
 #include "../Logger/Logger.h"
+#include "../Profiler/Profiler.h"
 #include "Event.h"
 
-#include <map>
-#include <typeindex>
+#include <vector>
 #include <memory>
-#include <list>
+#include <mutex>
+#include <atomic>
+#include <iterator>
+#include <algorithm>
+#include <utility>
+#include <cstddef>
 
-// Abstract base class defines the interface for all event listeners
-class IEventListener {
+// A listener is a plain function pointer plus the object it was subscribed with
+// The function is a stub generated per handler, so calling it is one indirect call and no virtual lookup
+struct EventDelegate {
+	using StubFunction = void (*)(void* owner, Event& event);
+
+	void* owner;
+	StubFunction function;		// nullptr once disconnected during a broadcast, removed right after it
+	uint32_t subscriptionId;
+
+	void operator ()(Event& event) const {
+		function(owner, event);
+	}
+};
+
+class EventManager;
+
+////////////////////////////////////////////////////////////////////////////////
+/// EVENT CONNECTION
+////////////////////////////////////////////////////////////////////////////////
+/// Returned by EventManager::Subscribe, the subscription lives as long as the
+/// connection does. Move only, dropping it (or Disconnect) unsubscribes.
+/// Outliving the EventManager is fine, the connection just does nothing then.
+////////////////////////////////////////////////////////////////////////////////
+class EventConnection {
 private:
-	// Pure virtual function to handle events, to be implemented by derived classes
-	virtual void HandleEvent(Event& event) = 0;
+	std::weak_ptr<EventManager*> manager;
+	EventTypeId eventTypeId = 0;
+	uint32_t subscriptionId = 0;
 
 public:
-	// Virtual destructor for proper cleanup of derived classes
-	virtual ~IEventListener() = default;
+	EventConnection() = default;
+	EventConnection(std::weak_ptr<EventManager*> manager, EventTypeId eventTypeId, uint32_t subscriptionId)
+		: manager(std::move(manager)), eventTypeId(eventTypeId), subscriptionId(subscriptionId) {}
+	~EventConnection() {
+		Disconnect();
+	}
+
+	EventConnection(const EventConnection&) = delete;
+	EventConnection& operator =(const EventConnection&) = delete;
 
-	// Public method to notify the listener of an event
-	// This method calls the private HandleEvent method
-	void NotifyListener(Event& event) {
-		HandleEvent(event);
+	EventConnection(EventConnection&& other) noexcept
+		: manager(std::move(other.manager)), eventTypeId(other.eventTypeId), subscriptionId(other.subscriptionId) {
+		other.manager.reset();
+	}
+
+	EventConnection& operator =(EventConnection&& other) noexcept {
+		if (this != &other) {
+			Disconnect();
+			manager = std::move(other.manager);
+			eventTypeId = other.eventTypeId;
+			subscriptionId = other.subscriptionId;
+			other.manager.reset();
+		}
+		return *this;
 	}
+
+	inline void Disconnect();
+	bool bIsConnected() const { return !manager.expired(); }
 };
 
-// Concrete implementation of IEventListener
-// This class template allows for type-safe event handling
-template <typename TOwner, typename TEvent>
-class EventListener : public IEventListener {
-private:
-	// Type alias for the event handler function pointer
-	typedef void (TOwner::* EventHandlerFunction)(TEvent&);
+namespace EventManagerDetail {
+
+	// Pulls TOwner and TEvent out of a void (TOwner::*)(TEvent&) handler
+	template <typename THandler>
+	struct HandlerTraits;
 
-	TOwner* ownerPtr;					// Pointer to the owner object
-	EventHandlerFunction handlerFunc;	// Function pointer to the event handler
+	template <typename TOwner_, typename TEvent_>
+	struct HandlerTraits<void (TOwner_::*)(TEvent_&)> {
+		using TOwner = TOwner_;
+		using TEvent = TEvent_;
+	};
 
-	// Implementation of the HandleEvent method
-	// This method invokes the handler function on the owner object
-	virtual void HandleEvent(Event& event) override {
-		std::invoke(handlerFunc, ownerPtr, static_cast<TEvent&>(event));
+	template <auto Handler>
+	void InvokeHandler(void* owner, Event& event) {
+		using Traits = HandlerTraits<decltype(Handler)>;
+		(static_cast<typename Traits::TOwner*>(owner)->*Handler)(static_cast<typename Traits::TEvent&>(event));
 	}
+}
 
+////////////////////////////////////////////////////////////////////////////////
+/// EVENT QUEUE
+////////////////////////////////////////////////////////////////////////////////
+/// Events of one type queued during the frame, stored by value in a vector.
+/// The buffers are swapped before any queue is dispatched, so whatever handlers
+/// queue while the queues drain waits for the next dispatch. Both vectors keep
+/// their capacity.
+/// Events published from worker threads carry an order key. They are merged
+/// in after the queued ones, sorted by key, so their order doesn't depend on
+/// thread timing.
+/// IEventQueue lets the EventManager keep every TEvent queue in one vector (like IPool).
+////////////////////////////////////////////////////////////////////////////////
+class IEventQueue {
 public:
-	EventListener(TOwner* ownerPtr, EventHandlerFunction handlerFunc)
-		: ownerPtr(ownerPtr), handlerFunc(handlerFunc) {}
+	virtual ~IEventQueue() = default;
+	// Moves the pending events to the draining buffer, false if there are none
+	virtual bool SwapBuffers() = 0;
+	// Delivers and clears the draining buffer
+	virtual void Dispatch(EventManager& eventManager) = 0;
+	// Moves the published events of a thread's queue of the same type into this one
+	virtual void MergePublished(IEventQueue& threadQueue) = 0;
+	virtual std::unique_ptr<IEventQueue> CreateEmpty() const = 0;
+};
+
+template <typename TEvent>
+class EventQueue : public IEventQueue {
+private:
+	struct PublishedEvent {
+		uint64_t orderKey;
+		TEvent event;
+	};
 
-	virtual ~EventListener() override = default;
+	std::vector<TEvent> pending;				// written by QueueEvent
+	std::vector<TEvent> draining;				// read by Dispatch
+	std::vector<PublishedEvent> published;		// written by PublishEvent, on the publishing thread's own queue
 
-	// Method to check if this listener belongs to a specific owner
-	bool OwnerMatches(TOwner* otherOwnerPtr) const {
-		return ownerPtr == otherOwnerPtr;
+public:
+	template <typename ...TArgs>
+	void Push(TArgs&& ...args) {
+		pending.emplace_back(std::forward<TArgs>(args)...);
 	}
 
-	// Method to check if this listener uses a specific handler function
-	bool HandlerMatches(EventHandlerFunction otherHandlerFunc) const {
-		return handlerFunc == otherHandlerFunc;
+	template <typename ...TArgs>
+	void Publish(uint64_t orderKey, TArgs&& ...args) {
+		published.push_back({ orderKey, TEvent(std::forward<TArgs>(args)...) });
 	}
-};
 
-// Type alias for a list of unique pointers to IEventListener
-typedef std::list<std::unique_ptr<IEventListener>>ListenerList;
+	virtual bool SwapBuffers() override {
+		if (!published.empty()) {
+			// Stable, so equal keys from one thread keep their publish order
+			std::stable_sort(published.begin(), published.end(), [](const PublishedEvent& a, const PublishedEvent& b) {
+				return a.orderKey < b.orderKey;
+			});
+			for (PublishedEvent& publishedEvent : published) {
+				pending.push_back(std::move(publishedEvent.event));
+			}
+			published.clear();
+		}
+		std::swap(pending, draining);
+		return !draining.empty();
+	}
+
+	virtual void Dispatch(EventManager& eventManager) override;
+
+	virtual void MergePublished(IEventQueue& threadQueue) override {
+		auto& threadPublished = static_cast<EventQueue<TEvent>&>(threadQueue).published;
+		std::move(threadPublished.begin(), threadPublished.end(), std::back_inserter(published));
+		threadPublished.clear();
+	}
+
+	virtual std::unique_ptr<IEventQueue> CreateEmpty() const override {
+		return std::make_unique<EventQueue<TEvent>>();
+	}
+};
 
 class EventManager {
 private:
-	// Map to store listeners for each event type
-	// The key is the type_index of the event, and the value is a unique_ptr to a ListenerList
-	std::map<std::type_index, std::unique_ptr<ListenerList>> listeners;
+	// Listeners of each event type, indexed by EventType<T>::GetId()
+	std::vector<std::vector<EventDelegate>> listeners;
+	// Connections hold a weak_ptr to this, it expires with the manager
+	std::shared_ptr<EventManager*> self;
+	uint32_t nextSubscriptionId = 0;
+	// Queued events of each type, indexed like listeners, nullptr until the first QueueEvent<T>
+	std::vector<std::unique_ptr<IEventQueue>> queues;
+	// One set of queues per publishing thread, only touched by that thread until the merge
+	// Shared with the thread, neither side is left with a dangling pointer when the other goes first
+	struct PublishBuffer {
+		std::vector<std::unique_ptr<IEventQueue>> queues;
+		std::atomic<bool> bIsRetired { false };		// the thread exited, released after its last merge
+	};
+	std::vector<std::shared_ptr<PublishBuffer>> publishBuffers;
+	std::mutex publishBuffersMutex;
+	// Tells managers apart in the threads' buffer lookup, unlike the address it is never reused
+	const uint64_t serial = NextSerial();
+	// Broadcasts in progress (handlers can broadcast too), removal is deferred while it isn't 0
+	int dispatchDepth = 0;
+	bool bHasDisconnectedListeners = false;
+
+	void RemoveDisconnectedListeners() {
+		for (auto& eventListeners : listeners) {
+			eventListeners.erase(std::remove_if(eventListeners.begin(), eventListeners.end(), [](const EventDelegate& listener) {
+				return listener.function == nullptr;
+			}), eventListeners.end());
+		}
+		bHasDisconnectedListeners = false;
+	}
+
+	static uint64_t NextSerial() {
+		static std::atomic<uint64_t> nextSerial { 0 };
+		return nextSerial++;
+	}
+
+	template <typename TEvent>
+	static EventQueue<TEvent>& GetQueue(std::vector<std::unique_ptr<IEventQueue>>& eventQueues) {
+		const auto eventTypeId = EventType<TEvent>::GetId();
+		if (eventTypeId >= eventQueues.size()) {
+			eventQueues.resize(eventTypeId + 1);
+		}
+		if (!eventQueues[eventTypeId]) {
+			eventQueues[eventTypeId] = std::make_unique<EventQueue<TEvent>>();
+		}
+		return static_cast<EventQueue<TEvent>&>(*eventQueues[eventTypeId]);
+	}
+
+	// A thread's buffers, one per manager it publishes to
+	struct ThreadPublishBuffer {
+		uint64_t serial;
+		std::weak_ptr<EventManager*> manager;		// expires with the manager
+		std::shared_ptr<PublishBuffer> buffer;
+	};
+	struct ThreadPublishBuffers {
+		std::vector<ThreadPublishBuffer> buffers;
+		// Tells the managers still alive that the thread won't publish again
+		~ThreadPublishBuffers() {
+			for (const ThreadPublishBuffer& threadBuffer : buffers) {
+				threadBuffer.buffer->bIsRetired.store(true, std::memory_order_release);
+			}
+		}
+	};
+
+	// The calling thread's buffer, created the first time the thread publishes to this manager
+	PublishBuffer& GetThreadPublishBuffer() {
+		thread_local ThreadPublishBuffers threadBuffers;
+		auto& buffers = threadBuffers.buffers;
+		// Drop the buffers of destroyed managers, they only hold on to memory
+		buffers.erase(std::remove_if(buffers.begin(), buffers.end(), [](const ThreadPublishBuffer& threadBuffer) {
+			return threadBuffer.manager.expired();
+		}), buffers.end());
+		for (const ThreadPublishBuffer& threadBuffer : buffers) {
+			if (threadBuffer.serial == serial) {
+				return *threadBuffer.buffer;
+			}
+		}
+		std::lock_guard<std::mutex> lock(publishBuffersMutex);
+		publishBuffers.push_back(std::make_shared<PublishBuffer>());
+		buffers.push_back({ serial, self, publishBuffers.back() });
+		return *publishBuffers.back();
+	}
+
+	void MergePublishedEvents() {
+		std::lock_guard<std::mutex> lock(publishBuffersMutex);
+		bool bHasRetiredBuffers = false;
+		for (auto& publishBuffer : publishBuffers) {
+			// Read before the merge, what a retired thread published last is still merged below
+			const bool bIsRetired = publishBuffer->bIsRetired.load(std::memory_order_acquire);
+			for (size_t i = 0; i < publishBuffer->queues.size(); i++) {
+				if (!publishBuffer->queues[i]) {
+					continue;
+				}
+				if (i >= queues.size()) {
+					queues.resize(i + 1);
+				}
+				if (!queues[i]) {
+					queues[i] = publishBuffer->queues[i]->CreateEmpty();
+				}
+				queues[i]->MergePublished(*publishBuffer->queues[i]);
+			}
+			if (bIsRetired) {
+				publishBuffer.reset();
+				bHasRetiredBuffers = true;
+			}
+		}
+		if (bHasRetiredBuffers) {
+			publishBuffers.erase(std::remove(publishBuffers.begin(), publishBuffers.end(), nullptr), publishBuffers.end());
+		}
+	}
+
 public:
-	EventManager() {
+	EventManager() : self(std::make_shared<EventManager*>(this)) {
 		LOG_INFO("EventManager constructor called!");
 	}
 	~EventManager() {
 		LOG_INFO("EventManager destructor called!");
 	}
 
+	EventManager(const EventManager&) = delete;
+	EventManager& operator =(const EventManager&) = delete;
+
 	//////////////////////////////////
 	/// Subscribe to an event type <T>
 	//////////////////////////////////
-	// Template function to subscribe an owner to an event of type TEvent
-	// TEvent: The type of event to subscribe to
-	// TOwner: The type of the object owning the handler function
-	template <typename TEvent, typename TOwner>
-	void Subscribe(TOwner* ownerPtr, void (TOwner::* handlerFunc)(TEvent&)) {
-		// Check if a listener list for this event type already exists
-		// typeid(TEvent) provides a unique identifier for the event type
-		// .get() is used to access the raw pointer from the unique_ptr
-		if (!listeners[typeid(TEvent)].get()) {
-			// If no listener list exists, create a new one
-			// std::make_unique creates a new ListenerList wrapped in a unique_ptr
-			listeners[typeid(TEvent)] = std::make_unique<ListenerList>();
-		}
-		// Create a new EventListener object
-		// This object links the owner (ownerPtr) with its event handling function (handlerFunc)
-		// std::make_unique is used to create a unique_ptr managing this new EventListener
-		auto newListener = std::make_unique<EventListener<TOwner, TEvent>>(ownerPtr, handlerFunc);
-		// Add the new listener to the list of listeners for this event type
-		// std::move is used to transfer ownership of the unique_ptr to the list
-		listeners[typeid(TEvent)]->push_back(std::move(newListener));
-	}
-
-	// clear subscriber list
-	void Reset() {
-		listeners.clear();
-	}
-
-	//////////////////////////////////////
-	/// Unsubscribe from an event type <T>
-	//////////////////////////////////////
-	template <typename TEvent, typename TOwner>
-	void Unsubscribe(TOwner* ownerPtr, void (TOwner::* handlerFunc)(TEvent&)) {
-		// Get the list of listeners for this event type
-		auto currentListeners = listeners[typeid(TEvent)].get();
-		if (currentListeners) {
-			// Use remove_if to eliminate matching listeners
-			currentListeners->remove_if([ownerPtr, handlerFunc](const auto& listener) { // use Lambda function to acces ownerPtr and handlerFunc 
-				// Attempt to cast the listener to the specific EventListener type
-				// This cast is necessary because we store listeners as IEventListener pointers
-				auto* listenerToRemove = dynamic_cast<EventListener<TOwner, TEvent>*>(listener.get());
-				// The listener should be removed if:
-				return	listenerToRemove &&									// 1. The cast was successful (listener is of the correct type)
-						listenerToRemove->OwnerMatches(ownerPtr) &&			// 2. The owner matches
-						listenerToRemove->HandlerMatches(handlerFunc);		// 3. The handler function matches
-				// If all conditions are true, this listener will be removed from the list
-				});
-			// After this operation, all matching listeners will be removed from the list
-		}
-		// If currentListeners is null, it means there are no listeners for this event type, so we don't need to do anything
+	// The handler is a template argument, the event type is taken from its signature.
+	// The subscription stays until the returned connection is dropped:
+	// collisionConnection = eventManager->Subscribe<&DamageSystem::OnCollision>(this);
+	template <auto Handler>
+	[[nodiscard]] EventConnection Subscribe(typename EventManagerDetail::HandlerTraits<decltype(Handler)>::TOwner* ownerPtr) {
+		using TEvent = typename EventManagerDetail::HandlerTraits<decltype(Handler)>::TEvent;
+		const auto eventTypeId = EventType<TEvent>::GetId();
+		if (eventTypeId >= listeners.size()) {
+			listeners.resize(eventTypeId + 1);
+		}
+		const uint32_t subscriptionId = nextSubscriptionId++;
+		listeners[eventTypeId].push_back({ ownerPtr, &EventManagerDetail::InvokeHandler<Handler>, subscriptionId });
+		return EventConnection(self, eventTypeId, subscriptionId);
 	}
 
+	// Called by EventConnection, safe from inside a handler of the same event
+	void Disconnect(EventTypeId eventTypeId, uint32_t subscriptionId) {
+		if (eventTypeId >= listeners.size()) {
+			return;
+		}
+		auto& eventListeners = listeners[eventTypeId];
+		auto listener = std::find_if(eventListeners.begin(), eventListeners.end(), [subscriptionId](const EventDelegate& listener) {
+			return listener.subscriptionId == subscriptionId;
+		});
+		if (listener == eventListeners.end()) {
+			return;
+		}
+		if (dispatchDepth > 0) {
+			// Keep the indices of the running broadcast valid
+			listener->function = nullptr;
+			bHasDisconnectedListeners = true;
+		}
+		else {
+			eventListeners.erase(listener);
+		}
+	}
 
 	//////////////////////////////////
 	/// Broadcast an event type <T>
 	//////////////////////////////////
-
-	// Template function to broadcast an event of type TEvent
-	// TArgs... allows for variadic arguments to construct the event
+	// Calls every listener right away. The event is built once and every listener gets the same instance
 	template <typename TEvent, typename ...TArgs>
 	void BroadcastEvent(TArgs && ...args) {
-		// Get the list of listeners for this specific event type
-		// typeid(TEvent) is used as the key to find the correct listener list
-		auto currentListeners = listeners[typeid(TEvent)].get();
-		// Check if there are any listeners registered for this event type
-		if (currentListeners) {
-			// Iterate through all listeners for this event type
-			for (auto it = currentListeners->begin(); it != currentListeners->end(); it++) {
-				// Get a raw pointer to the current listener
-				// We use get() because the listeners are stored as unique_ptr
-				auto listener = it->get();
-				// Construct the event object
-				// std::forward is used for perfect forwarding of arguments
-				// This allows for both lvalue and rvalue arguments to be correctly forwarded
-				TEvent event(std::forward<TArgs>(args)...);
-
-				// Notify the listener by calling its NotifyListener method
-				// This will internally call the HandleEvent method of the specific listener
-				listener->NotifyListener(event);
+		const auto eventTypeId = EventType<TEvent>::GetId();
+		if (eventTypeId >= listeners.size() || listeners[eventTypeId].empty()) {
+			return;
+		}
+		TEvent event(std::forward<TArgs>(args)...);
+		Dispatch(eventTypeId, event);
+	}
+
+	//////////////////////////////////
+	/// Queue an event type <T>
+	//////////////////////////////////
+	// Stores the event until the next DispatchQueuedEvents, so listeners don't run
+	// in the middle of the producer's loop
+	template <typename TEvent, typename ...TArgs>
+	void QueueEvent(TArgs && ...args) {
+		GetQueue<TEvent>(queues).Push(std::forward<TArgs>(args)...);
+	}
+
+	//////////////////////////////////
+	/// Publish an event type <T>
+	//////////////////////////////////
+	// QueueEvent for any thread: appends to the calling thread's own buffer, no lock after the
+	// thread's first publish. The buffers are merged by DispatchQueuedEvents, which must not run
+	// while workers publish (call it after joining them). Delivered after the queued events of the
+	// same type, sorted by orderKey: give every work item its own key (entity id, pair, index...)
+	// and the order is the same whatever thread ran it. A thread's buffer is released by the first
+	// merge after the thread exits
+	template <typename TEvent, typename ...TArgs>
+	void PublishEvent(uint64_t orderKey, TArgs && ...args) {
+		GetQueue<TEvent>(GetThreadPublishBuffer().queues).Publish(orderKey, std::forward<TArgs>(args)...);
+	}
+
+	// Delivers everything queued since the last call, in queue order per event type
+	// Events queued by the handlers are delivered by the next call
+	void DispatchQueuedEvents() {
+		PROFILE_SCOPE("DispatchQueuedEvents");
+		MergePublishedEvents();
+		const size_t queueCount = queues.size();
+		bool bHasEvents = false;
+		for (size_t i = 0; i < queueCount; i++) {
+			if (queues[i]) {
+				bHasEvents |= queues[i]->SwapBuffers();
+			}
+		}
+		if (!bHasEvents) {
+			return;
+		}
+		// By index, a handler queueing a new event type can grow queues
+		for (size_t i = 0; i < queueCount; i++) {
+			if (queues[i]) {
+				queues[i]->Dispatch(*this);
 			}
 		}
 	}
 
+	// Calls the listeners of eventTypeId with event
+	void Dispatch(EventTypeId eventTypeId, Event& event) {
+		if (eventTypeId >= listeners.size()) {
+			return;
+		}
+		// Indexed through listeners on every call, so a handler subscribing (even to a new event type)
+		// can't invalidate the loop. Listeners added during the broadcast are called from the next one
+		const size_t count = listeners[eventTypeId].size();
+		dispatchDepth++;
+		for (size_t i = 0; i < count; i++) {
+			const EventDelegate& listener = listeners[eventTypeId][i];
+			if (listener.function) {
+				listener(event);
+			}
+		}
+		dispatchDepth--;
+		if (dispatchDepth == 0 && bHasDisconnectedListeners) {
+			RemoveDisconnectedListeners();
+		}
+	}
 };
+
+template <typename TEvent>
+void EventQueue<TEvent>::Dispatch(EventManager& eventManager) {
+	const auto eventTypeId = EventType<TEvent>::GetId();
+	for (TEvent& event : draining) {
+		eventManager.Dispatch(eventTypeId, event);
+	}
+	draining.clear();
+}
+
+inline void EventConnection::Disconnect() {
+	if (auto managerPtr = manager.lock()) {
+		(*managerPtr)->Disconnect(eventTypeId, subscriptionId);
+	}
+	manager.reset();
+}
@@ -0,0 +1,148 @@
+#include "FileWatcher.h"
+
+#include "../Logger/Logger.h"
+
+#include <chrono>
+
+#ifdef __linux__
+#include <sys/inotify.h>
+#include <poll.h>
+#include <unistd.h>
+#endif
+
+// How long the watch thread sleeps between checks, also bounds how long shutdown waits
+const int WATCH_INTERVAL_MS = 250;
+
+FileWatcher::FileWatcher(const std::vector<std::string>& directories) {
+#ifdef __linux__
+	inotifyDescriptor = inotify_init1(IN_NONBLOCK);
+	if (inotifyDescriptor < 0) {
+		LOG_AT(ERROR, Assets, "FileWatcher: inotify_init1 failed, hot reload is disabled");
+		return;
+	}
+	for (const auto& directory : directories) {
+		AddWatch(directory);
+	}
+#else
+	this->directories = directories;
+	// Remember the current state so only later writes are reported
+	ScanDirectories(false);
+#endif
+
+	bIsRunning = true;
+	watchThread = std::thread(&FileWatcher::WatchLoop, this);
+}
+
+FileWatcher::~FileWatcher() {
+	bIsRunning = false;
+	if (watchThread.joinable()) {
+		watchThread.join();
+	}
+#ifdef __linux__
+	if (inotifyDescriptor >= 0) {
+		close(inotifyDescriptor);
+	}
+#endif
+}
+
+std::vector<std::string> FileWatcher::PollChangedFiles() {
+	std::lock_guard<std::mutex> lock(changedFilesMutex);
+	std::vector<std::string> result(changedFiles.begin(), changedFiles.end());
+	changedFiles.clear();
+	return result;
+}
+
+std::string FileWatcher::NormalizePath(const std::string& filepath) {
+	return std::filesystem::path(filepath).lexically_normal().generic_string();
+}
+
+void FileWatcher::PushChangedFile(const std::string& filepath) {
+	std::lock_guard<std::mutex> lock(changedFilesMutex);
+	changedFiles.insert(NormalizePath(filepath));
+}
+
+#ifdef __linux__
+
+void FileWatcher::AddWatch(const std::string& directory) {
+	// inotify isn't recursive, every subdirectory needs its own watch
+	// IN_CLOSE_WRITE catches in-place saves, IN_MOVED_TO editors that save to a temp file and rename it
+	int watchDescriptor = inotify_add_watch(inotifyDescriptor, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE);
+	if (watchDescriptor < 0) {
+		LOG_AT(WARNING, Assets, "FileWatcher: can't watch '{}'", directory);
+		return;
+	}
+	watchedDirectories[watchDescriptor] = directory;
+
+	std::error_code error;
+	for (const auto& item : std::filesystem::directory_iterator(directory, error)) {
+		if (item.is_directory()) {
+			AddWatch(item.path().string());
+		}
+	}
+}
+
+void FileWatcher::WatchLoop() {
+	alignas(inotify_event) char buffer[4096];
+	pollfd pollDescriptor = { inotifyDescriptor, POLLIN, 0 };
+
+	while (bIsRunning) {
+		if (poll(&pollDescriptor, 1, WATCH_INTERVAL_MS) <= 0) {
+			continue;
+		}
+
+		ssize_t length;
+		while ((length = read(inotifyDescriptor, buffer, sizeof(buffer))) > 0) {
+			for (char* cursor = buffer; cursor < buffer + length; ) {
+				const inotify_event* event = reinterpret_cast<const inotify_event*>(cursor);
+				cursor += sizeof(inotify_event) + event->len;
+
+				auto directory = watchedDirectories.find(event->wd);
+				if (event->len == 0 || directory == watchedDirectories.end()) {
+					continue;
+				}
+				const std::string filepath = directory->second + "/" + event->name;
+
+				if (event->mask & IN_ISDIR) {
+					if (event->mask & (IN_CREATE | IN_MOVED_TO)) {
+						AddWatch(filepath);
+					}
+				}
+				else if (event->mask & (IN_CLOSE_WRITE | IN_MOVED_TO)) {
+					PushChangedFile(filepath);
+				}
+			}
+		}
+	}
+}
+
+#else
+
+void FileWatcher::ScanDirectories(bool bReportChanges) {
+	std::error_code error;
+	for (const auto& directory : directories) {
+		for (const auto& item : std::filesystem::recursive_directory_iterator(directory, error)) {
+			if (!item.is_regular_file(error)) {
+				continue;
+			}
+			const std::string filepath = item.path().string();
+			const auto writeTime = item.last_write_time(error);
+
+			auto known = lastWriteTimes.find(filepath);
+			if (known == lastWriteTimes.end() || known->second != writeTime) {
+				lastWriteTimes[filepath] = writeTime;
+				if (bReportChanges) {
+					PushChangedFile(filepath);
+				}
+			}
+		}
+	}
+}
+
+void FileWatcher::WatchLoop() {
+	while (bIsRunning) {
+		std::this_thread::sleep_for(std::chrono::milliseconds(WATCH_INTERVAL_MS));
+		ScanDirectories(true);
+	}
+}
+
+#endif
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <set>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <unordered_map>
+#include <filesystem>
+
+////////////////////////////////////////////////////////////////////////////////
+/// FILE WATCHER
+////////////////////////////////////////////////////////////////////////////////
+/// Watches directories (recursively) on a background thread and collects the
+/// files that were written. Uses inotify on Linux, and falls back to polling
+/// the modification times on other platforms.
+/// Paths are reported lexically normalized with '/' separators ("assets/images/tank.png").
+////////////////////////////////////////////////////////////////////////////////
+class FileWatcher {
+private:
+	std::thread watchThread;
+	std::atomic<bool> bIsRunning { false };
+
+	std::mutex changedFilesMutex;
+	std::set<std::string> changedFiles;
+
+#ifdef __linux__
+	int inotifyDescriptor = -1;
+	std::unordered_map<int, std::string> watchedDirectories;	// watch descriptor -> directory
+	void AddWatch(const std::string& directory);
+#else
+	std::vector<std::string> directories;
+	std::unordered_map<std::string, std::filesystem::file_time_type> lastWriteTimes;
+	void ScanDirectories(bool bReportChanges);
+#endif
+
+	void WatchLoop();
+	void PushChangedFile(const std::string& filepath);
+
+public:
+	FileWatcher(const std::vector<std::string>& directories);
+	~FileWatcher();
+
+	FileWatcher(const FileWatcher&) = delete;
+	FileWatcher& operator =(const FileWatcher&) = delete;
+
+	// Files written since the last call, each path reported once
+	std::vector<std::string> PollChangedFiles();
+
+	// Same normalization as the reported paths, to compare them with asset paths
+	static std::string NormalizePath(const std::string& filepath);
+};
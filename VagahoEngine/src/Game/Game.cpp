@@ -6,6 +6,8 @@
 #include "../Components/SpriteComponent.h"
 #include "../Components/AnimationComponent.h"
 #include "../Components/BoxColliderComponent.h"
+#include "../Components/TilemapComponent.h"
+#include "../Components/ScriptComponent.h"
 #include "../Systems/MovementSystem.h"
 #include "../Systems/RenderSystem.h"
 #include "../Systems/AnimationSystem.h"
@@ -13,39 +15,72 @@
 #include "../Systems/CollisionRenderSystem.h"
 #include "../Systems/DamageSystem.h"
 #include "../Systems/KeyboardControlSystem.h"
+#include "../Systems/TilemapSystem.h"
+#include "../Systems/ScriptSystem.h"
+#include "../MapLoader/MapLoader.h"
+#include "../LevelLoader/LevelLoader.h"
+#include "../Profiler/Profiler.h"
 
 
 #include <SDL_image.h>
 #include <glm/glm.hpp>
+#include <imgui/imgui.h>
+#include <imgui/imgui_impl_sdlrenderer2.h>
 
 #include <iostream>
-#include <fstream>
 #include <string>
-#include <sstream>
-
-
+#include <chrono>
+#include <algorithm>
+#include <filesystem>
+#include <ctime>
+
+// Tileset layout of the level map
+const int TILESET_COLUMNS	= 10;	// Change this to match tileset grid
+const int TILESIZE			= 32;	// Change this to match tileset resolution
+const double TILE_SCALE		= 2.0;
+
+namespace {
+
+	// Keys that drive the engine rather than the game (quit, profiler overlay, trace)
+	// They are left out of recordings and ignored headless, a replay only gets gameplay input
+	bool bIsEngineControlKey(SDL_Keycode key) {
+		return key == SDLK_ESCAPE || key == SDLK_F1 || key == SDLK_F2;
+	}
+}
 
 Game::Game() {
 	bGameIsRunning	= false;
 	bDebugState		= false;
+	bProfilerOverlay	= false;
+	bIsHeadless		= false;
 	ticksPrevFrame	= 0;
 	deltaTime		= 0;
+	tick			= 0;
+	// Lua would pick a random seed anyway, this one can be recorded
+	randomSeed		= static_cast<uint32_t>(std::time(nullptr));
+	window			= nullptr;
+	renderer		= nullptr;
+	headlessSurface	= nullptr;
 
 	ecsManager		= std::make_unique<ECSManager>();
 	assetManager	= std::make_unique<AssetManager>();
 	eventManager	= std::make_unique<EventManager>();
+	scriptEngine	= std::make_unique<ScriptEngine>();
 
 	std::cout << "INITIAL TERMINAL COLOR" << std::endl;
 	LOG_INFO("Game constructor called!");
 }
 
 Game::~Game() {
+	Profiler::StopTrace();
 	LOG_INFO("Game destructor called!");
 }
 
-void Game::Initialize() {
+void Game::Initialize(bool bHeadless) {
+	bIsHeadless = bHeadless;
 	// Initialize SDL, window and renderer in this order
-	if (SDL_Init(SDL_INIT_EVERYTHING) != 0) {
+	// Headless only needs the timer and the event queue, a replay pushes the recorded key events into it
+	if (SDL_Init(bIsHeadless ? (SDL_INIT_TIMER | SDL_INIT_EVENTS) : SDL_INIT_EVERYTHING) != 0) {
 		LOG_ERROR("Error initializing SDL.");
 		return;
 	}
@@ -60,30 +95,142 @@ void Game::Initialize() {
 	//windowWidth		= 3440;
 	//windowHeight	= 1440;
 
-	window = SDL_CreateWindow(
-		"Vagaho Engine",
-		SDL_WINDOWPOS_CENTERED,
-		SDL_WINDOWPOS_CENTERED,
-		windowWidth,
-		windowHeight,
-		SDL_WINDOW_BORDERLESS
-	);
-	if (!window) {
-		LOG_ERROR("Error creating SDL window.");
-	}
-	renderer = SDL_CreateRenderer(window, -1, SDL_RENDERER_ACCELERATED | SDL_RENDERER_PRESENTVSYNC);
-	if (!renderer) {
-		LOG_ERROR("Error creating SDL renderer.");
-		return;
+	if (bIsHeadless) {
+		// Same size as the window, levels place their entities from it
+		headlessSurface = SDL_CreateRGBSurfaceWithFormat(0, windowWidth, windowHeight, 32, SDL_PIXELFORMAT_ARGB8888);
+		renderer = headlessSurface ? SDL_CreateSoftwareRenderer(headlessSurface) : nullptr;
+		if (!renderer) {
+			LOG_ERROR("Error creating headless renderer: {}", SDL_GetError());
+			return;
+		}
 	}
+	else {
+		window = SDL_CreateWindow(
+			"Vagaho Engine",
+			SDL_WINDOWPOS_CENTERED,
+			SDL_WINDOWPOS_CENTERED,
+			windowWidth,
+			windowHeight,
+			SDL_WINDOW_BORDERLESS
+		);
+		if (!window) {
+			LOG_ERROR("Error creating SDL window.");
+		}
+		renderer = SDL_CreateRenderer(window, -1, SDL_RENDERER_ACCELERATED | SDL_RENDERER_PRESENTVSYNC);
+		if (!renderer) {
+			LOG_ERROR("Error creating SDL renderer.");
+			return;
+		}
+	}
+	camera = { 0, 0, windowWidth, windowHeight };
+
+	assetManager->SetRenderer(renderer);
+	assetManager->SetTextureMemoryBudget(TEXTURE_MEMORY_BUDGET);
+
+	Profiler::SetThreadName("Main");
+	ImGui::CreateContext();
+	ImGui::GetIO().IniFilename = nullptr;
+	ImGui_ImplSDLRenderer2_Init(renderer);
+
 	// Real Fullscreen mode (change video mode from os to app
 	// SDL_SetWindowFullscreen(window, SDL_WINDOW_FULLSCREEN);
 	bGameIsRunning = true;
 }
 
 
+void Game::BuildTileLayer() {
+	// Same map size: only the tile ids changed, the tilemap rebakes just the chunks that differ
+	if (tilemapEntity) {
+		TilemapComponent& tilemap = tilemapEntity->GetComponent<TilemapComponent>();
+		if (tilemap.columns == mapData.columns && tilemap.rows == mapData.rows) {
+			tilemap.SetTiles(mapData.tiles);
+			return;
+		}
+		tilemapEntity->Destroy();
+	}
+
+	tilemapEntity = ecsManager->CreateEntity();
+	tilemapEntity->AddComponent<TransformComponent>(glm::vec2(0.0, 0.0), glm::vec2(TILE_SCALE, TILE_SCALE), 0.0);
+	tilemapEntity->AddComponent<TilemapComponent>("tilemap-image", mapData.columns, mapData.rows, TILESIZE, TILESET_COLUMNS, mapData.tiles);
+}
+
+void Game::EnableHotReload() {
+	fileWatcher = std::make_unique<FileWatcher>(std::vector<std::string>{ "./assets" });
+	LOG_INFO("Hot reload enabled for ./assets");
+}
+
+void Game::ProcessHotReload() {
+	for (const auto& filepath : fileWatcher->PollChangedFiles()) {
+		if (assetManager->ReloadTexture(filepath)) {
+			continue;
+		}
+		if (filepath == FileWatcher::NormalizePath(levelMapFilepath) && !pendingMapReload.valid()) {
+			LOG_INFO("Hot reloading map {}", levelMapFilepath);
+			pendingMapReload = std::async(std::launch::async, [filepath = levelMapFilepath]() {
+				MapData reloadedMap;
+				if (!MapLoader::Load(filepath, reloadedMap)) {
+					reloadedMap = MapData();
+				}
+				return reloadedMap;
+			});
+		}
+	}
+
+	// Swap the tile layer once the map is parsed, a map that failed to parse keeps the current one
+	if (pendingMapReload.valid() && pendingMapReload.wait_for(std::chrono::seconds(0)) == std::future_status::ready) {
+		MapData reloadedMap = pendingMapReload.get();
+		if (!reloadedMap.tiles.empty()) {
+			mapData = std::move(reloadedMap);
+			BuildTileLayer();
+		}
+	}
+}
+
 void Game::LoadMap(const std::string& filename) {
-	
+	levelMapFilepath = filename;
+
+	bool bLoaded;
+	if (const ArchiveEntry* mapEntry = assetManager->FindArchiveEntry(filename)) {
+		// Packed maps are already binary, no text parsing
+		bLoaded = MapLoader::ParseBinary(assetManager->GetArchiveEntryData(*mapEntry), mapEntry->size, mapData);
+	}
+	else {
+		bLoaded = MapLoader::Load(filename, mapData);
+	}
+
+	if (!bLoaded) {
+		LOG_ERROR("Failed to load map {}", filename);
+		mapData = MapData();
+	}
+	BuildTileLayer();
+}
+
+bool Game::StartWorldStreaming(const std::string& filename, const std::vector<int>& solidTileIds) {
+	WorldStreamerSettings settings;
+	settings.tilesetAssetId	= "tilemap-image";
+	settings.tileSize		= TILESIZE;
+	settings.tilesetColumns	= TILESET_COLUMNS;
+	settings.scale			= TILE_SCALE;
+	settings.viewDistance	= WORLD_VIEW_DISTANCE;
+	settings.solidTileIds	= solidTileIds;
+	// Headless runs are replays, regions have to appear at the same tick every run
+	settings.bDecodeOnCallingThread = bIsHeadless;
+
+	worldStreamer = std::make_unique<WorldStreamer>(settings);
+	bool bOpened = false;
+	if (const ArchiveEntry* worldEntry = assetManager->FindArchiveEntry(filename)) {
+		bOpened = worldStreamer->Open(assetManager->GetArchiveEntryData(*worldEntry), worldEntry->size);
+	}
+	else if (std::filesystem::exists(filename)) {
+		bOpened = worldStreamer->Open(filename);
+	}
+
+	if (!bOpened) {
+		worldStreamer.reset();
+		return false;
+	}
+	LOG_AT(INFO, World, "Streaming level map from {}", filename);
+	return true;
 }
 
 void Game::LoadLevel(int level) {
@@ -95,87 +242,89 @@ void Game::LoadLevel(int level) {
 	ecsManager->AddSystem<CollisionRenderSystem>();
 	ecsManager->AddSystem<DamageSystem>();
 	ecsManager->AddSystem<KeyboardControlSystem>();
+	ecsManager->AddSystem<TilemapSystem>();
+	ecsManager->AddSystem<ScriptSystem>(*scriptEngine);
 
+	// Subscriptions last until the systems drop their connections
+	ecsManager->GetSystem<DamageSystem>().SubscribeToEvents(eventManager);
+	ecsManager->GetSystem<KeyboardControlSystem>().SubscribeToEvents(eventManager);
+	ecsManager->GetSystem<ScriptSystem>().SubscribeToEvents(eventManager);
 
-	// Add assets to asset manager
-	assetManager->AddTexture(renderer, "tank-image", "./assets/images/tank-panther-right.png");
-	assetManager->AddTexture(renderer, "chopper-image", "./assets/images/chopper.png");
-	assetManager->AddTexture(renderer, "tilemap-image", "./assets/tilemaps/jungle.png");
-	assetManager->AddTexture(renderer, "radar-image", "./assets/images/radar.png");
-	assetManager->AddTexture(renderer, "truck-image", "./assets/images/truck-ford-left.png");
-
-	// TODO: Load tilemap
-	const int TILESET_COLUMNS	= 10;	// Change this to match tileset grid
-	const int TILESIZE			= 32;	// Change this to match tileset resolution
-	double tileScale			= 2.0;	
-
-	std::vector<std::vector<int>> mapData;
-	std::ifstream mapFile("./assets/tilemaps/jungle.map");
-	std::string line;
-	
-	while (std::getline(mapFile, line)) {
-		std::vector<int> row;
-		std::istringstream iss(line);
-		int tileId;
-		while (iss >> tileId) {
-			row.push_back(tileId);
-			if (iss.peek() == ',')
-				iss.ignore();
-		}
-		mapData.push_back(row);
+
+	// Drop the previous level's hold on its textures, whatever the new level doesn't share gets freed
+	levelTextures.clear();
+	assetManager->EvictUnreferencedTextures();
+
+	// Levels are described by Lua tables, see LevelLoader.h
+	const std::string levelFilepath = "./assets/scripts/Level" + std::to_string(level) + ".lua";
+	LevelDescription levelDescription;
+	if (!LevelLoader::Load(*scriptEngine, levelFilepath, glm::vec2(windowWidth, windowHeight), levelDescription)) {
+		LOG_ERROR("Can't load level {}", levelFilepath);
+		return;
 	}
-	mapFile.close();
+	LOG_AT(INFO, Scripting, "Script cache: {} hits, {} misses", scriptEngine->GetScriptCache().GetHitCount(), scriptEngine->GetScriptCache().GetMissCount());
 
-	for (int y = 0; y < mapData.size(); y++) {
-		for (int x = 0; x < mapData[y].size(); x++) {
-			int tileId = mapData[y][x];
-			int srcRectY = (tileId / TILESET_COLUMNS) * TILESIZE;
-			int srcRectX = (tileId % TILESET_COLUMNS) * TILESIZE;
+	// Add assets to asset manager
+	// Images are decoded on the loader threads while the map is parsed below
+	std::vector<TextureFuture> levelTextureFutures;
+	for (const LevelTexture& texture : levelDescription.textures) {
+		levelTextureFutures.push_back(assetManager->AddTextureAsync(texture.assetId, texture.filepath));
+	}
 
-			Entity tile = ecsManager->CreateEntity();
-			tile.AddComponent<TransformComponent>(glm::vec2(x * (tileScale * TILESIZE), y * (tileScale * TILESIZE)), glm::vec2(tileScale, tileScale), 0.0);
-			tile.AddComponent<SpriteComponent>("tilemap-image", TILESIZE, TILESIZE, 0, srcRectX, srcRectY);
-		}
+	// Load tilemap, large levels stream their regions around the camera instead
+	if (worldStreamer) {
+		worldStreamer->UnloadAll();
+		worldStreamer.reset();
+	}
+	if ((levelDescription.worldFilepath.empty() || !StartWorldStreaming(levelDescription.worldFilepath, levelDescription.solidTileIds)) && !levelDescription.mapFilepath.empty()) {
+		LoadMap(levelDescription.mapFilepath);
 	}
 
 	// Load Entities and Components
-	Entity tank01 = ecsManager->CreateEntity();
-	tank01.AddComponent<TransformComponent>(glm::vec2(20.0, 20.0), glm::vec2(2.0, 2.0), 0.0);
-	tank01.AddComponent<RigidbodyComponent>(glm::vec2(20.0, 0.0));
-	tank01.AddComponent<SpriteComponent>("tank-image", 32, 32, 1);
-	tank01.AddComponent<BoxColliderComponent>(32, 32);
-
-
-	Entity truck01 = ecsManager->CreateEntity();
-	truck01.AddComponent<TransformComponent>(glm::vec2(300.0, 20.0), glm::vec2(2.0, 2.0), 0.0);
-	truck01.AddComponent<RigidbodyComponent>(glm::vec2(-20.0, 0.0));
-	truck01.AddComponent<SpriteComponent>("truck-image", 32, 32, 1);
-	truck01.AddComponent<BoxColliderComponent>(32, 32);
-	
-	Entity chopper = ecsManager->CreateEntity();
-	chopper.AddComponent<TransformComponent>(glm::vec2(520.0, 200.0), glm::vec2(2.0, 2.0), 0.0);
-	chopper.AddComponent<RigidbodyComponent>(glm::vec2(0.0, 0.0));
-	chopper.AddComponent<SpriteComponent>("chopper-image", 32, 32, 2);
-	chopper.AddComponent<AnimationComponent>(2, 15, true);
-
-	Entity radarScreen = ecsManager->CreateEntity();
-	radarScreen.AddComponent<TransformComponent>(glm::vec2(windowWidth - (3*64), windowHeight - (3*64)), glm::vec2(2.0, 2.0), 0.0);
-	radarScreen.AddComponent<RigidbodyComponent>(glm::vec2(0.0, 0.0));
-	radarScreen.AddComponent<SpriteComponent>("radar-image", 64, 64, 3);
-	radarScreen.AddComponent<AnimationComponent>(8, 8, true);
+	LevelLoader::CreateEntities(*ecsManager, levelDescription);
 
+	// Make sure the first frame has every texture of the level
+	assetManager->WaitForPendingLoads(renderer);
+	// The level pins its textures for as long as it is loaded
+	for (const auto& textureFuture : levelTextureFutures) {
+		levelTextures.push_back(textureFuture.get());
+	}
 }
 
-void Game::Setup() {
-	LoadLevel(1);
+void Game::Setup(int level) {
+	// Prefer the packed assets when the game ships with them, loose files stay the fallback for development
+	if (!assetManager->MountArchive("./assets.vpak", "./assets/")) {
+		LOG_INFO("No asset archive mounted, loading loose files from ./assets/");
+	}
+
+	// The level and the seed are the scenario a recording replays
+	scriptEngine->SetRandomSeed(randomSeed);
+	if (recording) {
+		recording->level = static_cast<uint32_t>(level);
+		recording->seed = randomSeed;
+	}
+	tick = 0;
+	LoadLevel(level);
+}
+
+void Game::StartRecording(const std::string& filepath) {
+	recording = std::make_unique<InputRecording>();
+	recordingFilepath = filepath;
 }
 
 void Game::HandleFrameTime() {
 
+	// The script garbage collector gets the spare time of the frame (and a minimum slice when there is none)
+	{
+		PROFILE_SCOPE("Script GC");
+		scriptEngine->StepGarbageCollector(FRAME_TIME_DURATION - static_cast<double>(SDL_GetTicks() - ticksPrevFrame));
+	}
+
 	// Lock Frame Rate
 	int timeToDelay = FRAME_TIME_DURATION - (SDL_GetTicks() - ticksPrevFrame);
 
 	if (timeToDelay > 0 && timeToDelay <= FRAME_TIME_DURATION) {
+		PROFILE_SCOPE("Frame wait");
 		SDL_Delay(timeToDelay);
 	}
 
@@ -186,8 +335,26 @@ void Game::HandleFrameTime() {
 }
 
 void Game::HandleInput() {
+	PROFILE_SCOPE("HandleInput");
 	SDL_Event sdlEvent;
 	while (SDL_PollEvent(&sdlEvent)) {
+		const bool bIsKeyEvent = sdlEvent.type == SDL_KEYDOWN || sdlEvent.type == SDL_KEYUP;
+		if (bIsKeyEvent && bIsEngineControlKey(sdlEvent.key.keysym.sym)) {
+			if (bIsHeadless) {
+				continue;
+			}
+		}
+		else if (recording && bIsKeyEvent) {
+			recording->keyEvents.push_back(RecordedKeyEvent{
+				tick,
+				static_cast<uint16_t>(sdlEvent.type),
+				sdlEvent.key.repeat,
+				0,
+				sdlEvent.key.keysym.sym,
+				static_cast<uint16_t>(sdlEvent.key.keysym.scancode),
+				sdlEvent.key.keysym.mod
+			});
+		}
 		switch (sdlEvent.type) {
 			case SDL_QUIT:
 				bGameIsRunning = false;
@@ -199,29 +366,62 @@ void Game::HandleInput() {
 				if (sdlEvent.key.keysym.sym == SDLK_d) {
 					bDebugState = !bDebugState;
 				}
+				if (sdlEvent.key.keysym.sym == SDLK_F1) {
+					bProfilerOverlay = !bProfilerOverlay;
+				}
+				if (sdlEvent.key.keysym.sym == SDLK_F2) {
+					ToggleTrace();
+				}
 				eventManager->BroadcastEvent<KeyPressedEvent>(sdlEvent.key.keysym.sym);
 				break;
+			case SDL_RENDER_TARGETS_RESET:
+			case SDL_RENDER_DEVICE_RESET:
+				ecsManager->GetSystem<TilemapSystem>().InvalidateChunks();
+				break;
 		}
 	}
 }
 
 void Game::Update() {
-	
-	HandleFrameTime();
-
-	// Reset all event handlers for the current frame
-	eventManager->Reset();
+	PROFILE_SCOPE("Update");
+	if (fileWatcher) {
+		PROFILE_SCOPE("HotReload");
+		ProcessHotReload();
+	}
 
-	// Process Subscriptions of the events for all systems
-	ecsManager->GetSystem<DamageSystem>().SubscribeToEvents(eventManager);
-	ecsManager->GetSystem<KeyboardControlSystem>().SubscribeToEvents(eventManager);
+	// Request the regions coming into view and spawn the ones decoded since the last frame
+	if (worldStreamer) {
+		PROFILE_SCOPE("WorldStreamer");
+		worldStreamer->Update(*ecsManager, glm::vec2(camera.x + camera.w * 0.5, camera.y + camera.h * 0.5));
+	}
 
-	// Update all systems
-	ecsManager->GetSystem<MovementSystem>().Update(deltaTime);
-	ecsManager->GetSystem<AnimationSystem>().Update();
-	ecsManager->GetSystem<CollisionSystem>().Update(eventManager);
-	ecsManager->GetSystem<DamageSystem>().Update();
-	ecsManager->GetSystem<KeyboardControlSystem>().Update();
+	// Update all systems, scripts first so movement applies the velocities they set
+	{
+		PROFILE_SCOPE("ScriptSystem");
+		ecsManager->GetSystem<ScriptSystem>().Update(deltaTime);
+	}
+	{
+		PROFILE_SCOPE("MovementSystem");
+		ecsManager->GetSystem<MovementSystem>().Update(deltaTime);
+	}
+	{
+		PROFILE_SCOPE("AnimationSystem");
+		ecsManager->GetSystem<AnimationSystem>().Update(deltaTime);
+	}
+	{
+		PROFILE_SCOPE("CollisionSystem");
+		ecsManager->GetSystem<CollisionSystem>().Update(eventManager);
+	}
+	// Collisions found this frame reach their listeners here, after the collision pass
+	eventManager->DispatchQueuedEvents();
+	{
+		PROFILE_SCOPE("DamageSystem");
+		ecsManager->GetSystem<DamageSystem>().Update();
+	}
+	{
+		PROFILE_SCOPE("KeyboardControlSystem");
+		ecsManager->GetSystem<KeyboardControlSystem>().Update();
+	}
 
 
 	//////////////////////////////////////////////////////
@@ -234,31 +434,144 @@ void Game::Update() {
 
 
 void Game::Render() {
+	PROFILE_SCOPE("Render");
 	SDL_SetRenderDrawColor(renderer, 21, 21, 21, 255);
 	SDL_RenderClear(renderer);
 
+	// Upload textures streamed in by the loader threads, without going over the frame budget
+	{
+		PROFILE_SCOPE("AssetUploads");
+		assetManager->ProcessPendingUploads(renderer, ASSET_UPLOAD_BUDGET_MS);
+	}
+
 	// Update all systems that requires rendering
-	ecsManager->GetSystem<RenderSystem>().Update(renderer, assetManager);
+	// The tilemap is the background layer, sprites are drawn on top of it
+	{
+		PROFILE_SCOPE("TilemapSystem");
+		ecsManager->GetSystem<TilemapSystem>().Update(renderer, assetManager, camera);
+	}
+	{
+		PROFILE_SCOPE("RenderSystem");
+		ecsManager->GetSystem<RenderSystem>().Update(renderer, assetManager);
+	}
 	if (bDebugState) {
+		PROFILE_SCOPE("CollisionRenderSystem");
 		ecsManager->GetSystem<CollisionRenderSystem>().Update(renderer);
 	}
+	if (bProfilerOverlay) {
+		PROFILE_SCOPE("ProfilerOverlay");
+		RenderProfilerOverlay();
+	}
 
-	SDL_RenderPresent(renderer);
+	{
+		PROFILE_SCOPE("Present");
+		SDL_RenderPresent(renderer);
+	}
+}
+
+void Game::ToggleTrace() {
+	if (Profiler::bIsTracing()) {
+		Profiler::StopTrace();
+		LOG_INFO("Trace stopped");
+		return;
+	}
+	const std::string traceFilepath = "./trace-" + std::to_string(std::time(nullptr)) + ".json";
+	if (Profiler::StartTrace(traceFilepath)) {
+		LOG_INFO("Tracing to {}, open it in Perfetto (ui.perfetto.dev) or chrome://tracing", traceFilepath);
+	}
+	else {
+		LOG_ERROR("Can't write trace {}", traceFilepath);
+	}
+}
+
+void Game::RenderProfilerOverlay() {
+	ImGuiIO& io = ImGui::GetIO();
+	int outputWidth, outputHeight;
+	SDL_GetRendererOutputSize(renderer, &outputWidth, &outputHeight);
+	io.DisplaySize = ImVec2(static_cast<float>(outputWidth), static_cast<float>(outputHeight));
+	io.DeltaTime = deltaTime > 0.0 ? static_cast<float>(deltaTime) : 1.0f / FPS;
+
+	int mouseX, mouseY;
+	const Uint32 mouseButtons = SDL_GetMouseState(&mouseX, &mouseY);
+	io.MousePos = ImVec2(static_cast<float>(mouseX), static_cast<float>(mouseY));
+	io.MouseDown[0] = (mouseButtons & SDL_BUTTON(SDL_BUTTON_LEFT)) != 0;
+	io.MouseDown[1] = (mouseButtons & SDL_BUTTON(SDL_BUTTON_RIGHT)) != 0;
+
+	ImGui_ImplSDLRenderer2_NewFrame();
+	ImGui::NewFrame();
+	profilerOverlay.Draw();
+	ImGui::Render();
+	ImGui_ImplSDLRenderer2_RenderDrawData(ImGui::GetDrawData(), renderer);
 }
 
 
 void Game::Run() {
 	Setup();
 	while (bGameIsRunning) {
+		// The frame wait belongs to the frame it ends
+		Profiler::BeginFrame();
 		HandleInput();
+		HandleFrameTime();
+		if (recording) {
+			recording->deltaTimes.push_back(deltaTime);
+		}
 		Update();
 		Render();
+		Profiler::EndFrame();
+		tick++;
 	}
+
+	if (recording && InputRecordingFile::Save(recordingFilepath, *recording)) {
+		LOG_INFO("Recorded {} ticks and {} key events to {}", recording->GetTickCount(), recording->keyEvents.size(), recordingFilepath);
+	}
+}
+
+void Game::Replay(const InputRecording& inputRecording, ReplayReport& report) {
+	randomSeed = inputRecording.seed;
+	Setup(static_cast<int>(inputRecording.level));
+
+	size_t nextKeyEvent = 0;
+	const auto start = std::chrono::steady_clock::now();
+	for (tick = 0; tick < inputRecording.GetTickCount(); tick++) {
+		Profiler::BeginFrame();
+		// Through the SDL queue, HandleInput sees them as it did live
+		while (nextKeyEvent < inputRecording.keyEvents.size() && inputRecording.keyEvents[nextKeyEvent].tick == tick) {
+			const RecordedKeyEvent& keyEvent = inputRecording.keyEvents[nextKeyEvent++];
+			SDL_Event sdlEvent = {};
+			sdlEvent.key.type				= keyEvent.type;
+			sdlEvent.key.state				= keyEvent.type == SDL_KEYDOWN ? SDL_PRESSED : SDL_RELEASED;
+			sdlEvent.key.repeat				= keyEvent.bIsRepeat;
+			sdlEvent.key.keysym.sym			= keyEvent.symbol;
+			sdlEvent.key.keysym.scancode	= static_cast<SDL_Scancode>(keyEvent.scancode);
+			sdlEvent.key.keysym.mod			= keyEvent.modifiers;
+			SDL_PushEvent(&sdlEvent);
+		}
+		HandleInput();
+
+		// No frame wait, the recorded delta time stands in for it
+		deltaTime = inputRecording.deltaTimes[tick];
+		{
+			PROFILE_SCOPE("Script GC");
+			scriptEngine->StepGarbageCollector(0.0);
+		}
+		Update();
+		Profiler::EndFrame();
+		report.AddFrame();
+	}
+	const double simulationMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+	report.Finish(simulationMs, HashWorldState(*ecsManager));
 }
 
 void Game::Destroy() {
 	// Destroy in reverse order
+	ImGui_ImplSDLRenderer2_Shutdown();
+	ImGui::DestroyContext();
 	SDL_DestroyRenderer(renderer);
-	SDL_DestroyWindow(window);
+	if (window) {
+		SDL_DestroyWindow(window);
+	}
+	if (headlessSurface) {
+		SDL_FreeSurface(headlessSurface);
+	}
 	SDL_Quit();
 }
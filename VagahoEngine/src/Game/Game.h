@@ -5,35 +5,90 @@
 #include "../ECS/ECS.h"
 #include "../AssetManager/AssetManager.h"
 #include "../EventManager/EventManager.h"
+#include "../FileWatcher/FileWatcher.h"
+#include "../MapLoader/MapLoader.h"
+#include "../WorldStreamer/WorldStreamer.h"
+#include "../Scripting/ScriptEngine.h"
+#include "../Profiler/ProfilerOverlay.h"
+#include "../Replay/InputRecording.h"
+#include "../Replay/ReplayReport.h"
+
+#include <future>
+#include <optional>
 
 const int FPS = 60;
 const int FRAME_TIME_DURATION = 1000 / FPS;
+// Time per frame the main thread may spend uploading streamed textures
+const double ASSET_UPLOAD_BUDGET_MS = 2.0;
+// Textures nobody holds a handle to are evicted (least recently used first) above this
+const size_t TEXTURE_MEMORY_BUDGET = 256 * 1024 * 1024;
+// World pixels around the camera center that streamed regions are kept loaded for
+const double WORLD_VIEW_DISTANCE = 1600.0;
 
 class Game {
 private:
 	bool			bGameIsRunning;
 	bool			bDebugState;
+	bool			bProfilerOverlay;		// toggled with F1, F2 starts and stops a trace
+	bool			bIsHeadless;			// no window, the renderer draws into headlessSurface and nothing is rendered
 	int				ticksPrevFrame;
 	double			deltaTime;
+	uint32_t		tick;					// frames simulated since Setup
+	uint32_t		randomSeed;				// of the Lua math.random, set by Setup
 	SDL_Window*		window;
 	SDL_Renderer*	renderer;
+	SDL_Surface*	headlessSurface;
+	SDL_Rect		camera;			// visible area of the world, in world pixels
 
 	std::unique_ptr<ECSManager> ecsManager;
 	std::unique_ptr<AssetManager> assetManager;
 	std::unique_ptr<EventManager> eventManager;
+	std::unique_ptr<ScriptEngine> scriptEngine;
+
+	// Handles pinning the textures of the current level
+	std::vector<TextureHandle> levelTextures;
+
+	MapData mapData;
+	std::string levelMapFilepath;
+	std::optional<Entity> tilemapEntity;
+	// Streams the level map around the camera when the level ships as a region map (.vworld)
+	std::unique_ptr<WorldStreamer> worldStreamer;
+
+	// Optional hot reload of textures and the level map
+	std::unique_ptr<FileWatcher> fileWatcher;
+	std::future<MapData> pendingMapReload;
+
+	ProfilerOverlay profilerOverlay;
+
+	// Inputs of the session while recording, saved to recordingFilepath when Run returns
+	std::unique_ptr<InputRecording> recording;
+	std::string recordingFilepath;
 
-	std::vector<std::vector<int>> mapData;
-	int mapWidth;
-	int mapHeight;
-	
+	// Create the tilemap entity from mapData, or update its tiles if the map size didn't change
+	void BuildTileLayer();
+	void ProcessHotReload();
+	// Start streaming the level from a region map, false if there is none
+	bool StartWorldStreaming(const std::string& filename, const std::vector<int>& solidTileIds);
+	// ImGui has no platform backend here, the overlay gets the display size and the mouse from SDL directly
+	void RenderProfilerOverlay();
+	// Chrome trace of the following frames into ./trace-<time>.json, until toggled again
+	void ToggleTrace();
 
 public:
 	Game();
 	~Game();
-	void Initialize();
-	void Setup();
+	// Headless: textures load into a software renderer, for replays
+	void Initialize(bool bHeadless = false);
+	void Setup(int level = 1);
+	void SetRandomSeed(uint32_t seed) { randomSeed = seed; }
+	// Record the inputs of the following Run into filepath (.vrec), see InputRecording.h
+	void StartRecording(const std::string& filepath);
+	// Runs the recorded session again headless, as fast as it goes, with the recorded delta times
+	void Replay(const InputRecording& inputRecording, ReplayReport& report);
 	void LoadLevel(int level);
 	void LoadMap(const std::string& filename);
+	// Watch ./assets and reload changed textures and the level map while the game runs
+	void EnableHotReload();
 	void HandleFrameTime();
 	void HandleInput();
 	void Update();
@@ -0,0 +1,168 @@
+#include "LevelLoader.h"
+
+#include "../Logger/Logger.h"
+#include "../Scripting/ScriptEngine.h"
+
+#include <sol/sol.hpp>
+
+#include <chrono>
+
+namespace {
+
+	glm::vec2 ReadVec2(const sol::table& table, const char* key, glm::vec2 defaultValue) {
+		sol::optional<sol::table> vector = table[key];
+		if (!vector) {
+			return defaultValue;
+		}
+		return glm::vec2(vector->get_or("x", defaultValue.x), vector->get_or("y", defaultValue.y));
+	}
+
+	void ReadEntity(const sol::table& components, LevelEntity& entity) {
+		if (sol::optional<sol::table> transform = components["transform"]) {
+			entity.componentMask |= LEVEL_TRANSFORM;
+			entity.transform = TransformComponent(
+				ReadVec2(*transform, "position", glm::vec2(0.0)),
+				ReadVec2(*transform, "scale", glm::vec2(1.0)),
+				transform->get_or("rotation", 0.0)
+			);
+		}
+		if (sol::optional<sol::table> rigidbody = components["rigidbody"]) {
+			entity.componentMask |= LEVEL_RIGIDBODY;
+			entity.rigidbody = RigidbodyComponent(ReadVec2(*rigidbody, "velocity", glm::vec2(0.0)));
+		}
+		if (sol::optional<sol::table> sprite = components["sprite"]) {
+			entity.componentMask |= LEVEL_SPRITE;
+			entity.sprite = SpriteComponent(
+				sprite->get_or<std::string>("texture", ""),
+				sprite->get_or("width", 0),
+				sprite->get_or("height", 0),
+				sprite->get_or("z_index", 0),
+				sprite->get_or("src_x", 0),
+				sprite->get_or("src_y", 0)
+			);
+		}
+		if (sol::optional<sol::table> animation = components["animation"]) {
+			entity.componentMask |= LEVEL_ANIMATION;
+			entity.animation = AnimationComponent(
+				animation->get_or("frames", 1),
+				animation->get_or("frame_rate", 1),
+				animation->get_or("looping", true)
+			);
+		}
+		if (sol::optional<sol::table> boxCollider = components["box_collider"]) {
+			entity.componentMask |= LEVEL_BOX_COLLIDER;
+			entity.boxCollider = BoxColliderComponent(
+				boxCollider->get_or("width", 0),
+				boxCollider->get_or("height", 0),
+				ReadVec2(*boxCollider, "offset", glm::vec2(0.0))
+			);
+		}
+		if (sol::optional<sol::table> script = components["script"]) {
+			entity.componentMask |= LEVEL_SCRIPT;
+			entity.script = ScriptComponent(script->get_or<std::string>("behaviour", ""));
+		}
+	}
+
+	// Copies one component of every entity in the group into a contiguous batch and adds it in one go
+	template <typename TComponent>
+	void AddComponentBatch(ECSManager& ecsManager, const std::vector<Entity>& entities, const std::vector<const LevelEntity*>& group,
+		TComponent LevelEntity::* member, std::vector<TComponent>& batch) {
+		batch.clear();
+		for (const LevelEntity* levelEntity : group) {
+			batch.push_back(levelEntity->*member);
+		}
+		ecsManager.AddComponents<TComponent>(entities.data(), batch.data(), batch.size());
+	}
+}
+
+bool LevelLoader::Load(ScriptEngine& scriptEngine, const std::string& filepath, glm::vec2 windowSize, LevelDescription& level) {
+	sol::state& lua = scriptEngine.GetState();
+	lua["Window"] = lua.create_table_with("width", windowSize.x, "height", windowSize.y);
+	lua["Level"] = sol::lua_nil;
+	if (!scriptEngine.RunFile(filepath)) {
+		return false;
+	}
+	sol::optional<sol::table> levelTable = lua["Level"];
+	if (!levelTable) {
+		LOG_AT(ERROR, Scripting, "Level {} doesn't set a Level table", filepath);
+		return false;
+	}
+
+	level = LevelDescription();
+	if (sol::optional<sol::table> assets = (*levelTable)["assets"]) {
+		for (size_t i = 1; i <= assets->size(); i++) {
+			sol::table asset = (*assets)[i];
+			if (asset.get_or<std::string>("type", "texture") == "texture") {
+				level.textures.push_back({ asset.get_or<std::string>("id", ""), asset.get_or<std::string>("file", "") });
+			}
+		}
+	}
+	if (sol::optional<sol::table> scripts = (*levelTable)["scripts"]) {
+		for (size_t i = 1; i <= scripts->size(); i++) {
+			level.scripts.push_back((*scripts)[i]);
+		}
+	}
+	if (sol::optional<sol::table> tilemap = (*levelTable)["tilemap"]) {
+		level.mapFilepath = tilemap->get_or<std::string>("map", "");
+		level.worldFilepath = tilemap->get_or<std::string>("world", "");
+		if (sol::optional<sol::table> solid = (*tilemap)["solid"]) {
+			for (size_t i = 1; i <= solid->size(); i++) {
+				level.solidTileIds.push_back(solid->get<int>(i));
+			}
+		}
+	}
+	if (sol::optional<sol::table> entities = (*levelTable)["entities"]) {
+		const size_t count = entities->size();
+		level.entities.resize(count);
+		for (size_t i = 1; i <= count; i++) {
+			sol::optional<sol::table> components = (*entities)[i]["components"];
+			if (components) {
+				ReadEntity(*components, level.entities[i - 1]);
+			}
+		}
+	}
+	// The level table isn't needed anymore, let the GC have it
+	lua["Level"] = sol::lua_nil;
+
+	for (const std::string& script : level.scripts) {
+		scriptEngine.RunFile(script);
+	}
+
+	LOG_AT(INFO, World, "Level {}: {} textures, {} entities", filepath, level.textures.size(), level.entities.size());
+	return true;
+}
+
+size_t LevelLoader::CreateEntities(ECSManager& ecsManager, const LevelDescription& level) {
+	const auto startTime = std::chrono::steady_clock::now();
+
+	// Group by signature, entities keep their file order inside a group
+	std::vector<std::vector<const LevelEntity*>> groups(LEVEL_COMPONENT_MASK_COUNT);
+	for (const LevelEntity& levelEntity : level.entities) {
+		groups[levelEntity.componentMask].push_back(&levelEntity);
+	}
+
+	std::vector<TransformComponent> transforms;
+	std::vector<RigidbodyComponent> rigidbodies;
+	std::vector<SpriteComponent> sprites;
+	std::vector<AnimationComponent> animations;
+	std::vector<BoxColliderComponent> boxColliders;
+	std::vector<ScriptComponent> scripts;
+
+	for (size_t mask = 0; mask < groups.size(); mask++) {
+		const auto& group = groups[mask];
+		if (group.empty()) {
+			continue;
+		}
+		const std::vector<Entity> entities = ecsManager.CreateEntities(group.size());
+		if (mask & LEVEL_TRANSFORM)			AddComponentBatch(ecsManager, entities, group, &LevelEntity::transform, transforms);
+		if (mask & LEVEL_RIGIDBODY)			AddComponentBatch(ecsManager, entities, group, &LevelEntity::rigidbody, rigidbodies);
+		if (mask & LEVEL_SPRITE)			AddComponentBatch(ecsManager, entities, group, &LevelEntity::sprite, sprites);
+		if (mask & LEVEL_ANIMATION)			AddComponentBatch(ecsManager, entities, group, &LevelEntity::animation, animations);
+		if (mask & LEVEL_BOX_COLLIDER)		AddComponentBatch(ecsManager, entities, group, &LevelEntity::boxCollider, boxColliders);
+		if (mask & LEVEL_SCRIPT)			AddComponentBatch(ecsManager, entities, group, &LevelEntity::script, scripts);
+	}
+
+	const double elapsedMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startTime).count();
+	LOG_AT(INFO, ECS, "Created {} level entities in {:.2f} ms", level.entities.size(), elapsedMs);
+	return level.entities.size();
+}
@@ -0,0 +1,88 @@
+#pragma once
+
+#include "../ECS/ECS.h"
+#include "../Components/TransformComponent.h"
+#include "../Components/RigidbodyComponent.h"
+#include "../Components/SpriteComponent.h"
+#include "../Components/AnimationComponent.h"
+#include "../Components/BoxColliderComponent.h"
+#include "../Components/ScriptComponent.h"
+
+#include <glm/glm.hpp>
+
+#include <string>
+#include <vector>
+#include <cstdint>
+
+class ScriptEngine;
+
+// Bit per component a level entity can have, the set bits are its signature while loading
+enum LevelComponent : uint8_t {
+	LEVEL_TRANSFORM		= 1 << 0,
+	LEVEL_RIGIDBODY		= 1 << 1,
+	LEVEL_SPRITE		= 1 << 2,
+	LEVEL_ANIMATION		= 1 << 3,
+	LEVEL_BOX_COLLIDER	= 1 << 4,
+	LEVEL_SCRIPT		= 1 << 5,
+	LEVEL_COMPONENT_MASK_COUNT = 1 << 6
+};
+
+// An entity read from the level file, only the components in componentMask are used
+struct LevelEntity {
+	uint8_t componentMask = 0;
+	TransformComponent transform;
+	RigidbodyComponent rigidbody;
+	SpriteComponent sprite;
+	AnimationComponent animation;
+	BoxColliderComponent boxCollider;
+	ScriptComponent script;
+};
+
+struct LevelTexture {
+	std::string assetId;
+	std::string filepath;
+};
+
+struct LevelDescription {
+	std::vector<LevelTexture> textures;
+	std::vector<std::string> scripts;	// behaviour scripts, already run by LevelLoader::Load
+	std::string mapFilepath;			// text or binary map
+	std::string worldFilepath;			// region map, streamed instead of mapFilepath when it exists
+	std::vector<int> solidTileIds;		// tiles of the streamed region map that get colliders
+	std::vector<LevelEntity> entities;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+/// LEVEL LOADER
+////////////////////////////////////////////////////////////////////////////////
+/// Levels are Lua scripts that set a global Level table:
+///
+///   Level = {
+///       assets = { { type = "texture", id = "tank-image", file = "./assets/images/tank.png" } },
+///       scripts = { "./assets/scripts/Behaviours.lua" },
+///       tilemap = { map = "./assets/tilemaps/jungle.map", world = "./assets/tilemaps/jungle.vworld", solid = { 12, 13 } },
+///       entities = {
+///           { components = {
+///               transform = { position = { x = 20, y = 20 }, scale = { x = 2, y = 2 }, rotation = 0 },
+///               rigidbody = { velocity = { x = 20, y = 0 } },
+///               sprite = { texture = "tank-image", width = 32, height = 32, z_index = 1 },
+///               animation = { frames = 2, frame_rate = 15, looping = true },
+///               box_collider = { width = 32, height = 32, offset = { x = 0, y = 0 } },
+///               script = { behaviour = "hover" }
+///           } }
+///       }
+///   }
+///
+/// Being Lua, a level can build its entity list with loops. Window = { width, height }
+/// is set before the level runs. Missing fields take the component defaults.
+///
+/// CreateEntities groups the entities by signature and adds each component
+/// type to a whole group at once (ECSManager::CreateEntities / AddComponents),
+/// instead of one entity and one component at a time.
+////////////////////////////////////////////////////////////////////////////////
+class LevelLoader {
+public:
+	static bool Load(ScriptEngine& scriptEngine, const std::string& filepath, glm::vec2 windowSize, LevelDescription& level);
+	// Returns the number of entities created
+	static size_t CreateEntities(ECSManager& ecsManager, const LevelDescription& level);
+};
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+////////////////////////////////////////////////////////////////////////////////
+/// BINARY LOG (.vlog)
+////////////////////////////////////////////////////////////////////////////////
+/// Written by BinaryLogSink, turned back into text or JSON by tools/LogDecoder.
+///
+/// Layout (little-endian):
+///   BinaryLogHeader
+///   chunks, each starting with a BinaryLogChunk byte:
+///     CallSite:	varint id, uint8 level, uint8 category, varint line,
+///				varint length + file name, varint length + format string
+///     Record:		varint call site id, zigzag varint timestamp delta to the previous record
+///				(the header's start timestamp for the first), varint (length << 1 | truncated)
+///				+ encoded arguments
+/// A call site is written once, before its first record, so a record only costs
+/// its arguments and a few bytes. Arguments are encoded as in LogArgWriter.
+////////////////////////////////////////////////////////////////////////////////
+const char		BINARY_LOG_MAGIC[4]		= { 'V', 'L', 'O', 'G' };
+const uint32_t	BINARY_LOG_VERSION		= 1;
+
+struct BinaryLogHeader {
+	char		magic[4];
+	uint32_t	version;
+	int64_t		clockNumerator;		// timestamp tick = numerator / denominator seconds (system_clock period)
+	int64_t		clockDenominator;
+	int64_t		startTimestamp;		// system_clock ticks since the epoch when the file was opened
+};
+
+static_assert(sizeof(BinaryLogHeader) == 32, "BinaryLogHeader layout is part of the file format");
+
+enum class BinaryLogChunk : uint8_t {
+	CallSite	= 1,
+	Record		= 2
+};
+
+inline void WriteVarint(std::vector<uint8_t>& output, uint64_t value) {
+	while (value >= 0x80) {
+		output.push_back(static_cast<uint8_t>(value | 0x80));
+		value >>= 7;
+	}
+	output.push_back(static_cast<uint8_t>(value));
+}
+
+inline bool ReadVarint(const uint8_t*& cursor, const uint8_t* end, uint64_t& value) {
+	value = 0;
+	for (int shift = 0; shift < 64 && cursor < end; shift += 7) {
+		const uint8_t byte = *cursor++;
+		value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+		if ((byte & 0x80) == 0) {
+			return true;
+		}
+	}
+	return false;
+}
+
+// Small negative deltas stay small: 0, -1, 1, -2 ... map to 0, 1, 2, 3 ...
+inline uint64_t ZigZagEncode(int64_t value) {
+	return (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63);
+}
+
+inline int64_t ZigZagDecode(uint64_t value) {
+	return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+}
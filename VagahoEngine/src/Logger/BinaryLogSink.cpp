@@ -0,0 +1,84 @@
+#include "BinaryLogSink.h"
+
+#include <chrono>
+#include <cstring>
+
+BinaryLogSink::~BinaryLogSink() {
+	Close();
+}
+
+bool BinaryLogSink::Open(const std::string& filepath) {
+	Close();
+	file = std::fopen(filepath.c_str(), "wb");
+	if (!file) {
+		return false;
+	}
+
+	BinaryLogHeader header;
+	std::memcpy(header.magic, BINARY_LOG_MAGIC, sizeof(BINARY_LOG_MAGIC));
+	header.version			= BINARY_LOG_VERSION;
+	header.clockNumerator	= std::chrono::system_clock::period::num;
+	header.clockDenominator	= std::chrono::system_clock::period::den;
+	header.startTimestamp	= std::chrono::system_clock::now().time_since_epoch().count();
+	std::fwrite(&header, sizeof(header), 1, file);
+
+	// A new file starts without call sites
+	callSiteIds.clear();
+	previousTimestamp = header.startTimestamp;
+	return true;
+}
+
+void BinaryLogSink::Close() {
+	if (file) {
+		Flush();
+		std::fclose(file);
+		file = nullptr;
+	}
+	buffer.clear();
+}
+
+uint32_t BinaryLogSink::GetCallSiteId(const LogRecord& record) {
+	const CallSite callSite = { record.format, record.file, record.line };
+	auto existing = callSiteIds.find(callSite);
+	if (existing != callSiteIds.end()) {
+		return existing->second;
+	}
+
+	const uint32_t id = static_cast<uint32_t>(callSiteIds.size());
+	callSiteIds.emplace(callSite, id);
+
+	const size_t fileLength = std::strlen(record.file);
+	const size_t formatLength = std::strlen(record.format);
+	buffer.push_back(static_cast<uint8_t>(BinaryLogChunk::CallSite));
+	WriteVarint(buffer, id);
+	buffer.push_back(static_cast<uint8_t>(record.type));
+	buffer.push_back(static_cast<uint8_t>(record.category));
+	WriteVarint(buffer, record.line);
+	WriteVarint(buffer, fileLength);
+	buffer.insert(buffer.end(), record.file, record.file + fileLength);
+	WriteVarint(buffer, formatLength);
+	buffer.insert(buffer.end(), record.format, record.format + formatLength);
+	return id;
+}
+
+void BinaryLogSink::Write(const LogRecord& record) {
+	if (!file) {
+		return;
+	}
+	const uint32_t callSiteId = GetCallSiteId(record);
+	buffer.push_back(static_cast<uint8_t>(BinaryLogChunk::Record));
+	WriteVarint(buffer, callSiteId);
+	// Records from different threads can arrive slightly out of order, hence the signed delta
+	WriteVarint(buffer, ZigZagEncode(record.timestamp - previousTimestamp));
+	previousTimestamp = record.timestamp;
+	WriteVarint(buffer, (static_cast<uint64_t>(record.payloadSize) << 1) | (record.bTruncated ? 1 : 0));
+	buffer.insert(buffer.end(), record.payload, record.payload + record.payloadSize);
+}
+
+void BinaryLogSink::Flush() {
+	if (file && !buffer.empty()) {
+		std::fwrite(buffer.data(), 1, buffer.size(), file);
+		std::fflush(file);
+	}
+	buffer.clear();
+}
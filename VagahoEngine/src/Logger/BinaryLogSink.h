@@ -0,0 +1,60 @@
+#pragma once
+
+#include "Logger.h"
+#include "BinaryLogFormat.h"
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <cstdio>
+
+////////////////////////////////////////////////////////////////////////////////
+/// BINARY LOG SINK
+////////////////////////////////////////////////////////////////////////////////
+/// Writes log records as they come out of the ring buffer, without formatting
+/// them: call site id, timestamp delta and the already encoded arguments.
+/// Used by the log writer thread only (see BinaryLogFormat.h for the layout).
+////////////////////////////////////////////////////////////////////////////////
+class BinaryLogSink {
+private:
+	struct CallSite {
+		const char* format;
+		const char* file;
+		uint32_t line;
+
+		bool operator ==(const CallSite& other) const {
+			return format == other.format && file == other.file && line == other.line;
+		}
+	};
+
+	struct CallSiteHash {
+		size_t operator()(const CallSite& callSite) const {
+			size_t hash = std::hash<const void*>()(callSite.format);
+			hash ^= std::hash<const void*>()(callSite.file) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+			hash ^= std::hash<uint32_t>()(callSite.line) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+			return hash;
+		}
+	};
+
+	std::FILE* file = nullptr;
+	std::vector<uint8_t> buffer;
+	std::unordered_map<CallSite, uint32_t, CallSiteHash> callSiteIds;
+	int64_t previousTimestamp = 0;
+
+	uint32_t GetCallSiteId(const LogRecord& record);
+
+public:
+	BinaryLogSink() = default;
+	~BinaryLogSink();
+
+	BinaryLogSink(const BinaryLogSink&) = delete;
+	BinaryLogSink& operator =(const BinaryLogSink&) = delete;
+
+	bool Open(const std::string& filepath);
+	void Close();
+	bool bIsOpen() const { return file != nullptr; }
+
+	// Encodes into memory, Flush() writes it out
+	void Write(const LogRecord& record);
+	void Flush();
+};
@@ -0,0 +1,139 @@
+#include "LogFormat.h"
+
+#include <cstdio>
+#include <cinttypes>
+#include <algorithm>
+
+namespace {
+
+	struct FormatSpec {
+		int precision = -1;
+		char type = 0;
+	};
+
+	// Parses the part between ':' and '}' of a placeholder
+	FormatSpec ParseSpec(const char* begin, const char* end) {
+		FormatSpec spec;
+		for (const char* c = begin; c < end; c++) {
+			if (*c == '.') {
+				spec.precision = 0;
+				while (c + 1 < end && *(c + 1) >= '0' && *(c + 1) <= '9') {
+					spec.precision = spec.precision * 10 + (*++c - '0');
+				}
+			}
+			else {
+				spec.type = *c;
+			}
+		}
+		return spec;
+	}
+
+	// Appends one argument, returns false when the arguments ran out or are malformed
+	bool AppendArg(const uint8_t*& cursor, const uint8_t* end, const FormatSpec& spec, std::string& output) {
+		if (cursor >= end) {
+			return false;
+		}
+		const LogArgType type = static_cast<LogArgType>(*cursor++);
+		char text[64];
+		int length = 0;
+
+		auto readValue = [&](auto& value) {
+			if (static_cast<size_t>(end - cursor) < sizeof(value)) {
+				return false;
+			}
+			std::memcpy(&value, cursor, sizeof(value));
+			cursor += sizeof(value);
+			return true;
+		};
+
+		switch (type) {
+			case LogArgType::Int: {
+				int64_t value;
+				if (!readValue(value)) return false;
+				if (spec.type == 'x' || spec.type == 'X') {
+					length = std::snprintf(text, sizeof(text), spec.type == 'x' ? "%" PRIx64 : "%" PRIX64, static_cast<uint64_t>(value));
+				}
+				else {
+					length = std::snprintf(text, sizeof(text), "%" PRId64, value);
+				}
+				break;
+			}
+			case LogArgType::UInt: {
+				uint64_t value;
+				if (!readValue(value)) return false;
+				const char* printfFormat = spec.type == 'x' ? "%" PRIx64 : spec.type == 'X' ? "%" PRIX64 : "%" PRIu64;
+				length = std::snprintf(text, sizeof(text), printfFormat, value);
+				break;
+			}
+			case LogArgType::Double: {
+				double value;
+				if (!readValue(value)) return false;
+				const char conversion = (spec.type == 'e' || spec.type == 'f' || spec.type == 'g') ? spec.type : (spec.precision >= 0 ? 'f' : 'g');
+				char printfFormat[8] = { '%', '.', '*', conversion, 0 };
+				length = std::snprintf(text, sizeof(text), printfFormat, spec.precision >= 0 ? spec.precision : 6, value);
+				break;
+			}
+			case LogArgType::Bool: {
+				uint8_t value;
+				if (!readValue(value)) return false;
+				output += value ? "true" : "false";
+				return true;
+			}
+			case LogArgType::Char: {
+				char value;
+				if (!readValue(value)) return false;
+				output += value;
+				return true;
+			}
+			case LogArgType::String: {
+				uint16_t stringLength;
+				if (!readValue(stringLength) || static_cast<size_t>(end - cursor) < stringLength) return false;
+				output.append(reinterpret_cast<const char*>(cursor), stringLength);
+				cursor += stringLength;
+				return true;
+			}
+			case LogArgType::Pointer: {
+				uint64_t value;
+				if (!readValue(value)) return false;
+				length = std::snprintf(text, sizeof(text), "0x%" PRIx64, value);
+				break;
+			}
+			default:
+				return false;
+		}
+		output.append(text, static_cast<size_t>(std::max(length, 0)));
+		return true;
+	}
+}
+
+void FormatLogMessage(const char* format, const uint8_t* args, size_t size, std::string& output) {
+	const uint8_t* cursor = args;
+	const uint8_t* end = args + size;
+
+	for (const char* c = format; *c; c++) {
+		if (*c == '{' && *(c + 1) == '{') {
+			output += '{';
+			c++;
+		}
+		else if (*c == '}' && *(c + 1) == '}') {
+			output += '}';
+			c++;
+		}
+		else if (*c == '{') {
+			const char* close = std::strchr(c, '}');
+			if (!close) {
+				output += c;
+				return;
+			}
+			const char* colon = static_cast<const char*>(std::memchr(c, ':', close - c));
+			const FormatSpec spec = colon ? ParseSpec(colon + 1, close) : FormatSpec();
+			if (!AppendArg(cursor, end, spec, output)) {
+				output += "{?}";
+			}
+			c = close;
+		}
+		else {
+			output += *c;
+		}
+	}
+}
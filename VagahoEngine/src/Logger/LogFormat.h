@@ -0,0 +1,106 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <algorithm>
+
+////////////////////////////////////////////////////////////////////////////////
+/// LOG ARGUMENTS
+////////////////////////////////////////////////////////////////////////////////
+/// Log calls don't format on the calling thread. The arguments are copied into
+/// the record as a type tag followed by the raw value, and the writer thread
+/// substitutes them for the {} placeholders of the format string later.
+/// Placeholders take an optional std::format-like spec: {:x} {:X} {:.3f} {:e}.
+/// {{ and }} print a brace.
+////////////////////////////////////////////////////////////////////////////////
+enum class LogArgType : uint8_t {
+	Int		= 0,	// int64
+	UInt	= 1,	// uint64
+	Double	= 2,
+	Bool	= 3,	// uint8
+	Char	= 4,
+	String	= 5,	// uint16 length + bytes, no terminator
+	Pointer	= 6		// uint64
+};
+
+class LogArgWriter {
+private:
+	uint8_t* cursor;
+	uint8_t* end;
+	bool bTruncated = false;
+
+	template <typename T>
+	void WriteValue(LogArgType type, const T& value) {
+		if (bTruncated || static_cast<size_t>(end - cursor) < 1 + sizeof(T)) {
+			bTruncated = true;
+			return;
+		}
+		*cursor++ = static_cast<uint8_t>(type);
+		std::memcpy(cursor, &value, sizeof(T));
+		cursor += sizeof(T);
+	}
+
+	void WriteString(std::string_view text) {
+		const size_t available = static_cast<size_t>(end - cursor);
+		if (bTruncated || available < 1 + sizeof(uint16_t)) {
+			bTruncated = true;
+			return;
+		}
+		// Long strings are cut to what is left, the remaining arguments are dropped
+		size_t length = std::min<size_t>(std::min<size_t>(text.size(), UINT16_MAX), available - 1 - sizeof(uint16_t));
+		bTruncated = length < text.size();
+		const uint16_t storedLength = static_cast<uint16_t>(length);
+		*cursor++ = static_cast<uint8_t>(LogArgType::String);
+		std::memcpy(cursor, &storedLength, sizeof(uint16_t));
+		cursor += sizeof(uint16_t);
+		std::memcpy(cursor, text.data(), length);
+		cursor += length;
+	}
+
+	template <typename>
+	static constexpr bool bAlwaysFalse = false;
+
+public:
+	LogArgWriter(uint8_t* buffer, size_t capacity) : cursor(buffer), end(buffer + capacity) {}
+
+	template <typename T>
+	void Write(const T& value) {
+		if constexpr (std::is_same_v<T, bool>) {
+			WriteValue(LogArgType::Bool, static_cast<uint8_t>(value));
+		}
+		else if constexpr (std::is_same_v<T, char>) {
+			WriteValue(LogArgType::Char, value);
+		}
+		else if constexpr (std::is_enum_v<T>) {
+			WriteValue(LogArgType::Int, static_cast<int64_t>(value));
+		}
+		else if constexpr (std::is_integral_v<T> && std::is_signed_v<T>) {
+			WriteValue(LogArgType::Int, static_cast<int64_t>(value));
+		}
+		else if constexpr (std::is_integral_v<T>) {
+			WriteValue(LogArgType::UInt, static_cast<uint64_t>(value));
+		}
+		else if constexpr (std::is_floating_point_v<T>) {
+			WriteValue(LogArgType::Double, static_cast<double>(value));
+		}
+		else if constexpr (std::is_convertible_v<const T&, std::string_view>) {
+			WriteString(std::string_view(value));
+		}
+		else if constexpr (std::is_pointer_v<T>) {
+			WriteValue(LogArgType::Pointer, static_cast<uint64_t>(reinterpret_cast<uintptr_t>(value)));
+		}
+		else {
+			static_assert(bAlwaysFalse<T>, "Type can't be logged, convert it to a string or number first");
+		}
+	}
+
+	size_t GetSize(const uint8_t* buffer) const { return static_cast<size_t>(cursor - buffer); }
+	bool bIsTruncated() const { return bTruncated; }
+};
+
+// Substitute the encoded arguments for the placeholders of format and append the result to output
+void FormatLogMessage(const char* format, const uint8_t* args, size_t size, std::string& output);
@@ -0,0 +1,118 @@
+#include "LogHistory.h"
+
+#include <algorithm>
+
+LogHistory::LogHistory(size_t capacity) : capacity(std::max<size_t>(capacity, 1)) {
+}
+
+uint16_t LogHistory::GetFileId(const char* filepath) {
+	auto idByPointer = fileIdsByPointer.find(filepath);
+	if (idByPointer != fileIdsByPointer.end()) {
+		return idByPointer->second;
+	}
+
+	// The same file can come with different pointers (one literal per translation unit)
+	const char* filename = filepath;
+	for (const char* c = filepath; *c; c++) {
+		if (*c == '/' || *c == '\\') {
+			filename = c + 1;
+		}
+	}
+	auto idByName = fileIdsByName.find(filename);
+	uint16_t fileId;
+	if (idByName != fileIdsByName.end()) {
+		fileId = idByName->second;
+	}
+	else {
+		fileId = static_cast<uint16_t>(fileNames.size());
+		fileNames.emplace_back(filename);
+		fileIdsByName.emplace(filename, fileId);
+	}
+	fileIdsByPointer.emplace(filepath, fileId);
+	return fileId;
+}
+
+template <typename TVisit>
+void LogHistory::VisitInOrder(TVisit&& visit) const {
+	// Before the ring wraps the oldest entry is at 0, afterwards it is the next one to be overwritten
+	const size_t first = entries.size() < capacity ? 0 : nextSlot;
+	for (size_t i = 0; i < entries.size(); i++) {
+		visit(entries[(first + i) % entries.size()]);
+	}
+}
+
+void LogHistory::Add(LogType type, LogCategory category, int64_t timestamp, const char* filepath, uint32_t line, const std::string& message) {
+	std::lock_guard<std::mutex> lock(mutex);
+	if (entries.size() < capacity) {
+		entries.emplace_back();
+	}
+	LogEntry& entry = entries[nextSlot];
+	nextSlot = (nextSlot + 1) % capacity;
+
+	entry.sequence	= nextSequence++;
+	entry.timestamp	= timestamp;
+	entry.type		= type;
+	entry.category	= category;
+	entry.fileId	= GetFileId(filepath);
+	entry.line		= line;
+	entry.message.assign(message);		// reuses the slot's buffer
+}
+
+void LogHistory::SetCapacity(size_t newCapacity) {
+	std::lock_guard<std::mutex> lock(mutex);
+	newCapacity = std::max<size_t>(newCapacity, 1);
+
+	// Move the newest entries that fit over, oldest first
+	std::vector<LogEntry> ordered;
+	ordered.reserve(std::min(entries.size(), newCapacity));
+	const size_t first = entries.size() < capacity ? 0 : nextSlot;
+	const size_t skipped = entries.size() > newCapacity ? entries.size() - newCapacity : 0;
+	for (size_t i = skipped; i < entries.size(); i++) {
+		ordered.push_back(std::move(entries[(first + i) % entries.size()]));
+	}
+
+	entries = std::move(ordered);
+	entries.shrink_to_fit();
+	capacity = newCapacity;
+	nextSlot = entries.size() % capacity;
+}
+
+void LogHistory::Clear() {
+	std::lock_guard<std::mutex> lock(mutex);
+	entries.clear();
+	nextSlot = 0;
+}
+
+std::vector<LogEntry> LogHistory::Query(const LogQuery& query) const {
+	std::lock_guard<std::mutex> lock(mutex);
+	std::vector<LogEntry> results;
+	VisitInOrder([&](const LogEntry& entry) {
+		if (entry.sequence <= query.afterSequence ||
+			entry.type < query.minLevel ||
+			(query.categoryMask & (1u << static_cast<uint32_t>(entry.category))) == 0 ||
+			(!query.text.empty() && entry.message.find(query.text) == std::string::npos)) {
+			return;
+		}
+		results.push_back(entry);
+	});
+
+	if (query.maxResults != 0 && results.size() > query.maxResults) {
+		results.erase(results.begin(), results.end() - query.maxResults);
+	}
+	return results;
+}
+
+std::string LogHistory::GetFileName(uint16_t fileId) const {
+	std::lock_guard<std::mutex> lock(mutex);
+	return fileId < fileNames.size() ? fileNames[fileId] : std::string();
+}
+
+size_t LogHistory::GetSize() const {
+	std::lock_guard<std::mutex> lock(mutex);
+	return entries.size();
+}
+
+size_t LogHistory::GetCapacity() const {
+	std::lock_guard<std::mutex> lock(mutex);
+	return capacity;
+}
@@ -0,0 +1,68 @@
+#pragma once
+
+#include "LogLevels.h"
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <mutex>
+#include <cstdint>
+#include <cstddef>
+
+// One written log message, without colors or decoration
+struct LogEntry {
+	uint64_t sequence;			// increases by one per message, survives the ring wrapping around
+	int64_t timestamp;			// system_clock ticks
+	LogType type;
+	LogCategory category;
+	uint16_t fileId;			// see LogHistory::GetFileName
+	uint32_t line;
+	std::string message;
+};
+
+struct LogQuery {
+	LogType minLevel = VERBOSE;
+	uint32_t categoryMask = UINT32_MAX;	// bit (1 << category) per category to keep
+	std::string text;					// the message has to contain it, empty matches everything
+	uint64_t afterSequence = 0;			// only newer entries, for a console polling for new lines
+	size_t maxResults = 0;				// newest matches only, 0 = all
+};
+
+////////////////////////////////////////////////////////////////////////////////
+/// LOG HISTORY
+////////////////////////////////////////////////////////////////////////////////
+/// The last `capacity` log messages, oldest overwritten first. Slots are reused
+/// in place, so once the ring is full memory stays flat no matter how long the
+/// game runs. Written by the log writer thread, queried from any thread.
+////////////////////////////////////////////////////////////////////////////////
+class LogHistory {
+private:
+	mutable std::mutex mutex;
+	std::vector<LogEntry> entries;		// grows up to capacity, then wraps
+	size_t capacity;
+	size_t nextSlot = 0;
+	uint64_t nextSequence = 1;
+
+	// File names are stored once, entries only keep an index
+	std::vector<std::string> fileNames;
+	std::unordered_map<const char*, uint16_t> fileIdsByPointer;	// __FILE__ literals, the fast path
+	std::unordered_map<std::string, uint16_t> fileIdsByName;
+
+	uint16_t GetFileId(const char* filepath);
+	// Entries in order, oldest first
+	template <typename TVisit>
+	void VisitInOrder(TVisit&& visit) const;
+
+public:
+	explicit LogHistory(size_t capacity);
+
+	void Add(LogType type, LogCategory category, int64_t timestamp, const char* filepath, uint32_t line, const std::string& message);
+	// Keeps the newest entries that still fit
+	void SetCapacity(size_t capacity);
+	void Clear();
+
+	std::vector<LogEntry> Query(const LogQuery& query) const;
+	std::string GetFileName(uint16_t fileId) const;
+	size_t GetSize() const;
+	size_t GetCapacity() const;
+};
@@ -0,0 +1,22 @@
+#pragma once
+
+#include <cstdint>
+
+enum LogType {
+	VERBOSE,
+	INFO,
+	WARNING,
+	ERROR
+};
+
+// Runtime filters are set per category, see Logger::SetCategoryLevel
+enum class LogCategory : uint8_t {
+	General,
+	ECS,
+	Assets,
+	Events,
+	Collision,
+	World,
+	Scripting,
+	Count
+};
@@ -1,70 +1,415 @@
 #include "Logger.h"
+#include "RotatingLogFile.h"
+#include "BinaryLogSink.h"
+#include "../Utils/MPSCRingBuffer.h"
+#include "../Profiler/Profiler.h"
 
-#include <iostream>
 #include <chrono>	// current time
-#include <iomanip>	// time formatting
-#include <ctime>	// std::localtime
-#include <sstream>	// std::ostringstream
-#include <filesystem> // extract file name (C++17)
+#include <ctime>	// local time
+#include <cstdio>	// batched console writes
+#include <cstring>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <algorithm>
+#include <cctype>
+
+// Records in flight, power of two (~2 MB)
+const size_t LOG_RING_CAPACITY = 8192;
+// Records formatted per console write
+const size_t LOG_WRITE_BATCH = 256;
+// Writer sleep when the ring is empty, log calls never wake it up
+const int LOG_WRITER_IDLE_MS = 2;
 
 // Initialize variables
-std::vector<LogEntry> Logger::messages;
+std::atomic<uint8_t> Logger::categoryLevels[static_cast<size_t>(LogCategory::Count)] = {
+	{ INFO }, { INFO }, { INFO }, { INFO }, { INFO }, { INFO }, { INFO }
+};
+static_assert(static_cast<size_t>(LogCategory::Count) == 7, "give the new category a default level above");
+
+const char* const LOG_CATEGORY_NAMES[] = { "General", "ECS", "Assets", "Events", "Collision", "World", "Scripting" };
+const char* const LOG_LEVEL_NAMES[] = { "verbose", "info", "warning", "error" };
+
+namespace {
+
+	const char* GetFilename(const char* path) {
+		const char* filename = path;
+		for (const char* c = path; *c; c++) {
+			if (*c == '/' || *c == '\\') {
+				filename = c + 1;
+			}
+		}
+		return filename;
+	}
+
+	class LogWriter {
+	private:
+		MPSCRingBuffer<LogRecord> ring;
+		std::atomic<uint64_t> droppedCount { 0 };
+		uint64_t reportedDroppedCount = 0;
+		std::atomic<bool> bConsoleOutput { true };
+
+		std::thread thread;
+		std::mutex wakeMutex;
+		std::condition_variable wakeCondition;		// Flush() and shutdown wake the writer early
+		std::condition_variable writtenCondition;	// writer finished a batch
+		bool bIsStopping = false;
+
+		// Local time only changes once per second, so is formatted once per second
+		std::time_t cachedSecond = -1;
+		char cachedDateTime[32] = {};
+
+		LogHistory history { LOG_HISTORY_CAPACITY };
+
+		// The writer holds fileMutex while it processes a batch, opening and closing takes it too
+		std::mutex fileMutex;
+		RotatingLogFile logFile;
+		BinaryLogSink binarySink;
+		std::atomic<bool> bFileOutput { false };
+		// Records below this level skip text formatting (console, history, log file), the binary sink still gets them
+		std::atomic<int> textOutputLevel { VERBOSE };
+
+		std::string message;		// reused for every record
+		std::string batch;			// console text, colored
+		std::string fileBatch;		// log file text, plain
+
+		const char* FormatDateTime(int64_t timestamp) {
+			const std::chrono::system_clock::time_point timePoint { std::chrono::system_clock::duration(timestamp) };
+			const std::time_t second = std::chrono::system_clock::to_time_t(timePoint);
+			if (second != cachedSecond) {
+				std::tm localTime;
+#ifdef _WIN32
+				localtime_s(&localTime, &second);
+#else
+				localtime_r(&second, &localTime);
+#endif
+				std::strftime(cachedDateTime, sizeof(cachedDateTime), "%Y-%m-%d %H:%M:%S", &localTime);
+				cachedSecond = second;
+			}
+			return cachedDateTime;
+		}
+
+		void WriteRecord(const LogRecord& record) {
+			binarySink.Write(record);
+			if (record.type >= textOutputLevel.load(std::memory_order_relaxed)) {
+				FormatRecord(record);
+			}
+		}
+
+		void FormatRecord(const LogRecord& record) {
+			const char* label;
+			const char* color;
+			switch (record.type) {
+				case VERBOSE:	label = "[VERBOSE]";	color = "\033[37m";	break;
+				case WARNING:	label = "[WARNING]";	color = "\033[33m";	break;
+				case ERROR:		label = "[ERROR  ]";	color = "\033[31m";	break;
+				default:		label = "[INFO   ]";	color = "\033[92m";	break;
+			}
+
+			message.clear();
+			FormatLogMessage(record.format, record.payload, record.payloadSize, message);
+			if (record.bTruncated) {
+				message += "...";
+			}
+			history.Add(record.type, record.category, record.timestamp, record.file, record.line, message);
+
+			const char* dateTime = FormatDateTime(record.timestamp);
+			const char* filename = GetFilename(record.file);
+			const std::string line = std::to_string(record.line);
+			auto appendHeader = [&](std::string& output, const char* separatorColor) {
+				output += label;
+				output += "[";
+				output += dateTime;
+				output += "]";
+				if (record.category != LogCategory::General) {
+					output += "[";
+					output += Logger::GetCategoryName(record.category);
+					output += "]";
+				}
+				output += ":";
+				output += separatorColor;
+				output += "[File: ";
+				output += filename;
+				output += ", Line: ";
+				output += line;
+				output += "]: ";
+			};
+
+			batch += color;
+			appendHeader(batch, "\033[90m");
+			batch += color;
+			batch += message;
+			batch += "\033[0m\n";
+
+			if (bFileOutput.load(std::memory_order_relaxed)) {
+				appendHeader(fileBatch, "");
+				fileBatch += message;
+				fileBatch += '\n';
+			}
+		}
+
+		void WriteBatch() {
+			if (!batch.empty() && bConsoleOutput.load(std::memory_order_relaxed)) {
+				std::fwrite(batch.data(), 1, batch.size(), stdout);
+				std::fflush(stdout);
+			}
+			batch.clear();
+
+			if (!fileBatch.empty()) {
+				logFile.Write(fileBatch.data(), fileBatch.size());
+				logFile.Flush();
+				fileBatch.clear();
+			}
+			binarySink.Flush();
+		}
+
+		void ReportDroppedRecords() {
+			const uint64_t dropped = droppedCount.load(std::memory_order_relaxed);
+			if (dropped == reportedDroppedCount) {
+				return;
+			}
+			LogRecord record = {};
+			record.timestamp	= std::chrono::system_clock::now().time_since_epoch().count();
+			record.file			= __FILE__;
+			record.line			= __LINE__;
+			record.type			= WARNING;
+			record.category		= LogCategory::General;
+			record.format		= "{} log messages dropped, the log ring buffer was full";
+			LogArgWriter argWriter(record.payload, LOG_PAYLOAD_CAPACITY);
+			argWriter.Write(dropped - reportedDroppedCount);
+			record.payloadSize	= static_cast<uint16_t>(argWriter.GetSize(record.payload));
+			WriteRecord(record);
+			reportedDroppedCount = dropped;
+		}
+
+		void WriterLoop() {
+			Profiler::SetThreadName("Logger");
+			while (true) {
+				size_t count = 0;
+				{
+					std::lock_guard<std::mutex> fileLock(fileMutex);
+					const int64_t batchStart = Profiler::Now();
+					while (count < LOG_WRITE_BATCH && ring.TryPop([this](const LogRecord& record) { WriteRecord(record); })) {
+						count++;
+					}
+					ReportDroppedRecords();
+					WriteBatch();
+					// The writer wakes up every LOG_WRITER_IDLE_MS, only batches with records are worth a sample
+					if (count != 0) {
+						Profiler::RecordSample("LogWriter", batchStart, Profiler::Now());
+					}
+				}
+				writtenCondition.notify_all();
+				if (count == LOG_WRITE_BATCH) {
+					continue;
+				}
+
+				std::unique_lock<std::mutex> lock(wakeMutex);
+				if (bIsStopping) {
+					// Stop only once everything queued before the shutdown is written
+					if (ring.GetPopCount() == ring.GetPushCount()) {
+						return;
+					}
+					continue;
+				}
+				wakeCondition.wait_for(lock, std::chrono::milliseconds(LOG_WRITER_IDLE_MS));
+			}
+		}
+
+	public:
+		LogWriter() : ring(LOG_RING_CAPACITY) {
+			thread = std::thread(&LogWriter::WriterLoop, this);
+		}
+
+		// Runs at exit, drains the ring before the writer stops
+		~LogWriter() {
+			{
+				std::lock_guard<std::mutex> lock(wakeMutex);
+				bIsStopping = true;
+			}
+			wakeCondition.notify_one();
+			thread.join();
+		}
+
+		void Push(LogType type, LogCategory category, const char* file, int line, const char* format, const uint8_t* payload, size_t payloadSize, bool bTruncated) {
+			const int64_t timestamp = std::chrono::system_clock::now().time_since_epoch().count();
+			const bool bPushed = ring.TryPush([&](LogRecord& record) {
+				record.timestamp	= timestamp;
+				record.file			= file;
+				record.format		= format;
+				record.line			= static_cast<uint32_t>(line);
+				record.type			= type;
+				record.category		= category;
+				record.bTruncated	= bTruncated;
+				record.payloadSize	= static_cast<uint16_t>(payloadSize);
+				if (payloadSize > 0) {
+					std::memcpy(record.payload, payload, payloadSize);
+				}
+			});
+			if (!bPushed) {
+				droppedCount.fetch_add(1, std::memory_order_relaxed);
+			}
+		}
+
+		void Flush() {
+			const size_t target = ring.GetPushCount();
+			std::unique_lock<std::mutex> lock(wakeMutex);
+			wakeCondition.notify_one();
+			writtenCondition.wait(lock, [this, target]() { return ring.GetPopCount() >= target; });
+		}
+
+		void SetConsoleOutput(bool bEnabled) {
+			bConsoleOutput.store(bEnabled, std::memory_order_relaxed);
+		}
+
+		uint64_t GetDroppedCount() const {
+			return droppedCount.load(std::memory_order_relaxed);
+		}
+
+		bool EnableFileOutput(const std::string& filepath, size_t maxFileBytes, int maxFiles) {
+			std::lock_guard<std::mutex> lock(fileMutex);
+			const bool bOpened = logFile.Open(filepath, maxFileBytes, maxFiles);
+			bFileOutput.store(bOpened, std::memory_order_relaxed);
+			return bOpened;
+		}
+
+		void DisableFileOutput() {
+			std::lock_guard<std::mutex> lock(fileMutex);
+			bFileOutput.store(false, std::memory_order_relaxed);
+			logFile.Close();
+		}
 
-std::string Logger::GetCurrentDateTime(){
-	auto now = std::chrono::system_clock::now();
-	std::time_t now_time = std::chrono::system_clock::to_time_t(now);
-	std::tm local_time;
-	localtime_s(&local_time, &now_time);
+		bool EnableBinaryOutput(const std::string& filepath) {
+			std::lock_guard<std::mutex> lock(fileMutex);
+			return binarySink.Open(filepath);
+		}
 
-	std::ostringstream oss;
-	oss << std::put_time(&local_time, "%Y-%m-%d %H:%M:%S");
-	return oss.str();
+		void DisableBinaryOutput() {
+			std::lock_guard<std::mutex> lock(fileMutex);
+			binarySink.Close();
+		}
+
+		void SetTextOutputLevel(LogType level) {
+			textOutputLevel.store(level, std::memory_order_relaxed);
+		}
+
+		LogHistory& GetHistory() {
+			return history;
+		}
+	};
+
+	// Created on the first log call, destroyed (and drained) at exit
+	LogWriter& GetWriter() {
+		static LogWriter writer;
+		return writer;
+	}
+}
+
+void Logger::Push(LogType type, LogCategory category, const char* file, int line, const char* format, const uint8_t* payload, size_t payloadSize, bool bTruncated) {
+	GetWriter().Push(type, category, file, line, format, payload, payloadSize, bTruncated);
+}
+
+void Logger::SetCategoryLevel(LogCategory category, LogType level) {
+	categoryLevels[static_cast<size_t>(category)].store(static_cast<uint8_t>(level), std::memory_order_relaxed);
+}
+
+namespace {
+
+	std::string ToLower(std::string text) {
+		std::transform(text.begin(), text.end(), text.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+		return text;
+	}
+
+	bool ParseLevelName(const std::string& name, LogType& type) {
+		const std::string levelName = ToLower(name);
+		const auto level = std::find_if(std::begin(LOG_LEVEL_NAMES), std::end(LOG_LEVEL_NAMES), [&](const char* candidate) { return levelName == candidate; });
+		if (level == std::end(LOG_LEVEL_NAMES)) {
+			return false;
+		}
+		type = static_cast<LogType>(level - std::begin(LOG_LEVEL_NAMES));
+		return true;
+	}
+}
+
+bool Logger::ApplyLevelSetting(const std::string& setting) {
+	const size_t separator = setting.find('=');
+	if (separator == std::string::npos) {
+		return false;
+	}
+	const std::string categoryName = ToLower(setting.substr(0, separator));
+	LogType type;
+	if (!ParseLevelName(setting.substr(separator + 1), type)) {
+		return false;
+	}
+
+	bool bMatched = false;
+	for (size_t i = 0; i < static_cast<size_t>(LogCategory::Count); i++) {
+		if (categoryName == "all" || categoryName == ToLower(LOG_CATEGORY_NAMES[i])) {
+			SetCategoryLevel(static_cast<LogCategory>(i), type);
+			bMatched = true;
+		}
+	}
+	return bMatched;
+}
+
+const char* Logger::GetCategoryName(LogCategory category) {
+	return LOG_CATEGORY_NAMES[static_cast<size_t>(category)];
+}
+
+void Logger::Flush() {
+	GetWriter().Flush();
 }
 
-void Logger::Log(const std::string& message, const char* file, int line) {
-	std::string filename = std::filesystem::path(file).filename().string();
-	std::string line_str = std::to_string(line);
+void Logger::SetConsoleOutput(bool bEnabled) {
+	GetWriter().SetConsoleOutput(bEnabled);
+}
 
-	LogEntry logEntry;
-	logEntry.type = INFO;
-	logEntry.message = "[INFO   ][" + GetCurrentDateTime() + "]:" + "\033[90m" +
-						"[File: " + filename + ", Line: " + line_str + "]: "
-						+ "\033[92m" + message;
-	
-	std::cout << "\033[92m" << logEntry.message << "\033[0m" << std::endl;
+uint64_t Logger::GetDroppedCount() {
+	return GetWriter().GetDroppedCount();
+}
 
-	messages.push_back(logEntry);
-	return;
+bool Logger::EnableFileOutput(const std::string& filepath, size_t maxFileBytes, int maxFiles) {
+	return GetWriter().EnableFileOutput(filepath, maxFileBytes, maxFiles);
 }
 
-void Logger::Wrn(const std::string& message, const char* file, int line) {
-	std::string filename = std::filesystem::path(file).filename().string();
-	std::string line_str = std::to_string(line);
+void Logger::DisableFileOutput() {
+	GetWriter().DisableFileOutput();
+}
 
-	LogEntry logEntry;
-	logEntry.type = WARNING;
-	logEntry.message = "[WARNING][" + GetCurrentDateTime() + "]:" + "\033[90m" +
-						"[File: " + filename + ", Line: " + line_str + "]: "
-						+ "\033[33m" + message;
+std::vector<LogEntry> Logger::QueryHistory(const LogQuery& query) {
+	return GetWriter().GetHistory().Query(query);
+}
 
-	std::cout	<< "\033[33m" << logEntry.message << "\033[0m" << std::endl;
-	
-	messages.push_back(logEntry);
-	return;
+std::string Logger::GetFileName(uint16_t fileId) {
+	return GetWriter().GetHistory().GetFileName(fileId);
 }
 
-void Logger::Err(const std::string& message, const char* file, int line) {
-	std::string filename = std::filesystem::path(file).filename().string();
-	std::string line_str = std::to_string(line);
+void Logger::SetHistoryCapacity(size_t capacity) {
+	GetWriter().GetHistory().SetCapacity(capacity);
+}
 
-	LogEntry logEntry;
-	logEntry.type = ERROR;
-	logEntry.message =	"[ERROR  ][" + GetCurrentDateTime() + "]:" + "\033[90m" + 
-						"[File: " + filename + ", Line: " + line_str + "]: "
-						+ "\033[31m" + message;
+void Logger::ClearHistory() {
+	GetWriter().GetHistory().Clear();
+}
+
+bool Logger::EnableBinaryOutput(const std::string& filepath) {
+	return GetWriter().EnableBinaryOutput(filepath);
+}
+
+void Logger::DisableBinaryOutput() {
+	GetWriter().DisableBinaryOutput();
+}
+
+void Logger::SetTextOutputLevel(LogType level) {
+	GetWriter().SetTextOutputLevel(level);
+}
 
-	std::cout	<< "\033[31m" << logEntry.message << "\033[0m" << std::endl;			
-	
-	messages.push_back(logEntry);
-	return;
+bool Logger::ApplyTextOutputLevel(const std::string& levelName) {
+	LogType type;
+	if (!ParseLevelName(levelName, type)) {
+		return false;
+	}
+	SetTextOutputLevel(type);
+	return true;
 }
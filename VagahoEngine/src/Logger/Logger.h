@@ -1,31 +1,137 @@
 #pragma once
 
-#define LOG_INFO(msg) Logger::Log(msg, __FILE__, __LINE__)
-#define LOG_WARNING(msg) Logger::Wrn(msg, __FILE__, __LINE__)
-#define LOG_ERROR(msg) Logger::Err(msg, __FILE__, __LINE__)
+#include "LogLevels.h"
+#include "LogFormat.h"
+#include "LogHistory.h"
 
 #include <string>
 #include <vector>
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
 
-enum LogType {
-	INFO,
-	WARNING,
-	ERROR
-};
+////////////////////////////////////////////////////////////////////////////////
+/// LOG MACROS
+////////////////////////////////////////////////////////////////////////////////
+/// LOG_AT(level, category, format, args...) with shorthands for the General
+/// category, e.g. LOG_INFO("Loaded {} tiles", count) or LOG_ERROR(message).
+/// Calls below VAGAHO_MIN_LOG_LEVEL are compiled out, their arguments are
+/// never evaluated. The rest check the runtime level of their category before
+/// touching the arguments. A format must be a string literal, any other string
+/// is logged as it is.
+////////////////////////////////////////////////////////////////////////////////
+#ifndef VAGAHO_MIN_LOG_LEVEL
+#ifdef NDEBUG
+#define VAGAHO_MIN_LOG_LEVEL INFO
+#else
+#define VAGAHO_MIN_LOG_LEVEL VERBOSE
+#endif
+#endif
+
+#define LOG_AT(level, category, ...) \
+	do { \
+		if constexpr (level >= VAGAHO_MIN_LOG_LEVEL) { \
+			if (Logger::bIsEnabled(level, LogCategory::category)) { \
+				Logger::Write(level, LogCategory::category, __FILE__, __LINE__, __VA_ARGS__); \
+			} \
+		} \
+	} while (0)
+
+#define LOG_VERBOSE(...) LOG_AT(VERBOSE, General, __VA_ARGS__)
+#define LOG_INFO(...) LOG_AT(INFO, General, __VA_ARGS__)
+#define LOG_WARNING(...) LOG_AT(WARNING, General, __VA_ARGS__)
+#define LOG_ERROR(...) LOG_AT(ERROR, General, __VA_ARGS__)
 
-struct LogEntry {
+// Encoded arguments beyond this are dropped, the record stays fixed size
+const size_t LOG_PAYLOAD_CAPACITY = 192;
+// Messages kept in memory for the in-game console (see Logger::QueryHistory)
+const size_t LOG_HISTORY_CAPACITY = 4096;
+// Rotating log file defaults (see Logger::EnableFileOutput)
+const size_t LOG_FILE_MAX_BYTES = 8 * 1024 * 1024;
+const int LOG_FILE_MAX_COUNT = 4;
+
+// One log call, copied into the ring buffer as is and formatted later by the writer thread
+struct LogRecord {
+	int64_t timestamp;				// system_clock ticks
+	const char* file;				// __FILE__, a string literal that lives as long as the program
+	const char* format;				// string literal
+	uint32_t line;
 	LogType type;
-	std::string message;
+	LogCategory category;
+	bool bTruncated;
+	uint16_t payloadSize;			// bytes used in payload
+	uint8_t payload[LOG_PAYLOAD_CAPACITY];	// arguments, see LogArgWriter
 };
 
+////////////////////////////////////////////////////////////////////////////////
+/// LOGGER
+////////////////////////////////////////////////////////////////////////////////
+/// Log calls only copy their arguments into a fixed-size record and push it
+/// into a lock-free ring buffer (see MPSCRingBuffer), from any thread. A
+/// background writer thread formats the records (message, time, file name,
+/// colors) and writes them to the console in batches with one flush per batch.
+/// When the buffer is full the record is dropped and counted instead of
+/// blocking the caller. Everything still queued is written when the program exits.
+////////////////////////////////////////////////////////////////////////////////
 class Logger {
 private:
-	static std::string GetCurrentDateTime();
+	static std::atomic<uint8_t> categoryLevels[static_cast<size_t>(LogCategory::Count)];
+
+	static void Push(LogType type, LogCategory category, const char* file, int line, const char* format, const uint8_t* payload, size_t payloadSize, bool bTruncated);
+
 public:
-	static void Log(const std::string& message, const char* file, int line);
-	static void Wrn(const std::string& message, const char* file, int line);
-	static void Err(const std::string& message, const char* file, int line);
+	static bool bIsEnabled(LogType type, LogCategory category) {
+		return type >= categoryLevels[static_cast<size_t>(category)].load(std::memory_order_relaxed);
+	}
 
-	static std::vector<LogEntry> messages;
-};
+	// format is a string literal with {} placeholders
+	template <size_t N, typename ...TArgs>
+	static void Write(LogType type, LogCategory category, const char* file, int line, const char (&format)[N], const TArgs& ...args) {
+		if constexpr (sizeof...(TArgs) == 0) {
+			// Nothing to encode, don't hand Push an uninitialized buffer
+			Push(type, category, file, line, format, nullptr, 0, false);
+		}
+		else {
+			uint8_t payload[LOG_PAYLOAD_CAPACITY];
+			LogArgWriter argWriter(payload, LOG_PAYLOAD_CAPACITY);
+			(argWriter.Write(args), ...);
+			Push(type, category, file, line, format, payload, argWriter.GetSize(payload), argWriter.bIsTruncated());
+		}
+	}
+
+	// Text built at runtime, logged without placeholder substitution
+	static void Write(LogType type, LogCategory category, const char* file, int line, const std::string& message) {
+		uint8_t payload[LOG_PAYLOAD_CAPACITY];
+		LogArgWriter argWriter(payload, LOG_PAYLOAD_CAPACITY);
+		argWriter.Write(message);
+		Push(type, category, file, line, "{}", payload, argWriter.GetSize(payload), argWriter.bIsTruncated());
+	}
+
+	// Calls of a category below level are skipped (default INFO, VERBOSE also needs a build that keeps them)
+	static void SetCategoryLevel(LogCategory category, LogType level);
+	// "ecs=verbose" style setting, "all=<level>" sets every category. Returns false if it can't be parsed
+	static bool ApplyLevelSetting(const std::string& setting);
+	static const char* GetCategoryName(LogCategory category);
 
+	// Block until every record logged before the call is written
+	static void Flush();
+	// Turn console output off/on (records are still formatted into the history and log file)
+	static void SetConsoleOutput(bool bEnabled);
+	// Also write every message, without colors, to a log file that rotates at maxFileBytes
+	static bool EnableFileOutput(const std::string& filepath, size_t maxFileBytes = LOG_FILE_MAX_BYTES, int maxFiles = LOG_FILE_MAX_COUNT);
+	static void DisableFileOutput();
+	// Also write every record unformatted to a binary log (.vlog, decode with tools/LogDecoder)
+	static bool EnableBinaryOutput(const std::string& filepath);
+	static void DisableBinaryOutput();
+	// Records below level are only written to the binary log, skipping text formatting (default VERBOSE)
+	static void SetTextOutputLevel(LogType level);
+	static bool ApplyTextOutputLevel(const std::string& levelName);
+	// Records lost because the ring buffer was full
+	static uint64_t GetDroppedCount();
+
+	/// History of the last messages, filled by the writer thread
+	static std::vector<LogEntry> QueryHistory(const LogQuery& query = LogQuery());
+	static std::string GetFileName(uint16_t fileId);
+	static void SetHistoryCapacity(size_t capacity);
+	static void ClearHistory();
+};
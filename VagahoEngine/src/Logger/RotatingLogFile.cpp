@@ -0,0 +1,83 @@
+#include "RotatingLogFile.h"
+
+#include <filesystem>
+#include <algorithm>
+#include <cstring>
+#include <system_error>
+
+RotatingLogFile::~RotatingLogFile() {
+	Close();
+}
+
+bool RotatingLogFile::Open(const std::string& filepath, size_t maxBytes, int maxFiles) {
+	Close();
+	this->filepath = filepath;
+	this->maxBytes = maxBytes;
+	this->maxFiles = maxFiles < 1 ? 1 : maxFiles;
+
+	file = std::fopen(filepath.c_str(), "ab");
+	if (!file) {
+		return false;
+	}
+	std::error_code error;
+	const auto existingSize = std::filesystem::file_size(filepath, error);
+	size = error ? 0 : static_cast<size_t>(existingSize);
+	return true;
+}
+
+void RotatingLogFile::Close() {
+	if (file) {
+		std::fclose(file);
+		file = nullptr;
+	}
+}
+
+void RotatingLogFile::Rotate() {
+	Close();
+	std::error_code error;
+	if (maxFiles > 1) {
+		std::filesystem::remove(filepath + "." + std::to_string(maxFiles - 1), error);
+		for (int i = maxFiles - 2; i >= 1; i--) {
+			std::filesystem::rename(filepath + "." + std::to_string(i), filepath + "." + std::to_string(i + 1), error);
+		}
+		std::filesystem::rename(filepath, filepath + ".1", error);
+	}
+	file = std::fopen(filepath.c_str(), "wb");
+	size = 0;
+}
+
+void RotatingLogFile::Write(const char* data, size_t length) {
+	while (file && length > 0) {
+		size_t chunk = length;
+		if (maxBytes != 0 && size + length > maxBytes) {
+			// Fill the file up to the last whole line that fits, the rest goes to the next file
+			const size_t room = maxBytes > size ? maxBytes - size : 0;
+			chunk = 0;
+			for (size_t i = std::min(room, length); i > 0; i--) {
+				if (data[i - 1] == '\n') {
+					chunk = i;
+					break;
+				}
+			}
+			if (chunk == 0) {
+				if (size > 0) {
+					Rotate();
+					continue;
+				}
+				// A single line longer than maxBytes gets a file of its own
+				const char* lineEnd = static_cast<const char*>(std::memchr(data, '\n', length));
+				chunk = lineEnd ? static_cast<size_t>(lineEnd - data) + 1 : length;
+			}
+		}
+		std::fwrite(data, 1, chunk, file);
+		size += chunk;
+		data += chunk;
+		length -= chunk;
+	}
+}
+
+void RotatingLogFile::Flush() {
+	if (file) {
+		std::fflush(file);
+	}
+}
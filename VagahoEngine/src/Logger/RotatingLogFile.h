@@ -0,0 +1,37 @@
+#pragma once
+
+#include <string>
+#include <cstdio>
+#include <cstddef>
+
+////////////////////////////////////////////////////////////////////////////////
+/// ROTATING LOG FILE
+////////////////////////////////////////////////////////////////////////////////
+/// Appends to filepath until it reaches maxBytes, then shifts the older files
+/// (filepath.1 becomes filepath.2 ...) and starts over. At most maxFiles files
+/// exist, so a long session keeps a bounded amount of log on disk.
+////////////////////////////////////////////////////////////////////////////////
+class RotatingLogFile {
+private:
+	std::string filepath;
+	size_t maxBytes = 0;
+	int maxFiles = 1;
+	std::FILE* file = nullptr;
+	size_t size = 0;
+
+	void Rotate();
+
+public:
+	RotatingLogFile() = default;
+	~RotatingLogFile();
+
+	RotatingLogFile(const RotatingLogFile&) = delete;
+	RotatingLogFile& operator =(const RotatingLogFile&) = delete;
+
+	bool Open(const std::string& filepath, size_t maxBytes, int maxFiles);
+	void Close();
+	bool bIsOpen() const { return file != nullptr; }
+
+	void Write(const char* data, size_t length);
+	void Flush();
+};
@@ -1,10 +1,119 @@
 #include <iostream>
+#include <string>
+#include <cstdlib>
 
 #include "Game/Game.h"
+#include "AssetArchive/AssetPacker.h"
+#include "MapLoader/MapLoader.h"
+#include "Logger/Logger.h"
+#include "Profiler/Profiler.h"
+#include "Replay/InputRecording.h"
+#include "Replay/ReplayReport.h"
+
+// Re-simulates a recording headless, fails if it doesn't match the baseline report of an earlier build
+int RunReplay(const std::string& recordingFilepath, const std::string& reportFilepath, const std::string& baselineFilepath) {
+    InputRecording recording;
+    if (!InputRecordingFile::Load(recordingFilepath, recording)) {
+        return EXIT_FAILURE;
+    }
+    ReplayReport baseline;
+    if (!baselineFilepath.empty() && !baseline.ReadJson(baselineFilepath)) {
+        LOG_ERROR("Can't read replay baseline '{}'", baselineFilepath);
+        return EXIT_FAILURE;
+    }
+
+    ReplayReport report;
+    {
+        Game game;
+        game.Initialize(true);
+        game.Replay(recording, report);
+    }
+    report.Print();
+
+    if (!reportFilepath.empty() && !report.WriteJson(reportFilepath)) {
+        LOG_ERROR("Can't write replay report '{}'", reportFilepath);
+        return EXIT_FAILURE;
+    }
+    if (!baselineFilepath.empty() && !report.CompareWithBaseline(baseline)) {
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
 
 int main(int argc, char* argv[]) {    
+    // Offline asset packing: VagahoEngine --pack <assets directory> <output archive>
+    if (argc == 4 && std::string(argv[1]) == "--pack") {
+        return AssetPacker::PackDirectory(argv[2], argv[3]) ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+    // Text map to binary map: VagahoEngine --convert-map <input .map> <output .vmap>
+    if (argc == 4 && std::string(argv[1]) == "--convert-map") {
+        MapData mapData;
+        return MapLoader::LoadCsv(argv[2], mapData) && MapLoader::SaveBinary(argv[3], mapData) ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+    // Map to streamed region map: VagahoEngine --build-world <input map> <output .vworld> [region size in tiles]
+    if ((argc == 4 || argc == 5) && std::string(argv[1]) == "--build-world") {
+        MapData mapData;
+        const int regionSize = argc == 5 ? std::atoi(argv[4]) : DEFAULT_REGION_SIZE;
+        if (regionSize <= 0 || !MapLoader::Load(argv[2], mapData)) {
+            return EXIT_FAILURE;
+        }
+        return MapLoader::SaveRegions(argv[3], mapData, regionSize) ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+    // Runtime log filters: --log <category>=<level>, e.g. --log ecs=verbose or --log all=warning
+    // Rotating log file: --log-file <path>
+    // Binary log: --log-binary <path>, decode with tools/LogDecoder
+    // Text output threshold: --log-text-level <level>, lower records only go to the binary log
+    for (int i = 1; i + 1 < argc; i++) {
+        if (std::string(argv[i]) == "--log" && !Logger::ApplyLevelSetting(argv[i + 1])) {
+            LOG_WARNING("Unknown log setting '{}'", argv[i + 1]);
+        }
+        if (std::string(argv[i]) == "--log-file" && !Logger::EnableFileOutput(argv[i + 1])) {
+            LOG_WARNING("Can't open log file '{}'", argv[i + 1]);
+        }
+        if (std::string(argv[i]) == "--log-binary" && !Logger::EnableBinaryOutput(argv[i + 1])) {
+            LOG_WARNING("Can't open binary log '{}'", argv[i + 1]);
+        }
+        if (std::string(argv[i]) == "--log-text-level" && !Logger::ApplyTextOutputLevel(argv[i + 1])) {
+            LOG_WARNING("Unknown log level '{}'", argv[i + 1]);
+        }
+    }
+
+    // Headless replay: --replay <recording .vrec> [--replay-report <output .json>] [--replay-baseline <report .json of an earlier build>]
+    std::string replayFilepath, replayReportFilepath, replayBaselineFilepath;
+    for (int i = 1; i + 1 < argc; i++) {
+        if (std::string(argv[i]) == "--replay") {
+            replayFilepath = argv[i + 1];
+        }
+        if (std::string(argv[i]) == "--replay-report") {
+            replayReportFilepath = argv[i + 1];
+        }
+        if (std::string(argv[i]) == "--replay-baseline") {
+            replayBaselineFilepath = argv[i + 1];
+        }
+    }
+    if (!replayFilepath.empty()) {
+        return RunReplay(replayFilepath, replayReportFilepath, replayBaselineFilepath);
+    }
+
     Game game;
     game.Initialize();
+    for (int i = 1; i < argc; i++) {
+        if (std::string(argv[i]) == "--hot-reload") {
+            game.EnableHotReload();
+        }
+        // Chrome trace of the whole run: --trace <path>, F2 starts and stops one in game
+        if (std::string(argv[i]) == "--trace" && i + 1 < argc && !Profiler::StartTrace(argv[i + 1])) {
+            LOG_WARNING("Can't write trace '{}'", argv[i + 1]);
+        }
+        // Input recording for --replay: --record <path> [--seed <number>], the seed is random otherwise
+        if (std::string(argv[i]) == "--record" && i + 1 < argc) {
+            game.StartRecording(argv[i + 1]);
+        }
+        if (std::string(argv[i]) == "--seed" && i + 1 < argc) {
+            game.SetRandomSeed(static_cast<uint32_t>(std::strtoul(argv[i + 1], nullptr, 10)));
+        }
+    }
     game.Run();
     //game.Destroy();
 
@@ -0,0 +1,203 @@
+#include "MapLoader.h"
+
+#include "../Logger/Logger.h"
+#include "../Utils/MappedFile.h"
+
+#include <charconv>
+#include <cstring>
+#include <fstream>
+#include <algorithm>
+#include <limits>
+
+namespace {
+
+	inline bool bIsBlank(char c) {
+		return c == ' ' || c == '\t' || c == '\r';
+	}
+}
+
+bool MapLoader::ParseCsv(const char* begin, const char* end, MapData& mapData) {
+	mapData.columns = 0;
+	mapData.rows = 0;
+	mapData.tiles.clear();
+
+	// Reserve once: tiles in the first line times the number of lines
+	const char* firstLineEnd = std::find(begin, end, '\n');
+	const size_t firstLineTiles = std::count(begin, firstLineEnd, ',') + 1;
+	const size_t lineCount = std::count(begin, end, '\n') + 1;
+	mapData.tiles.reserve(firstLineTiles * lineCount);
+
+	const char* cursor = begin;
+	int rowColumns = 0;
+	while (cursor < end) {
+		const char c = *cursor;
+		if (bIsBlank(c) || c == ',') {
+			cursor++;
+			continue;
+		}
+		if (c == '\n') {
+			cursor++;
+		}
+		else {
+			int tileId;
+			const auto result = std::from_chars(cursor, end, tileId);
+			if (result.ec != std::errc()) {
+				LOG_AT(ERROR, World, "Map parse error at line {}: unexpected '{}'", std::count(begin, cursor, '\n') + 1, c);
+				return false;
+			}
+			mapData.tiles.push_back(tileId);
+			rowColumns++;
+			cursor = result.ptr;
+			if (cursor < end) {
+				continue;
+			}
+		}
+
+		// End of a line (or of the file right after a tile)
+		if (rowColumns == 0) {
+			continue;
+		}
+		if (mapData.columns != 0 && rowColumns != mapData.columns) {
+			LOG_AT(ERROR, World, "Map row {} has {} tiles, expected {}", mapData.rows, rowColumns, mapData.columns);
+			return false;
+		}
+		mapData.columns = rowColumns;
+		mapData.rows++;
+		rowColumns = 0;
+	}
+	return true;
+}
+
+bool MapLoader::ParseBinary(const uint8_t* data, size_t size, MapData& mapData) {
+	if (size < sizeof(BinaryMapHeader)) {
+		LOG_AT(ERROR, World, "Binary map is truncated");
+		return false;
+	}
+
+	BinaryMapHeader header;
+	std::memcpy(&header, data, sizeof(BinaryMapHeader));
+	if (std::memcmp(header.magic, BINARY_MAP_MAGIC, sizeof(BINARY_MAP_MAGIC)) != 0 || header.version != BINARY_MAP_VERSION) {
+		LOG_AT(ERROR, World, "Not a version {} binary map", BINARY_MAP_VERSION);
+		return false;
+	}
+
+	// MapData sizes are int, and a corrupt header mustn't overflow the size check
+	const uint32_t maxDimension = static_cast<uint32_t>(std::numeric_limits<int>::max());
+	if (header.columns > maxDimension || header.rows > maxDimension) {
+		LOG_AT(ERROR, World, "Binary map is {} x {} tiles, too large", header.columns, header.rows);
+		return false;
+	}
+	const uint64_t tileCount = static_cast<uint64_t>(header.columns) * header.rows;
+	if (tileCount > (size - sizeof(BinaryMapHeader)) / sizeof(int32_t)) {
+		LOG_AT(ERROR, World, "Binary map is truncated");
+		return false;
+	}
+
+	mapData.columns = static_cast<int>(header.columns);
+	mapData.rows = static_cast<int>(header.rows);
+	mapData.tiles.resize(static_cast<size_t>(tileCount));
+	static_assert(sizeof(int) == sizeof(int32_t), "tiles are copied as int32");
+	std::memcpy(mapData.tiles.data(), data + sizeof(BinaryMapHeader), mapData.tiles.size() * sizeof(int32_t));
+	return true;
+}
+
+bool MapLoader::LoadCsv(const std::string& filepath, MapData& mapData) {
+	MappedFile file;
+	if (!file.Open(filepath)) {
+		LOG_AT(ERROR, World, "Can't open map {}", filepath);
+		return false;
+	}
+	const char* text = reinterpret_cast<const char*>(file.GetData());
+	return ParseCsv(text, text + file.GetSize(), mapData);
+}
+
+bool MapLoader::LoadBinary(const std::string& filepath, MapData& mapData) {
+	MappedFile file;
+	if (!file.Open(filepath)) {
+		LOG_AT(ERROR, World, "Can't open map {}", filepath);
+		return false;
+	}
+	return ParseBinary(file.GetData(), file.GetSize(), mapData);
+}
+
+bool MapLoader::Load(const std::string& filepath, MapData& mapData) {
+	const std::string binaryExtension = ".vmap";
+	if (filepath.size() >= binaryExtension.size() &&
+		filepath.compare(filepath.size() - binaryExtension.size(), binaryExtension.size(), binaryExtension) == 0) {
+		return LoadBinary(filepath, mapData);
+	}
+	return LoadCsv(filepath, mapData);
+}
+
+std::vector<uint8_t> MapLoader::SerializeBinary(const MapData& mapData) {
+	BinaryMapHeader header;
+	std::memcpy(header.magic, BINARY_MAP_MAGIC, sizeof(BINARY_MAP_MAGIC));
+	header.version = BINARY_MAP_VERSION;
+	header.columns = static_cast<uint32_t>(mapData.columns);
+	header.rows = static_cast<uint32_t>(mapData.rows);
+
+	std::vector<uint8_t> bytes(sizeof(BinaryMapHeader) + mapData.tiles.size() * sizeof(int32_t));
+	std::memcpy(bytes.data(), &header, sizeof(BinaryMapHeader));
+	std::memcpy(bytes.data() + sizeof(BinaryMapHeader), mapData.tiles.data(), mapData.tiles.size() * sizeof(int32_t));
+	return bytes;
+}
+
+bool MapLoader::SaveBinary(const std::string& filepath, const MapData& mapData) {
+	const std::vector<uint8_t> bytes = SerializeBinary(mapData);
+	std::ofstream file(filepath, std::ios::binary | std::ios::trunc);
+	file.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+	if (!file) {
+		LOG_AT(ERROR, World, "Can't write map {}", filepath);
+		return false;
+	}
+	return true;
+}
+
+std::vector<uint8_t> MapLoader::SerializeRegions(const MapData& mapData, int regionSize) {
+	RegionMapHeader header;
+	std::memcpy(header.magic, REGION_MAP_MAGIC, sizeof(REGION_MAP_MAGIC));
+	header.version			= REGION_MAP_VERSION;
+	header.columns			= static_cast<uint32_t>(mapData.columns);
+	header.rows				= static_cast<uint32_t>(mapData.rows);
+	header.regionSize		= static_cast<uint32_t>(regionSize);
+	header.regionColumns	= static_cast<uint32_t>((mapData.columns + regionSize - 1) / regionSize);
+	header.regionRows		= static_cast<uint32_t>((mapData.rows + regionSize - 1) / regionSize);
+	header.reserved			= 0;
+
+	const size_t regionCount = static_cast<size_t>(header.regionColumns) * header.regionRows;
+	std::vector<RegionMapEntry> entries(regionCount);
+	std::vector<uint8_t> bytes(sizeof(RegionMapHeader) + regionCount * sizeof(RegionMapEntry) + mapData.tiles.size() * sizeof(int32_t));
+
+	uint64_t offset = sizeof(RegionMapHeader) + regionCount * sizeof(RegionMapEntry);
+	for (uint32_t regionY = 0; regionY < header.regionRows; regionY++) {
+		for (uint32_t regionX = 0; regionX < header.regionColumns; regionX++) {
+			RegionMapEntry& entry = entries[regionY * header.regionColumns + regionX];
+			const int firstX = static_cast<int>(regionX) * regionSize;
+			const int firstY = static_cast<int>(regionY) * regionSize;
+			entry.offset	= offset;
+			entry.columns	= static_cast<uint32_t>(std::min(regionSize, mapData.columns - firstX));
+			entry.rows		= static_cast<uint32_t>(std::min(regionSize, mapData.rows - firstY));
+
+			for (uint32_t y = 0; y < entry.rows; y++) {
+				const int* row = mapData.tiles.data() + static_cast<size_t>(firstY + y) * mapData.columns + firstX;
+				std::memcpy(bytes.data() + offset, row, entry.columns * sizeof(int32_t));
+				offset += entry.columns * sizeof(int32_t);
+			}
+		}
+	}
+
+	std::memcpy(bytes.data(), &header, sizeof(RegionMapHeader));
+	std::memcpy(bytes.data() + sizeof(RegionMapHeader), entries.data(), regionCount * sizeof(RegionMapEntry));
+	return bytes;
+}
+
+bool MapLoader::SaveRegions(const std::string& filepath, const MapData& mapData, int regionSize) {
+	const std::vector<uint8_t> bytes = SerializeRegions(mapData, regionSize);
+	std::ofstream file(filepath, std::ios::binary | std::ios::trunc);
+	file.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+	if (!file) {
+		LOG_AT(ERROR, World, "Can't write region map {}", filepath);
+		return false;
+	}
+	return true;
+}
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+struct MapData {
+	int columns = 0;
+	int rows = 0;
+	std::vector<int> tiles;		// row major tile ids [y * columns + x]
+};
+
+////////////////////////////////////////////////////////////////////////////////
+/// BINARY MAP (.vmap)
+////////////////////////////////////////////////////////////////////////////////
+/// Little-endian BinaryMapHeader followed by columns * rows int32 tile ids.
+/// The tiles start 16 bytes in, so a mapped file can be read in place.
+/// Asset archives store maps in this same format.
+////////////////////////////////////////////////////////////////////////////////
+const char		BINARY_MAP_MAGIC[4]		= { 'V', 'M', 'A', 'P' };
+const uint32_t	BINARY_MAP_VERSION		= 1;
+
+struct BinaryMapHeader {
+	char		magic[4];
+	uint32_t	version;
+	uint32_t	columns;
+	uint32_t	rows;
+};
+
+static_assert(sizeof(BinaryMapHeader) == 16, "BinaryMapHeader layout is part of the file format");
+
+////////////////////////////////////////////////////////////////////////////////
+/// REGION MAP (.vworld)
+////////////////////////////////////////////////////////////////////////////////
+/// A large map split into regionSize x regionSize tile regions, so a region can
+/// be read without touching the rest of the file (see WorldStreamer).
+///
+/// Layout (little-endian):
+///   RegionMapHeader
+///   RegionMapEntry[regionColumns * regionRows]	- row major
+///   region tiles								- entry.columns * entry.rows int32 each, row major
+/// Edge regions are smaller when the map size isn't a multiple of regionSize.
+////////////////////////////////////////////////////////////////////////////////
+const char		REGION_MAP_MAGIC[4]		= { 'V', 'R', 'G', 'N' };
+const uint32_t	REGION_MAP_VERSION		= 1;
+const int		DEFAULT_REGION_SIZE		= 64;
+
+struct RegionMapHeader {
+	char		magic[4];
+	uint32_t	version;
+	uint32_t	columns;		// whole map size in tiles
+	uint32_t	rows;
+	uint32_t	regionSize;		// tiles per region side
+	uint32_t	regionColumns;
+	uint32_t	regionRows;
+	uint32_t	reserved;
+};
+
+struct RegionMapEntry {
+	uint64_t	offset;			// from the start of the file
+	uint32_t	columns;
+	uint32_t	rows;
+};
+
+static_assert(sizeof(RegionMapHeader) == 32, "RegionMapHeader layout is part of the file format");
+static_assert(sizeof(RegionMapEntry) == 16, "RegionMapEntry layout is part of the file format");
+
+class MapLoader {
+public:
+	// Text map: one row per line, tile ids separated by commas and/or spaces
+	// All rows must have the same number of tiles, empty lines are skipped
+	static bool ParseCsv(const char* begin, const char* end, MapData& mapData);
+	static bool ParseBinary(const uint8_t* data, size_t size, MapData& mapData);
+
+	static bool LoadCsv(const std::string& filepath, MapData& mapData);
+	static bool LoadBinary(const std::string& filepath, MapData& mapData);
+	// Picks the format from the extension (.vmap is binary, anything else is text)
+	static bool Load(const std::string& filepath, MapData& mapData);
+
+	static std::vector<uint8_t> SerializeBinary(const MapData& mapData);
+	static bool SaveBinary(const std::string& filepath, const MapData& mapData);
+
+	static std::vector<uint8_t> SerializeRegions(const MapData& mapData, int regionSize);
+	static bool SaveRegions(const std::string& filepath, const MapData& mapData, int regionSize);
+};
@@ -0,0 +1,241 @@
+#include "AllocationTracker.h"
+
+#include <atomic>
+#include <algorithm>
+#include <iterator>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+#ifdef _WIN32
+#include <malloc.h>
+#endif
+
+namespace {
+
+	// Static storage is zeroed before any constructor runs, operator new can count from the first allocation
+	struct ScopeCounter {
+		std::atomic<const char*> name;
+		std::atomic<uint64_t> count;
+		std::atomic<uint64_t> bytes;
+	};
+
+	ScopeCounter scopeCounters[ALLOCATION_TRACKER_SCOPES];
+	std::atomic<uint64_t> freeCount;
+
+	const char* const UNSCOPED_NAME = "Unscoped";
+	const char* const OTHER_SCOPES_NAME = "Other scopes";
+	// The last counter takes the scopes that found no free one
+	const size_t OTHER_SCOPES_INDEX = ALLOCATION_TRACKER_SCOPES - 1;
+
+	// Open addressing on the name pointer, a counter is claimed once and never released
+	ScopeCounter& GetCounter(const char* name) {
+		const size_t start = static_cast<size_t>((reinterpret_cast<uintptr_t>(name) >> 3) % OTHER_SCOPES_INDEX);
+		for (size_t probe = 0; probe < OTHER_SCOPES_INDEX; probe++) {
+			ScopeCounter& counter = scopeCounters[(start + probe) % OTHER_SCOPES_INDEX];
+			const char* key = counter.name.load(std::memory_order_acquire);
+			if (key == nullptr && counter.name.compare_exchange_strong(key, name, std::memory_order_acq_rel)) {
+				return counter;
+			}
+			if (key == name) {
+				return counter;
+			}
+		}
+		return scopeCounters[OTHER_SCOPES_INDEX];
+	}
+
+	// Main thread only, see EndFrame
+	struct TrackerState {
+		uint64_t previousCounts[ALLOCATION_TRACKER_SCOPES] = {};
+		uint64_t previousBytes[ALLOCATION_TRACKER_SCOPES] = {};
+		int statsIndices[ALLOCATION_TRACKER_SCOPES];			// counter to stats, -1 until it first counts
+		uint64_t previousFreeCount = 0;
+		std::vector<AllocationScopeStats> scopeStats;
+		uint64_t frameCount = 0;
+		uint64_t frameBytes = 0;
+		uint64_t frameFreeCount = 0;
+
+		TrackerState() {
+			std::fill(std::begin(statsIndices), std::end(statsIndices), -1);
+		}
+	};
+
+	TrackerState& GetState() {
+		static TrackerState* state = new TrackerState();
+		return *state;
+	}
+}
+
+void AllocationTracker::RecordAllocation(size_t size) {
+	ScopeCounter& counter = GetCounter(currentScope ? currentScope : UNSCOPED_NAME);
+	counter.count.fetch_add(1, std::memory_order_relaxed);
+	counter.bytes.fetch_add(size, std::memory_order_relaxed);
+}
+
+void AllocationTracker::RecordFree() {
+	freeCount.fetch_add(1, std::memory_order_relaxed);
+}
+
+void AllocationTracker::EndFrame() {
+	TrackerState& state = GetState();
+	for (AllocationScopeStats& stats : state.scopeStats) {
+		stats.lastCount = 0;
+		stats.lastBytes = 0;
+	}
+
+	state.frameCount = 0;
+	state.frameBytes = 0;
+	for (size_t i = 0; i < ALLOCATION_TRACKER_SCOPES; i++) {
+		const uint64_t count = scopeCounters[i].count.load(std::memory_order_relaxed);
+		const uint64_t bytes = scopeCounters[i].bytes.load(std::memory_order_relaxed);
+		const uint64_t frameCount = count - state.previousCounts[i];
+		const uint64_t frameBytes = bytes - state.previousBytes[i];
+		state.previousCounts[i] = count;
+		state.previousBytes[i] = bytes;
+		if (frameCount == 0) {
+			continue;
+		}
+
+		// Literals with the same text share their stats, like the profiler's
+		if (state.statsIndices[i] < 0) {
+			const char* name = i == OTHER_SCOPES_INDEX ? OTHER_SCOPES_NAME : scopeCounters[i].name.load(std::memory_order_acquire);
+			auto stats = std::find_if(state.scopeStats.begin(), state.scopeStats.end(), [name](const AllocationScopeStats& stats) {
+				return std::strcmp(stats.name, name) == 0;
+			});
+			if (stats == state.scopeStats.end()) {
+				state.scopeStats.push_back(AllocationScopeStats{ name, 0, 0, 0, 0 });
+				stats = state.scopeStats.end() - 1;
+			}
+			state.statsIndices[i] = static_cast<int>(stats - state.scopeStats.begin());
+		}
+		AllocationScopeStats& stats = state.scopeStats[state.statsIndices[i]];
+		stats.lastCount += frameCount;
+		stats.lastBytes += frameBytes;
+		state.frameCount += frameCount;
+		state.frameBytes += frameBytes;
+	}
+
+	for (AllocationScopeStats& stats : state.scopeStats) {
+		stats.maxCount = std::max(stats.maxCount, stats.lastCount);
+		stats.framesWithAllocations += stats.lastCount > 0 ? 1 : 0;
+	}
+
+	const uint64_t frees = freeCount.load(std::memory_order_relaxed);
+	state.frameFreeCount = frees - state.previousFreeCount;
+	state.previousFreeCount = frees;
+}
+
+const std::vector<AllocationScopeStats>& AllocationTracker::GetScopeStats() {
+	return GetState().scopeStats;
+}
+
+uint64_t AllocationTracker::GetFrameAllocationCount() {
+	return GetState().frameCount;
+}
+
+uint64_t AllocationTracker::GetFrameAllocatedBytes() {
+	return GetState().frameBytes;
+}
+
+uint64_t AllocationTracker::GetFrameFreeCount() {
+	return GetState().frameFreeCount;
+}
+
+#if VAGAHO_TRACK_ALLOCATIONS
+
+namespace {
+
+	void* TrackedAllocate(std::size_t size) {
+		AllocationTracker::RecordAllocation(size);
+		return std::malloc(size == 0 ? 1 : size);
+	}
+
+	void* TrackedAllocateAligned(std::size_t size, std::align_val_t alignment) {
+		AllocationTracker::RecordAllocation(size);
+		const std::size_t alignmentBytes = static_cast<std::size_t>(alignment);
+#ifdef _WIN32
+		return _aligned_malloc(size == 0 ? 1 : size, alignmentBytes);
+#else
+		// aligned_alloc wants a multiple of the alignment
+		const std::size_t roundedSize = (std::max<std::size_t>(size, 1) + alignmentBytes - 1) / alignmentBytes * alignmentBytes;
+		return std::aligned_alloc(alignmentBytes, roundedSize);
+#endif
+	}
+
+	void TrackedFree(void* pointer) {
+		if (pointer) {
+			AllocationTracker::RecordFree();
+			std::free(pointer);
+		}
+	}
+
+	void TrackedFreeAligned(void* pointer) {
+		if (pointer) {
+			AllocationTracker::RecordFree();
+#ifdef _WIN32
+			_aligned_free(pointer);
+#else
+			std::free(pointer);
+#endif
+		}
+	}
+}
+
+void* operator new(std::size_t size) {
+	if (void* pointer = TrackedAllocate(size)) {
+		return pointer;
+	}
+	throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size) {
+	if (void* pointer = TrackedAllocate(size)) {
+		return pointer;
+	}
+	throw std::bad_alloc();
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+	return TrackedAllocate(size);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept {
+	return TrackedAllocate(size);
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment) {
+	if (void* pointer = TrackedAllocateAligned(size, alignment)) {
+		return pointer;
+	}
+	throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment) {
+	if (void* pointer = TrackedAllocateAligned(size, alignment)) {
+		return pointer;
+	}
+	throw std::bad_alloc();
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+	return TrackedAllocateAligned(size, alignment);
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+	return TrackedAllocateAligned(size, alignment);
+}
+
+void operator delete(void* pointer) noexcept { TrackedFree(pointer); }
+void operator delete[](void* pointer) noexcept { TrackedFree(pointer); }
+void operator delete(void* pointer, std::size_t) noexcept { TrackedFree(pointer); }
+void operator delete[](void* pointer, std::size_t) noexcept { TrackedFree(pointer); }
+void operator delete(void* pointer, const std::nothrow_t&) noexcept { TrackedFree(pointer); }
+void operator delete[](void* pointer, const std::nothrow_t&) noexcept { TrackedFree(pointer); }
+void operator delete(void* pointer, std::align_val_t) noexcept { TrackedFreeAligned(pointer); }
+void operator delete[](void* pointer, std::align_val_t) noexcept { TrackedFreeAligned(pointer); }
+void operator delete(void* pointer, std::size_t, std::align_val_t) noexcept { TrackedFreeAligned(pointer); }
+void operator delete[](void* pointer, std::size_t, std::align_val_t) noexcept { TrackedFreeAligned(pointer); }
+void operator delete(void* pointer, std::align_val_t, const std::nothrow_t&) noexcept { TrackedFreeAligned(pointer); }
+void operator delete[](void* pointer, std::align_val_t, const std::nothrow_t&) noexcept { TrackedFreeAligned(pointer); }
+
+#endif
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+////////////////////////////////////////////////////////////////////////////////
+/// ALLOCATION TRACKER
+////////////////////////////////////////////////////////////////////////////////
+/// Opt-in, build with VAGAHO_TRACK_ALLOCATIONS=1. The global operator new and
+/// delete are replaced and every allocation is counted against the innermost
+/// PROFILE_SCOPE of the allocating thread ("Unscoped" outside of any), so a
+/// system's allocations show under its scope. Profiler::EndFrame turns the
+/// counters into per frame stats, shown by the profiler overlay and in replay
+/// reports. The counters are lock free, loader threads are counted too.
+/// Memory that doesn't come from operator new (Lua's allocator, SDL, stb) is
+/// not seen.
+////////////////////////////////////////////////////////////////////////////////
+#ifndef VAGAHO_TRACK_ALLOCATIONS
+#define VAGAHO_TRACK_ALLOCATIONS 0
+#endif
+
+// Scope names counted apart, allocations of further scopes are summed as "Other scopes"
+const size_t ALLOCATION_TRACKER_SCOPES = 256;
+
+struct AllocationScopeStats {
+	const char* name;
+	uint64_t lastCount;				// allocations in the last frame
+	uint64_t lastBytes;
+	uint64_t maxCount;				// most allocations in one frame so far
+	uint64_t framesWithAllocations;
+};
+
+class AllocationTracker {
+private:
+	static inline thread_local const char* currentScope = nullptr;
+
+public:
+	static constexpr bool bIsEnabled() { return VAGAHO_TRACK_ALLOCATIONS != 0; }
+
+	// Called by ProfileScope, returns the scope to restore when it ends
+	static const char* EnterScope(const char* name) {
+		const char* parent = currentScope;
+		currentScope = name;
+		return parent;
+	}
+	static void LeaveScope(const char* parent) {
+		currentScope = parent;
+	}
+
+	// From operator new and delete, any thread
+	static void RecordAllocation(size_t size);
+	static void RecordFree();
+
+	// Called by Profiler::EndFrame on the main thread
+	static void EndFrame();
+
+	// Scopes that allocated at least once, main thread only
+	static const std::vector<AllocationScopeStats>& GetScopeStats();
+	static uint64_t GetFrameAllocationCount();
+	static uint64_t GetFrameAllocatedBytes();
+	static uint64_t GetFrameFreeCount();
+};
@@ -0,0 +1,317 @@
+#include "Profiler.h"
+
+#include <mutex>
+#include <fstream>
+#include <cstdio>
+#include <string_view>
+#include <unordered_map>
+#include <algorithm>
+
+namespace {
+
+	struct ProfilerState {
+		std::mutex threadsMutex;
+		std::vector<std::unique_ptr<ProfilerThreadBuffer>> threads;
+		std::vector<std::string> threadNames;		// by thread index, kept after the thread exits
+		uint64_t retiredDroppedCount = 0;
+
+		ProfileFrame lastFrame = {};
+		ProfileFrame currentFrame = {};
+		std::vector<double> frameTimes;
+		std::vector<double> sortedFrameTimes;		// reused by GetFrameTimePercentile
+
+		std::vector<ProfileScopeStats> scopeStats;
+		std::unordered_map<std::string_view, size_t> scopeIndices;		// by name, literals of the same text share their stats
+		std::vector<double> frameScopeMs;								// by scope index, this frame's totals
+		std::vector<uint32_t> frameScopeCalls;
+
+		std::ofstream traceFile;
+		std::string traceBuffer;						// written to the file in large blocks
+		std::vector<bool> tracedThreadNames;			// by thread index, its name event is in the trace
+		int64_t traceOrigin = 0;						// trace timestamps start at 0
+		bool bHasTraceEvents = false;
+
+		// Full size from the start, filling the history doesn't show up as allocations
+		ProfilerState() {
+			frameTimes.reserve(PROFILER_FRAME_HISTORY);
+		}
+	};
+
+	// Trace text is flushed to the file past this size
+	const size_t TRACE_FLUSH_BYTES = 256 * 1024;
+
+	// Never destroyed: threads can still end their scopes while the program exits
+	ProfilerState& GetState() {
+		static ProfilerState* state = new ProfilerState();
+		return *state;
+	}
+
+	// Tells EndFrame the buffer can go once the thread's last samples are drained
+	struct ThreadRetirement {
+		ProfilerThreadBuffer* buffer;
+		~ThreadRetirement() {
+			buffer->bIsRetired.store(true, std::memory_order_release);
+		}
+	};
+
+	void DrainBuffer(ProfilerThreadBuffer& buffer, std::vector<ProfileSample>& samples) {
+		const uint64_t readIndex = buffer.readIndex.load(std::memory_order_relaxed);
+		const uint64_t writeIndex = buffer.writeIndex.load(std::memory_order_acquire);
+		for (uint64_t i = readIndex; i < writeIndex; i++) {
+			samples.push_back(buffer.samples[i % PROFILER_THREAD_CAPACITY]);
+		}
+		buffer.readIndex.store(writeIndex, std::memory_order_release);
+	}
+
+	// Scope and thread names are engine strings, only quotes, backslashes and control characters need escaping
+	void AppendJsonString(std::string& out, const char* text) {
+		out += '"';
+		for (const char* c = text; *c != '\0'; c++) {
+			if (*c == '"' || *c == '\\') {
+				out += '\\';
+				out += *c;
+			}
+			else if (static_cast<unsigned char>(*c) < 0x20) {
+				out += ' ';
+			}
+			else {
+				out += *c;
+			}
+		}
+		out += '"';
+	}
+
+	void BeginTraceEvent(ProfilerState& state) {
+		state.traceBuffer += state.bHasTraceEvents ? ",\n" : "\n";
+		state.bHasTraceEvents = true;
+	}
+
+	// A complete ("X") event left open, the caller adds its args (or not) and closes it
+	void AppendTraceEvent(ProfilerState& state, const char* name, const char* category, int64_t start, int64_t end, uint32_t threadIndex) {
+		char numbers[128];
+		BeginTraceEvent(state);
+		state.traceBuffer += "{\"name\":";
+		AppendJsonString(state.traceBuffer, name);
+		std::snprintf(numbers, sizeof(numbers), ",\"cat\":\"%s\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":1,\"tid\":%u",
+			category, (start - state.traceOrigin) / 1e3, (end - start) / 1e3, threadIndex);
+		state.traceBuffer += numbers;
+	}
+
+	void AppendThreadName(ProfilerState& state, uint32_t threadIndex) {
+		if (threadIndex >= state.tracedThreadNames.size()) {
+			state.tracedThreadNames.resize(threadIndex + 1, false);
+		}
+		if (state.tracedThreadNames[threadIndex]) {
+			return;
+		}
+		state.tracedThreadNames[threadIndex] = true;
+
+		char numbers[64];
+		BeginTraceEvent(state);
+		std::snprintf(numbers, sizeof(numbers), "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":", threadIndex);
+		state.traceBuffer += numbers;
+		AppendJsonString(state.traceBuffer, state.threadNames[threadIndex].c_str());
+		state.traceBuffer += "}}";
+	}
+
+	void FlushTrace(ProfilerState& state) {
+		state.traceFile.write(state.traceBuffer.data(), static_cast<std::streamsize>(state.traceBuffer.size()));
+		state.traceFile.flush();
+		state.traceBuffer.clear();
+	}
+
+	// The frame itself on the main thread's track, its scopes nest under it
+	void TraceFrame(ProfilerState& state, const ProfileFrame& frame, uint32_t mainThreadIndex) {
+		{
+			std::lock_guard<std::mutex> lock(state.threadsMutex);
+			AppendThreadName(state, mainThreadIndex);
+			for (const ProfileSample& sample : frame.samples) {
+				AppendThreadName(state, sample.threadIndex);
+			}
+		}
+
+		AppendTraceEvent(state, "Frame", "frame", frame.start, frame.end, mainThreadIndex);
+		state.traceBuffer += ",\"args\":{\"index\":" + std::to_string(frame.index) + "}}";
+		for (const ProfileSample& sample : frame.samples) {
+			AppendTraceEvent(state, sample.name, "engine", sample.start, sample.end, sample.threadIndex);
+			state.traceBuffer += '}';
+		}
+		if (state.traceBuffer.size() >= TRACE_FLUSH_BYTES) {
+			FlushTrace(state);
+		}
+	}
+
+	size_t GetScopeIndex(ProfilerState& state, const char* name) {
+		auto scopeIndex = state.scopeIndices.find(name);
+		if (scopeIndex != state.scopeIndices.end()) {
+			return scopeIndex->second;
+		}
+		state.scopeStats.push_back(ProfileScopeStats{ name, 0.0, 0.0, 0.0, 0 });
+		state.frameScopeMs.push_back(0.0);
+		state.frameScopeCalls.push_back(0);
+		state.scopeIndices.emplace(name, state.scopeStats.size() - 1);
+		return state.scopeStats.size() - 1;
+	}
+}
+
+ProfilerThreadBuffer* Profiler::RegisterThread() {
+	ProfilerState& state = GetState();
+	auto buffer = std::make_unique<ProfilerThreadBuffer>();
+	ProfilerThreadBuffer* bufferPtr = buffer.get();
+	{
+		std::lock_guard<std::mutex> lock(state.threadsMutex);
+		bufferPtr->threadIndex = static_cast<uint32_t>(state.threadNames.size());
+		bufferPtr->threadName = "Thread " + std::to_string(bufferPtr->threadIndex);
+		state.threadNames.push_back(bufferPtr->threadName);
+		state.threads.push_back(std::move(buffer));
+	}
+	thread_local ThreadRetirement retirement { bufferPtr };
+	return bufferPtr;
+}
+
+void Profiler::SetThreadName(const std::string& name) {
+	ProfilerThreadBuffer& buffer = GetThreadBuffer();
+	ProfilerState& state = GetState();
+	std::lock_guard<std::mutex> lock(state.threadsMutex);
+	buffer.threadName = name;
+	state.threadNames[buffer.threadIndex] = name;
+}
+
+void Profiler::RecordSample(const char* name, int64_t start, int64_t end) {
+	ProfilerThreadBuffer& buffer = GetThreadBuffer();
+	buffer.Push(ProfileSample{ name, start, end, buffer.depth, buffer.threadIndex });
+}
+
+void Profiler::BeginFrame() {
+	ProfilerState& state = GetState();
+	state.currentFrame.start = Now();
+}
+
+void Profiler::EndFrame() {
+	ProfilerState& state = GetState();
+	ProfileFrame& frame = state.currentFrame;
+	frame.end = Now();
+	frame.samples.clear();
+
+	{
+		std::lock_guard<std::mutex> lock(state.threadsMutex);
+		for (size_t i = 0; i < state.threads.size();) {
+			ProfilerThreadBuffer& buffer = *state.threads[i];
+			// Checked before draining, so a retired thread's last samples are drained too
+			const bool bIsRetired = buffer.bIsRetired.load(std::memory_order_acquire);
+			DrainBuffer(buffer, frame.samples);
+			if (bIsRetired) {
+				state.retiredDroppedCount += buffer.droppedCount.load(std::memory_order_relaxed);
+				state.threads.erase(state.threads.begin() + i);
+				continue;
+			}
+			i++;
+		}
+	}
+
+	std::sort(frame.samples.begin(), frame.samples.end(), [](const ProfileSample& a, const ProfileSample& b) {
+		return a.threadIndex != b.threadIndex ? a.threadIndex < b.threadIndex : a.start < b.start;
+	});
+
+	if (state.traceFile.is_open()) {
+		TraceFrame(state, frame, GetThreadBuffer().threadIndex);
+	}
+
+	// Scope totals of the frame, then the rolling averages of every known scope (absent ones decay)
+	std::fill(state.frameScopeMs.begin(), state.frameScopeMs.end(), 0.0);
+	std::fill(state.frameScopeCalls.begin(), state.frameScopeCalls.end(), 0);
+	for (const ProfileSample& sample : frame.samples) {
+		const size_t scopeIndex = GetScopeIndex(state, sample.name);
+		state.frameScopeMs[scopeIndex] += (sample.end - sample.start) / 1e6;
+		state.frameScopeCalls[scopeIndex]++;
+	}
+	for (size_t i = 0; i < state.scopeStats.size(); i++) {
+		ProfileScopeStats& stats = state.scopeStats[i];
+		stats.lastMs = state.frameScopeMs[i];
+		stats.lastCallCount = state.frameScopeCalls[i];
+		stats.averageMs += (stats.lastMs - stats.averageMs) * PROFILER_AVERAGE_WEIGHT;
+		stats.maxMs = std::max(stats.maxMs, stats.lastMs);
+	}
+
+	if (state.frameTimes.size() == PROFILER_FRAME_HISTORY) {
+		state.frameTimes.erase(state.frameTimes.begin());
+	}
+	state.frameTimes.push_back((frame.end - frame.start) / 1e6);
+
+	// The finished frame becomes the last frame, the other one is reused (with its capacity) for the next
+	std::swap(state.lastFrame, state.currentFrame);
+	state.currentFrame.index = state.lastFrame.index + 1;
+	state.currentFrame.start = state.lastFrame.end;
+
+	if (AllocationTracker::bIsEnabled()) {
+		AllocationTracker::EndFrame();
+	}
+}
+
+const ProfileFrame& Profiler::GetLastFrame() {
+	return GetState().lastFrame;
+}
+
+const std::vector<double>& Profiler::GetFrameTimes() {
+	return GetState().frameTimes;
+}
+
+double Profiler::GetFrameTimePercentile(double percentile) {
+	ProfilerState& state = GetState();
+	if (state.frameTimes.empty()) {
+		return 0.0;
+	}
+	state.sortedFrameTimes = state.frameTimes;
+	const size_t rank = std::min(state.sortedFrameTimes.size() - 1, static_cast<size_t>(percentile * state.sortedFrameTimes.size()));
+	std::nth_element(state.sortedFrameTimes.begin(), state.sortedFrameTimes.begin() + rank, state.sortedFrameTimes.end());
+	return state.sortedFrameTimes[rank];
+}
+
+const std::vector<ProfileScopeStats>& Profiler::GetScopeStats() {
+	return GetState().scopeStats;
+}
+
+std::string Profiler::GetThreadName(uint32_t threadIndex) {
+	ProfilerState& state = GetState();
+	std::lock_guard<std::mutex> lock(state.threadsMutex);
+	return threadIndex < state.threadNames.size() ? state.threadNames[threadIndex] : std::string();
+}
+
+uint64_t Profiler::GetDroppedCount() {
+	ProfilerState& state = GetState();
+	std::lock_guard<std::mutex> lock(state.threadsMutex);
+	uint64_t droppedCount = state.retiredDroppedCount;
+	for (const auto& buffer : state.threads) {
+		droppedCount += buffer->droppedCount.load(std::memory_order_relaxed);
+	}
+	return droppedCount;
+}
+
+bool Profiler::StartTrace(const std::string& filepath) {
+	ProfilerState& state = GetState();
+	StopTrace();
+	state.traceFile.open(filepath, std::ios::binary | std::ios::trunc);
+	if (!state.traceFile) {
+		return false;
+	}
+	state.traceBuffer = "[";
+	state.tracedThreadNames.clear();
+	state.traceOrigin = Now();
+	state.bHasTraceEvents = false;
+	FlushTrace(state);
+	return true;
+}
+
+void Profiler::StopTrace() {
+	ProfilerState& state = GetState();
+	if (!state.traceFile.is_open()) {
+		return;
+	}
+	state.traceBuffer += "\n]\n";
+	FlushTrace(state);
+	state.traceFile.close();
+}
+
+bool Profiler::bIsTracing() {
+	return GetState().traceFile.is_open();
+}
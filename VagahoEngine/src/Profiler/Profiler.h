@@ -0,0 +1,166 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <cstdint>
+#include <cstddef>
+
+#include "AllocationTracker.h"
+
+////////////////////////////////////////////////////////////////////////////////
+/// PROFILE MACROS
+////////////////////////////////////////////////////////////////////////////////
+/// PROFILE_SCOPE("Name") times the rest of the enclosing block. The name must
+/// be a string literal, only the pointer is kept. Scopes nest, the depth is
+/// tracked per thread. Building with VAGAHO_PROFILING=0 removes them.
+////////////////////////////////////////////////////////////////////////////////
+#ifndef VAGAHO_PROFILING
+#define VAGAHO_PROFILING 1
+#endif
+
+#if VAGAHO_PROFILING
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+#define PROFILE_SCOPE(name) ProfileScope PROFILE_CONCAT(profileScope, __LINE__)(name)
+#else
+#define PROFILE_SCOPE(name) ((void)0)
+#endif
+
+// Samples each thread can have waiting for the next EndFrame, the rest is dropped and counted
+const size_t PROFILER_THREAD_CAPACITY = 8192;
+// Frames kept for the frame time graph and percentiles
+const size_t PROFILER_FRAME_HISTORY = 300;
+// Weight of the last frame in the rolling scope averages
+const double PROFILER_AVERAGE_WEIGHT = 0.05;
+
+struct ProfileSample {
+	const char* name;
+	int64_t start;				// steady_clock ns
+	int64_t end;
+	uint32_t depth;				// 0 for the outermost scope of its thread
+	uint32_t threadIndex;
+};
+
+// One scope name over all threads
+struct ProfileScopeStats {
+	const char* name;
+	double averageMs;			// rolling, per frame
+	double lastMs;				// total time in the last frame
+	double maxMs;				// longest frame total so far
+	uint32_t lastCallCount;
+};
+
+struct ProfileFrame {
+	uint64_t index;
+	int64_t start;
+	int64_t end;
+	std::vector<ProfileSample> samples;		// ended during the frame, by thread then start time
+};
+
+// Written by its thread only, drained by EndFrame
+struct ProfilerThreadBuffer {
+	std::unique_ptr<ProfileSample[]> samples { new ProfileSample[PROFILER_THREAD_CAPACITY] };
+	std::atomic<uint64_t> writeIndex { 0 };
+	std::atomic<uint64_t> readIndex { 0 };
+	std::atomic<uint64_t> droppedCount { 0 };
+	std::atomic<bool> bIsRetired { false };		// its thread has exited
+	uint32_t depth = 0;
+	uint32_t threadIndex = 0;
+	std::string threadName;
+
+	void Push(const ProfileSample& sample) {
+		const uint64_t write = writeIndex.load(std::memory_order_relaxed);
+		if (write - readIndex.load(std::memory_order_acquire) >= PROFILER_THREAD_CAPACITY) {
+			droppedCount.fetch_add(1, std::memory_order_relaxed);
+			return;
+		}
+		samples[write % PROFILER_THREAD_CAPACITY] = sample;
+		writeIndex.store(write + 1, std::memory_order_release);
+	}
+};
+
+////////////////////////////////////////////////////////////////////////////////
+/// PROFILER
+////////////////////////////////////////////////////////////////////////////////
+/// Every thread records its scopes into its own ring buffer, no lock or shared
+/// cache line on the way. The main thread brackets each frame with BeginFrame
+/// and EndFrame. EndFrame drains the buffers of all threads into the frame
+/// record (see GetLastFrame) and updates the per scope stats and the frame
+/// time history. Buffers of exited threads are released once drained.
+/// Frames, stats and history are only for the main thread to read.
+///
+/// While a trace is running (StartTrace), EndFrame also appends the frame and
+/// its samples to a Chrome Trace Event file (JSON array format), which opens
+/// in Perfetto or chrome://tracing. A trace cut short by a crash still loads,
+/// the closing bracket is optional in that format.
+////////////////////////////////////////////////////////////////////////////////
+class Profiler {
+private:
+	static ProfilerThreadBuffer* RegisterThread();
+
+public:
+	static int64_t Now() {
+		return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+	}
+
+	static ProfilerThreadBuffer& GetThreadBuffer() {
+		thread_local ProfilerThreadBuffer* buffer = RegisterThread();
+		return *buffer;
+	}
+
+	// Shown next to the thread's samples, "Thread <index>" until set
+	static void SetThreadName(const std::string& name);
+	// For spans only worth keeping once they ended (a batch that turned out empty isn't)
+	static void RecordSample(const char* name, int64_t start, int64_t end);
+
+	static void BeginFrame();
+	static void EndFrame();
+
+	static const ProfileFrame& GetLastFrame();
+	// Oldest first, in ms
+	static const std::vector<double>& GetFrameTimes();
+	// percentile in [0, 1] over the frame history
+	static double GetFrameTimePercentile(double percentile);
+	static const std::vector<ProfileScopeStats>& GetScopeStats();
+	static std::string GetThreadName(uint32_t threadIndex);
+	static uint64_t GetDroppedCount();
+
+	static bool StartTrace(const std::string& filepath);
+	static void StopTrace();
+	static bool bIsTracing();
+};
+
+class ProfileScope {
+private:
+	ProfilerThreadBuffer& buffer;
+	const char* name;
+	int64_t start;
+	uint32_t depth;
+#if VAGAHO_TRACK_ALLOCATIONS
+	const char* parentAllocationScope;
+#endif
+
+public:
+	explicit ProfileScope(const char* name) : buffer(Profiler::GetThreadBuffer()), name(name) {
+#if VAGAHO_TRACK_ALLOCATIONS
+		parentAllocationScope = AllocationTracker::EnterScope(name);
+#endif
+		depth = buffer.depth++;
+		start = Profiler::Now();
+	}
+
+	~ProfileScope() {
+		const int64_t end = Profiler::Now();
+		buffer.depth--;
+		buffer.Push(ProfileSample{ name, start, end, depth, buffer.threadIndex });
+#if VAGAHO_TRACK_ALLOCATIONS
+		AllocationTracker::LeaveScope(parentAllocationScope);
+#endif
+	}
+
+	ProfileScope(const ProfileScope&) = delete;
+	ProfileScope& operator =(const ProfileScope&) = delete;
+};
@@ -0,0 +1,183 @@
+#include "ProfilerOverlay.h"
+
+#include "../Utils/HashUtils.h"
+
+#include <imgui/imgui.h>
+
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+	const float FLAME_ROW_HEIGHT = 18.0f;
+	const float FLAME_LABEL_HEIGHT = 16.0f;
+	// Narrower blocks are drawn without their name
+	const float FLAME_MIN_LABEL_WIDTH = 40.0f;
+
+	// Same scope, same color, from frame to frame
+	ImU32 GetScopeColor(const char* name) {
+		const uint64_t hash = Fnv1a64(name, std::strlen(name));
+		const int r = 90 + static_cast<int>(hash & 0x7F);
+		const int g = 90 + static_cast<int>((hash >> 8) & 0x7F);
+		const int b = 60 + static_cast<int>((hash >> 16) & 0x5F);
+		return IM_COL32(r, g, b, 255);
+	}
+
+	double ToMs(int64_t nanoseconds) {
+		return nanoseconds / 1e6;
+	}
+}
+
+void ProfilerOverlay::Draw() {
+	ImGui::SetNextWindowPos(ImVec2(10.0f, 10.0f), ImGuiCond_FirstUseEver);
+	ImGui::SetNextWindowSize(ImVec2(720.0f, 520.0f), ImGuiCond_FirstUseEver);
+	ImGui::SetNextWindowBgAlpha(0.85f);
+	if (!ImGui::Begin("Profiler")) {
+		ImGui::End();
+		return;
+	}
+
+	if (ImGui::Checkbox("Pause", &bIsPaused) && bIsPaused) {
+		pausedFrame = Profiler::GetLastFrame();
+	}
+	ImGui::SameLine();
+	ImGui::Text("Dropped samples: %llu", static_cast<unsigned long long>(Profiler::GetDroppedCount()));
+
+	DrawFrameTimes();
+	ImGui::Separator();
+	DrawFlameGraph(bIsPaused ? pausedFrame : Profiler::GetLastFrame());
+	ImGui::Separator();
+	DrawScopeStats();
+	if (AllocationTracker::bIsEnabled()) {
+		ImGui::Separator();
+		DrawAllocations();
+	}
+	ImGui::End();
+}
+
+void ProfilerOverlay::DrawFrameTimes() {
+	const std::vector<double>& history = Profiler::GetFrameTimes();
+	frameTimes.assign(history.begin(), history.end());
+	const float lastMs = frameTimes.empty() ? 0.0f : frameTimes.back();
+
+	ImGui::Text("Frame %.2f ms   p50 %.2f   p90 %.2f   p99 %.2f   max %.2f",
+		lastMs,
+		Profiler::GetFrameTimePercentile(0.50),
+		Profiler::GetFrameTimePercentile(0.90),
+		Profiler::GetFrameTimePercentile(0.99),
+		Profiler::GetFrameTimePercentile(1.00));
+	ImGui::PlotLines("##FrameTimes", frameTimes.data(), static_cast<int>(frameTimes.size()), 0, nullptr, 0.0f, 50.0f, ImVec2(ImGui::GetContentRegionAvail().x, 60.0f));
+}
+
+void ProfilerOverlay::DrawFlameGraph(const ProfileFrame& frame) {
+	const int64_t frameDuration = std::max<int64_t>(1, frame.end - frame.start);
+	ImGui::Text("Frame %llu: %.2f ms", static_cast<unsigned long long>(frame.index), ToMs(frameDuration));
+
+	ImDrawList* drawList = ImGui::GetWindowDrawList();
+	const float width = ImGui::GetContentRegionAvail().x;
+	const float pixelsPerNs = width / static_cast<float>(frameDuration);
+	const ImVec2 mousePosition = ImGui::GetMousePos();
+	const ProfileSample* hoveredSample = nullptr;
+
+	// Samples are sorted by thread, each thread gets a lane as deep as its deepest scope
+	for (size_t laneStart = 0; laneStart < frame.samples.size();) {
+		const uint32_t threadIndex = frame.samples[laneStart].threadIndex;
+		size_t laneEnd = laneStart;
+		uint32_t maxDepth = 0;
+		while (laneEnd < frame.samples.size() && frame.samples[laneEnd].threadIndex == threadIndex) {
+			maxDepth = std::max(maxDepth, frame.samples[laneEnd].depth);
+			laneEnd++;
+		}
+
+		ImGui::TextUnformatted(Profiler::GetThreadName(threadIndex).c_str());
+		const ImVec2 origin = ImGui::GetCursorScreenPos();
+		const float laneHeight = (maxDepth + 1) * FLAME_ROW_HEIGHT;
+		ImGui::PushID(static_cast<int>(threadIndex));
+		ImGui::InvisibleButton("##Lane", ImVec2(width, laneHeight));
+		ImGui::PopID();
+		drawList->PushClipRect(origin, ImVec2(origin.x + width, origin.y + laneHeight), true);
+
+		for (size_t i = laneStart; i < laneEnd; i++) {
+			const ProfileSample& sample = frame.samples[i];
+			// Worker scopes can start before the frame, they are cut at its start
+			const float x0 = origin.x + std::max(0.0f, (sample.start - frame.start) * pixelsPerNs);
+			const float x1 = std::max(x0 + 1.0f, origin.x + std::min(width, (sample.end - frame.start) * pixelsPerNs));
+			const float y0 = origin.y + sample.depth * FLAME_ROW_HEIGHT;
+			const ImVec2 min(x0, y0);
+			const ImVec2 max(x1, y0 + FLAME_ROW_HEIGHT - 1.0f);
+			drawList->AddRectFilled(min, max, GetScopeColor(sample.name));
+			if (x1 - x0 >= FLAME_MIN_LABEL_WIDTH) {
+				drawList->PushClipRect(min, max, true);
+				drawList->AddText(ImVec2(x0 + 3.0f, y0 + 2.0f), IM_COL32(0, 0, 0, 255), sample.name);
+				drawList->PopClipRect();
+			}
+			if (mousePosition.x >= min.x && mousePosition.x < max.x && mousePosition.y >= min.y && mousePosition.y < max.y) {
+				hoveredSample = &sample;
+			}
+		}
+
+		drawList->PopClipRect();
+		laneStart = laneEnd;
+	}
+
+	if (frame.samples.empty()) {
+		ImGui::Dummy(ImVec2(width, FLAME_LABEL_HEIGHT));
+	}
+	if (hoveredSample) {
+		ImGui::BeginTooltip();
+		ImGui::Text("%s", hoveredSample->name);
+		ImGui::Text("%.3f ms", ToMs(hoveredSample->end - hoveredSample->start));
+		ImGui::EndTooltip();
+	}
+}
+
+void ProfilerOverlay::DrawScopeStats() {
+	sortedStats = Profiler::GetScopeStats();
+	std::sort(sortedStats.begin(), sortedStats.end(), [](const ProfileScopeStats& a, const ProfileScopeStats& b) {
+		return a.averageMs > b.averageMs;
+	});
+
+	ImGui::Columns(5, "ScopeStats");
+	ImGui::Text("Scope"); ImGui::NextColumn();
+	ImGui::Text("Avg ms"); ImGui::NextColumn();
+	ImGui::Text("Last ms"); ImGui::NextColumn();
+	ImGui::Text("Max ms"); ImGui::NextColumn();
+	ImGui::Text("Calls"); ImGui::NextColumn();
+	ImGui::Separator();
+	for (const ProfileScopeStats& stats : sortedStats) {
+		ImGui::TextUnformatted(stats.name); ImGui::NextColumn();
+		ImGui::Text("%.3f", stats.averageMs); ImGui::NextColumn();
+		ImGui::Text("%.3f", stats.lastMs); ImGui::NextColumn();
+		ImGui::Text("%.3f", stats.maxMs); ImGui::NextColumn();
+		ImGui::Text("%u", stats.lastCallCount); ImGui::NextColumn();
+	}
+	ImGui::Columns(1);
+}
+
+void ProfilerOverlay::DrawAllocations() {
+	ImGui::Text("Allocations %llu (%llu bytes)   frees %llu",
+		static_cast<unsigned long long>(AllocationTracker::GetFrameAllocationCount()),
+		static_cast<unsigned long long>(AllocationTracker::GetFrameAllocatedBytes()),
+		static_cast<unsigned long long>(AllocationTracker::GetFrameFreeCount()));
+
+	sortedAllocations = AllocationTracker::GetScopeStats();
+	std::sort(sortedAllocations.begin(), sortedAllocations.end(), [](const AllocationScopeStats& a, const AllocationScopeStats& b) {
+		return a.lastCount != b.lastCount ? a.lastCount > b.lastCount : a.maxCount > b.maxCount;
+	});
+
+	ImGui::Columns(5, "AllocationStats");
+	ImGui::Text("Scope"); ImGui::NextColumn();
+	ImGui::Text("Allocs"); ImGui::NextColumn();
+	ImGui::Text("Bytes"); ImGui::NextColumn();
+	ImGui::Text("Max allocs"); ImGui::NextColumn();
+	ImGui::Text("Frames"); ImGui::NextColumn();
+	ImGui::Separator();
+	for (const AllocationScopeStats& stats : sortedAllocations) {
+		ImGui::TextUnformatted(stats.name); ImGui::NextColumn();
+		ImGui::Text("%llu", static_cast<unsigned long long>(stats.lastCount)); ImGui::NextColumn();
+		ImGui::Text("%llu", static_cast<unsigned long long>(stats.lastBytes)); ImGui::NextColumn();
+		ImGui::Text("%llu", static_cast<unsigned long long>(stats.maxCount)); ImGui::NextColumn();
+		ImGui::Text("%llu", static_cast<unsigned long long>(stats.framesWithAllocations)); ImGui::NextColumn();
+	}
+	ImGui::Columns(1);
+}
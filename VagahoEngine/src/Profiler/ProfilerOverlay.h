@@ -0,0 +1,33 @@
+#pragma once
+
+#include "Profiler.h"
+
+#include <vector>
+#include <cstdint>
+
+////////////////////////////////////////////////////////////////////////////////
+/// PROFILER OVERLAY
+////////////////////////////////////////////////////////////////////////////////
+/// ImGui window over the game: frame time graph with percentiles, a flame
+/// graph of the last frame (one lane per thread, nested scopes below their
+/// parent) and the rolling average of every scope, plus the allocations of
+/// every scope when the allocation tracker is built in. Pausing keeps the
+/// current frame on screen to hover it. Call Draw between ImGui::NewFrame and
+/// ImGui::Render.
+////////////////////////////////////////////////////////////////////////////////
+class ProfilerOverlay {
+private:
+	bool bIsPaused = false;
+	ProfileFrame pausedFrame;
+	std::vector<float> frameTimes;			// the history as floats for ImGui::PlotLines
+	std::vector<ProfileScopeStats> sortedStats;
+	std::vector<AllocationScopeStats> sortedAllocations;
+
+	void DrawFrameTimes();
+	void DrawFlameGraph(const ProfileFrame& frame);
+	void DrawScopeStats();
+	void DrawAllocations();
+
+public:
+	void Draw();
+};
@@ -0,0 +1,74 @@
+#include "InputRecording.h"
+
+#include "../Logger/Logger.h"
+#include "../Utils/MappedFile.h"
+
+#include <cstring>
+#include <fstream>
+
+bool InputRecordingFile::Parse(const uint8_t* data, size_t size, InputRecording& recording) {
+	if (size < sizeof(InputRecordingHeader)) {
+		LOG_ERROR("Input recording is truncated");
+		return false;
+	}
+
+	InputRecordingHeader header;
+	std::memcpy(&header, data, sizeof(InputRecordingHeader));
+	if (std::memcmp(header.magic, INPUT_RECORDING_MAGIC, sizeof(INPUT_RECORDING_MAGIC)) != 0 || header.version != INPUT_RECORDING_VERSION) {
+		LOG_ERROR("Not a version {} input recording", INPUT_RECORDING_VERSION);
+		return false;
+	}
+
+	const uint64_t payloadSize = static_cast<uint64_t>(header.tickCount) * sizeof(double) + static_cast<uint64_t>(header.keyEventCount) * sizeof(RecordedKeyEvent);
+	if (payloadSize > size - sizeof(InputRecordingHeader)) {
+		LOG_ERROR("Input recording is truncated");
+		return false;
+	}
+
+	recording.level = header.level;
+	recording.seed = header.seed;
+	recording.deltaTimes.resize(header.tickCount);
+	recording.keyEvents.resize(header.keyEventCount);
+	const uint8_t* cursor = data + sizeof(InputRecordingHeader);
+	std::memcpy(recording.deltaTimes.data(), cursor, recording.deltaTimes.size() * sizeof(double));
+	cursor += recording.deltaTimes.size() * sizeof(double);
+	std::memcpy(recording.keyEvents.data(), cursor, recording.keyEvents.size() * sizeof(RecordedKeyEvent));
+
+	// The replay walks the events along with the ticks
+	for (size_t i = 0; i < recording.keyEvents.size(); i++) {
+		if (recording.keyEvents[i].tick >= header.tickCount || (i > 0 && recording.keyEvents[i].tick < recording.keyEvents[i - 1].tick)) {
+			LOG_ERROR("Input recording has a key event out of order at tick {}", recording.keyEvents[i].tick);
+			return false;
+		}
+	}
+	return true;
+}
+
+bool InputRecordingFile::Load(const std::string& filepath, InputRecording& recording) {
+	MappedFile file;
+	if (!file.Open(filepath)) {
+		LOG_ERROR("Can't open input recording {}", filepath);
+		return false;
+	}
+	return Parse(file.GetData(), file.GetSize(), recording);
+}
+
+bool InputRecordingFile::Save(const std::string& filepath, const InputRecording& recording) {
+	InputRecordingHeader header;
+	std::memcpy(header.magic, INPUT_RECORDING_MAGIC, sizeof(INPUT_RECORDING_MAGIC));
+	header.version			= INPUT_RECORDING_VERSION;
+	header.level			= recording.level;
+	header.seed				= recording.seed;
+	header.tickCount		= recording.GetTickCount();
+	header.keyEventCount	= static_cast<uint32_t>(recording.keyEvents.size());
+
+	std::ofstream file(filepath, std::ios::binary | std::ios::trunc);
+	file.write(reinterpret_cast<const char*>(&header), sizeof(InputRecordingHeader));
+	file.write(reinterpret_cast<const char*>(recording.deltaTimes.data()), static_cast<std::streamsize>(recording.deltaTimes.size() * sizeof(double)));
+	file.write(reinterpret_cast<const char*>(recording.keyEvents.data()), static_cast<std::streamsize>(recording.keyEvents.size() * sizeof(RecordedKeyEvent)));
+	if (!file) {
+		LOG_ERROR("Can't write input recording {}", filepath);
+		return false;
+	}
+	return true;
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+////////////////////////////////////////////////////////////////////////////////
+/// INPUT RECORDING (.vrec)
+////////////////////////////////////////////////////////////////////////////////
+/// Everything a session depends on from outside: the scenario (level and Lua
+/// random seed), the delta time of every tick and the keyboard events with the
+/// tick they were handled on. Replaying it feeds the same inputs to the same
+/// code, see Game::Replay.
+///
+/// Layout (little-endian):
+///   InputRecordingHeader
+///   double[tickCount]					- delta time of each tick, in seconds
+///   RecordedKeyEvent[keyEventCount]		- by tick, in the order SDL delivered them
+////////////////////////////////////////////////////////////////////////////////
+const char		INPUT_RECORDING_MAGIC[4]	= { 'V', 'R', 'E', 'C' };
+const uint32_t	INPUT_RECORDING_VERSION		= 1;
+
+struct InputRecordingHeader {
+	char		magic[4];
+	uint32_t	version;
+	uint32_t	level;
+	uint32_t	seed;
+	uint32_t	tickCount;
+	uint32_t	keyEventCount;
+};
+
+// SDL_KEYDOWN or SDL_KEYUP, enough of SDL_KeyboardEvent to push it back in the queue
+struct RecordedKeyEvent {
+	uint32_t	tick;
+	uint16_t	type;
+	uint8_t		bIsRepeat;
+	uint8_t		reserved;
+	int32_t		symbol;			// SDL_Keycode
+	uint16_t	scancode;
+	uint16_t	modifiers;
+};
+
+static_assert(sizeof(InputRecordingHeader) == 24, "InputRecordingHeader layout is part of the file format");
+static_assert(sizeof(RecordedKeyEvent) == 16, "RecordedKeyEvent layout is part of the file format");
+
+struct InputRecording {
+	uint32_t level = 1;
+	uint32_t seed = 0;
+	std::vector<double> deltaTimes;
+	std::vector<RecordedKeyEvent> keyEvents;
+
+	uint32_t GetTickCount() const { return static_cast<uint32_t>(deltaTimes.size()); }
+};
+
+class InputRecordingFile {
+public:
+	static bool Parse(const uint8_t* data, size_t size, InputRecording& recording);
+	static bool Load(const std::string& filepath, InputRecording& recording);
+	static bool Save(const std::string& filepath, const InputRecording& recording);
+};
@@ -0,0 +1,260 @@
+#include "ReplayReport.h"
+
+#include "../ECS/ECS.h"
+#include "../Logger/Logger.h"
+#include "../Profiler/Profiler.h"
+#include "../Profiler/AllocationTracker.h"
+#include "../Utils/HashUtils.h"
+#include "../Components/TransformComponent.h"
+#include "../Components/RigidbodyComponent.h"
+#include "../Components/SpriteComponent.h"
+#include "../Components/AnimationComponent.h"
+#include "../Components/TilemapComponent.h"
+#include "../Components/WorldRegionComponent.h"
+
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <cstdlib>
+#include <cstring>
+
+namespace {
+
+	// Value of "key": in a line written by WriteJson
+	bool ReadJsonField(const std::string& line, const char* key, std::string& value) {
+		const std::string pattern = std::string("\"") + key + "\": ";
+		const size_t start = line.find(pattern);
+		if (start == std::string::npos) {
+			return false;
+		}
+		size_t valueStart = start + pattern.size();
+		size_t valueEnd;
+		if (valueStart < line.size() && line[valueStart] == '"') {
+			valueStart++;
+			valueEnd = line.find('"', valueStart);
+		}
+		else {
+			valueEnd = line.find_first_of(",}", valueStart);
+		}
+		if (valueEnd == std::string::npos) {
+			return false;
+		}
+		value = line.substr(valueStart, valueEnd - valueStart);
+		return true;
+	}
+
+	template <typename T>
+	uint64_t HashValue(const T& value, uint64_t hash) {
+		return Fnv1a64(&value, sizeof(T), hash);
+	}
+}
+
+size_t ReplayReport::FindOrAddScope(const char* name) {
+	for (size_t i = 0; i < scopes.size(); i++) {
+		if (scopes[i].name == name) {
+			return i;
+		}
+	}
+	scopes.push_back(ReplayScopeTiming{ name, 0.0, 0.0, 0, 0, 0 });
+	return scopes.size() - 1;
+}
+
+void ReplayReport::AddFrame() {
+	const std::vector<ProfileScopeStats>& stats = Profiler::GetScopeStats();
+	while (profilerScopeIndices.size() < stats.size()) {
+		profilerScopeIndices.push_back(FindOrAddScope(stats[profilerScopeIndices.size()].name));
+	}
+	for (size_t i = 0; i < stats.size(); i++) {
+		ReplayScopeTiming& timing = scopes[profilerScopeIndices[i]];
+		timing.totalMs += stats[i].lastMs;
+		timing.maxMs = std::max(timing.maxMs, stats[i].lastMs);
+		timing.callCount += stats[i].lastCallCount;
+	}
+
+	if (AllocationTracker::bIsEnabled()) {
+		for (const AllocationScopeStats& allocations : AllocationTracker::GetScopeStats()) {
+			if (allocations.lastCount > 0) {
+				ReplayScopeTiming& timing = scopes[FindOrAddScope(allocations.name)];
+				timing.allocationCount += allocations.lastCount;
+				timing.allocatedBytes += allocations.lastBytes;
+			}
+		}
+		allocationCount += AllocationTracker::GetFrameAllocationCount();
+	}
+	tickCount++;
+}
+
+void ReplayReport::Finish(double simulationMs, uint64_t worldHash) {
+	this->simulationMs = simulationMs;
+	this->worldHash = worldHash;
+}
+
+std::vector<ReplayScopeTiming> ReplayReport::GetScopeTimings() const {
+	std::vector<ReplayScopeTiming> timings;
+	for (const ReplayScopeTiming& timing : scopes) {
+		if (timing.callCount > 0 || timing.allocationCount > 0) {
+			timings.push_back(timing);
+		}
+	}
+	std::sort(timings.begin(), timings.end(), [](const ReplayScopeTiming& a, const ReplayScopeTiming& b) {
+		return a.totalMs > b.totalMs;
+	});
+	return timings;
+}
+
+void ReplayReport::Print() const {
+	LOG_INFO("Replayed {} ticks in {:.2f} ms ({:.3f} ms per tick), world hash {:x}",
+		tickCount, simulationMs, tickCount > 0 ? simulationMs / tickCount : 0.0, worldHash);
+	if (AllocationTracker::bIsEnabled()) {
+		LOG_INFO("{} allocations, {:.2f} per tick", allocationCount, tickCount > 0 ? static_cast<double>(allocationCount) / tickCount : 0.0);
+	}
+	for (const ReplayScopeTiming& timing : GetScopeTimings()) {
+		LOG_INFO("  {}: {:.3f} ms total, {:.4f} ms per tick, {:.3f} ms max, {} calls, {} allocations ({} bytes)",
+			timing.name, timing.totalMs, timing.totalMs / std::max<uint32_t>(tickCount, 1), timing.maxMs, timing.callCount, timing.allocationCount, timing.allocatedBytes);
+	}
+}
+
+bool ReplayReport::WriteJson(const std::string& filepath) const {
+	std::ofstream file(filepath, std::ios::trunc);
+	if (!file) {
+		return false;
+	}
+	const std::vector<ReplayScopeTiming> timings = GetScopeTimings();
+	file << "{\n"
+		<< "  \"ticks\": " << tickCount << ",\n"
+		<< std::fixed << std::setprecision(3)
+		<< "  \"simulation_ms\": " << simulationMs << ",\n"
+		<< "  \"world_hash\": \"" << std::hex << std::setw(16) << std::setfill('0') << worldHash << std::dec << std::setfill(' ') << "\",\n"
+		<< "  \"allocations\": " << allocationCount << ",\n"
+		<< "  \"scopes\": [\n";
+	for (size_t i = 0; i < timings.size(); i++) {
+		file << "    { \"name\": \"" << timings[i].name << "\""
+			<< ", \"total_ms\": " << timings[i].totalMs
+			<< ", \"max_ms\": " << timings[i].maxMs
+			<< ", \"calls\": " << timings[i].callCount
+			<< ", \"allocations\": " << timings[i].allocationCount
+			<< ", \"allocated_bytes\": " << timings[i].allocatedBytes << " }"
+			<< (i + 1 < timings.size() ? ",\n" : "\n");
+	}
+	file << "  ]\n}\n";
+	return static_cast<bool>(file);
+}
+
+bool ReplayReport::ReadJson(const std::string& filepath) {
+	std::ifstream file(filepath);
+	if (!file) {
+		return false;
+	}
+	*this = ReplayReport();
+	bool bHasHash = false;
+	std::string line;
+	std::string value;
+	while (std::getline(file, line)) {
+		if (ReadJsonField(line, "name", value)) {
+			ReplayScopeTiming timing{ value, 0.0, 0.0, 0, 0, 0 };
+			if (ReadJsonField(line, "total_ms", value)) {
+				timing.totalMs = std::strtod(value.c_str(), nullptr);
+			}
+			if (ReadJsonField(line, "max_ms", value)) {
+				timing.maxMs = std::strtod(value.c_str(), nullptr);
+			}
+			if (ReadJsonField(line, "calls", value)) {
+				timing.callCount = std::strtoull(value.c_str(), nullptr, 10);
+			}
+			if (ReadJsonField(line, "allocations", value)) {
+				timing.allocationCount = std::strtoull(value.c_str(), nullptr, 10);
+			}
+			if (ReadJsonField(line, "allocated_bytes", value)) {
+				timing.allocatedBytes = std::strtoull(value.c_str(), nullptr, 10);
+			}
+			scopes.push_back(timing);
+		}
+		else if (ReadJsonField(line, "ticks", value)) {
+			tickCount = static_cast<uint32_t>(std::strtoul(value.c_str(), nullptr, 10));
+		}
+		else if (ReadJsonField(line, "simulation_ms", value)) {
+			simulationMs = std::strtod(value.c_str(), nullptr);
+		}
+		else if (ReadJsonField(line, "allocations", value)) {
+			allocationCount = std::strtoull(value.c_str(), nullptr, 10);
+		}
+		else if (ReadJsonField(line, "world_hash", value)) {
+			worldHash = std::strtoull(value.c_str(), nullptr, 16);
+			bHasHash = true;
+		}
+	}
+	return bHasHash;
+}
+
+bool ReplayReport::CompareWithBaseline(const ReplayReport& baseline) const {
+	bool bMatches = true;
+	if (tickCount != baseline.tickCount) {
+		LOG_ERROR("Replay ran {} ticks, the baseline {}", tickCount, baseline.tickCount);
+		bMatches = false;
+	}
+	if (worldHash != baseline.worldHash) {
+		LOG_ERROR("World hash {:x} differs from the baseline {:x}, the simulation diverged", worldHash, baseline.worldHash);
+		bMatches = false;
+	}
+	if (simulationMs > baseline.simulationMs * (1.0 + REPLAY_SLOWDOWN_TOLERANCE)) {
+		LOG_ERROR("Simulation took {:.2f} ms, the baseline {:.2f} ms", simulationMs, baseline.simulationMs);
+		bMatches = false;
+	}
+
+	// Slower scopes point at the system to look at, they don't fail the comparison on their own
+	for (const ReplayScopeTiming& baselineTiming : baseline.scopes) {
+		for (const ReplayScopeTiming& timing : scopes) {
+			if (timing.name != baselineTiming.name) {
+				continue;
+			}
+			if (baselineTiming.totalMs >= REPLAY_MIN_COMPARED_SCOPE_MS && timing.totalMs > baselineTiming.totalMs * (1.0 + REPLAY_SLOWDOWN_TOLERANCE)) {
+				LOG_WARNING("{} took {:.3f} ms, the baseline {:.3f} ms", timing.name, timing.totalMs, baselineTiming.totalMs);
+			}
+			// Only when both builds track allocations
+			if (baseline.allocationCount > 0 && timing.allocationCount > baselineTiming.allocationCount) {
+				LOG_WARNING("{} allocated {} times, the baseline {}", timing.name, timing.allocationCount, baselineTiming.allocationCount);
+			}
+		}
+	}
+	return bMatches;
+}
+
+uint64_t HashWorldState(const ECSManager& ecsManager) {
+	uint64_t hash = FNV1A_64_OFFSET_BASIS;
+	for (EntityId entityId = 0; entityId < ecsManager.GetEntityIdCount(); entityId++) {
+		const Entity entity(entityId);
+		// Only live entities, freed ids would tie the hash to how many entities ever existed
+		if (ecsManager.GetEntitySignature(entity).none()) {
+			continue;
+		}
+		if (ecsManager.bHasComponent<TilemapComponent>(entity) || ecsManager.bHasComponent<WorldRegionComponent>(entity)) {
+			continue;
+		}
+		// Which of the hashed components the entity has
+		const uint32_t components =
+			(ecsManager.bHasComponent<TransformComponent>(entity) ? 1u : 0u) |
+			(ecsManager.bHasComponent<RigidbodyComponent>(entity) ? 2u : 0u) |
+			(ecsManager.bHasComponent<SpriteComponent>(entity) ? 4u : 0u) |
+			(ecsManager.bHasComponent<AnimationComponent>(entity) ? 8u : 0u);
+		hash = HashValue(components, hash);
+
+		if (components & 1u) {
+			const TransformComponent& transform = ecsManager.GetComponent<TransformComponent>(entity);
+			hash = HashValue(transform.position, hash);
+			hash = HashValue(transform.scale, hash);
+			hash = HashValue(transform.rotation, hash);
+		}
+		if (components & 2u) {
+			hash = HashValue(ecsManager.GetComponent<RigidbodyComponent>(entity).velocity, hash);
+		}
+		if (components & 4u) {
+			const SpriteComponent& sprite = ecsManager.GetComponent<SpriteComponent>(entity);
+			hash = HashValue(sprite.srcRect, hash);
+			hash = HashValue(sprite.zIndex, hash);
+		}
+		if (components & 8u) {
+			hash = HashValue(ecsManager.GetComponent<AnimationComponent>(entity).currentFrame, hash);
+		}
+	}
+	return hash;
+}
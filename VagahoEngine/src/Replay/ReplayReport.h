@@ -0,0 +1,70 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cstdint>
+
+class ECSManager;
+
+// A replay slower than its baseline by more than this fails the comparison
+const double REPLAY_SLOWDOWN_TOLERANCE = 0.10;
+// Scopes shorter than this in the baseline are too noisy to report as slower
+const double REPLAY_MIN_COMPARED_SCOPE_MS = 1.0;
+
+// One profiler scope over the whole replay
+struct ReplayScopeTiming {
+	std::string name;
+	double totalMs;
+	double maxMs;				// longest tick
+	uint64_t callCount;
+	uint64_t allocationCount;	// 0 unless the allocation tracker is built in, see AllocationTracker.h
+	uint64_t allocatedBytes;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+/// REPLAY REPORT
+////////////////////////////////////////////////////////////////////////////////
+/// What a replay measured: the time of every profiler scope summed over the
+/// ticks (the systems have one each, see Game::Update), the simulation time
+/// and the world state hash at the end. With the allocation tracker built in,
+/// the allocations of every scope too. Reports are written as JSON and can be
+/// read back as the baseline of a later build: a different hash means the
+/// simulation diverged, a longer simulation time beyond the tolerance means
+/// it got slower.
+////////////////////////////////////////////////////////////////////////////////
+class ReplayReport {
+private:
+	uint32_t tickCount = 0;
+	double simulationMs = 0.0;
+	uint64_t worldHash = 0;
+	uint64_t allocationCount = 0;
+	std::vector<ReplayScopeTiming> scopes;
+	std::vector<size_t> profilerScopeIndices;	// profiler scope index to scopes index
+
+	// Index in scopes
+	size_t FindOrAddScope(const char* name);
+
+public:
+	// After each Profiler::EndFrame of the replay
+	void AddFrame();
+	void Finish(double simulationMs, uint64_t worldHash);
+
+	uint32_t GetTickCount() const { return tickCount; }
+	double GetSimulationMs() const { return simulationMs; }
+	uint64_t GetWorldHash() const { return worldHash; }
+	uint64_t GetAllocationCount() const { return allocationCount; }
+	// Scopes that ran, longest total first
+	std::vector<ReplayScopeTiming> GetScopeTimings() const;
+
+	void Print() const;
+	bool WriteJson(const std::string& filepath) const;
+	// Only reads what WriteJson writes
+	bool ReadJson(const std::string& filepath);
+	// Logs every difference, false if the hash differs or the simulation is slower than the tolerance
+	// Scopes that got slower or allocate more than in the baseline are only warned about
+	bool CompareWithBaseline(const ReplayReport& baseline) const;
+};
+
+// FNV-1a over the simulated state of the gameplay entities in id order
+// Entities of the tile layer and of streamed regions are left out, the loader threads decide when those are created
+uint64_t HashWorldState(const ECSManager& ecsManager);
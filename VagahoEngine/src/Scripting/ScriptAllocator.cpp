@@ -0,0 +1,165 @@
+#include "ScriptAllocator.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
+
+namespace {
+
+	const size_t SCRIPT_PAGE_SIZE = 64 * 1024;
+	const size_t SIZE_CLASSES[] = { 16, 32, 48, 64, 80, 96, 112, 128, 192, 256, 384, 512 };
+	const size_t SIZE_CLASS_COUNT = sizeof(SIZE_CLASSES) / sizeof(SIZE_CLASSES[0]);
+	const size_t LARGEST_SIZE_CLASS = SIZE_CLASSES[SIZE_CLASS_COUNT - 1];
+
+	// Size class of every multiple of 16 up to the largest class, built once
+	struct SizeClassTable {
+		uint8_t classOf16[LARGEST_SIZE_CLASS / 16 + 1];
+
+		SizeClassTable() {
+			size_t sizeClass = 0;
+			for (size_t i = 0; i <= LARGEST_SIZE_CLASS / 16; i++) {
+				while (SIZE_CLASSES[sizeClass] < i * 16) {
+					sizeClass++;
+				}
+				classOf16[i] = static_cast<uint8_t>(sizeClass);
+			}
+		}
+	};
+	const SizeClassTable SIZE_CLASS_TABLE;
+
+	// Only valid for 0 < size <= LARGEST_SIZE_CLASS
+	inline size_t GetSizeClass(size_t size) {
+		return SIZE_CLASS_TABLE.classOf16[(size + 15) / 16];
+	}
+}
+
+ScriptAllocator::ScriptAllocator(size_t budget) : freeLists(SIZE_CLASS_COUNT, nullptr) {
+	stats.budget = budget;
+}
+
+ScriptAllocator::~ScriptAllocator() {
+	for (void* page : pages) {
+		std::free(page);
+	}
+}
+
+void* ScriptAllocator::AllocateBlock(size_t size) {
+	if (size > LARGEST_SIZE_CLASS) {
+		void* block = std::malloc(size);
+		if (block) {
+			stats.largeBytes += size;
+		}
+		return block;
+	}
+
+	const size_t sizeClass = GetSizeClass(size);
+	if (!freeLists[sizeClass]) {
+		// Carve a new page into blocks of this class
+		void* page = std::malloc(SCRIPT_PAGE_SIZE);
+		if (!page) {
+			return nullptr;
+		}
+		pages.push_back(page);
+		stats.pageBytes += SCRIPT_PAGE_SIZE;
+
+		const size_t blockSize = SIZE_CLASSES[sizeClass];
+		char* bytes = static_cast<char*>(page);
+		for (size_t offset = 0; offset + blockSize <= SCRIPT_PAGE_SIZE; offset += blockSize) {
+			FreeBlock* block = reinterpret_cast<FreeBlock*>(bytes + offset);
+			block->next = freeLists[sizeClass];
+			freeLists[sizeClass] = block;
+		}
+	}
+
+	FreeBlock* block = freeLists[sizeClass];
+	freeLists[sizeClass] = block->next;
+	return block;
+}
+
+void ScriptAllocator::ReleaseBlock(void* block, size_t size) {
+	if (size > LARGEST_SIZE_CLASS) {
+		std::free(block);
+		stats.largeBytes -= size;
+		return;
+	}
+	const size_t sizeClass = GetSizeClass(size);
+	FreeBlock* freeBlock = static_cast<FreeBlock*>(block);
+	freeBlock->next = freeLists[sizeClass];
+	freeLists[sizeClass] = freeBlock;
+}
+
+void* ScriptAllocator::Allocate(void* userdata, void* block, size_t oldSize, size_t newSize) {
+	ScriptAllocator& allocator = *static_cast<ScriptAllocator*>(userdata);
+	ScriptMemoryStats& stats = allocator.stats;
+	// For a new block Lua passes the object type in oldSize, not a size
+	if (!block) {
+		oldSize = 0;
+	}
+
+	if (newSize == 0) {
+		if (block) {
+			allocator.ReleaseBlock(block, oldSize);
+			stats.bytesInUse -= oldSize;
+			stats.freeCount++;
+		}
+		return nullptr;
+	}
+
+	const bool bIsGrowing = newSize > oldSize;
+	if (bIsGrowing && stats.budget != 0 && stats.bytesInUse + (newSize - oldSize) > stats.budget) {
+		stats.failedAllocationCount++;
+		return nullptr;
+	}
+
+	if (block) {
+		// Still fits its block
+		const bool bSameClass = oldSize <= LARGEST_SIZE_CLASS && newSize <= LARGEST_SIZE_CLASS && GetSizeClass(oldSize) == GetSizeClass(newSize);
+		if (bSameClass) {
+			stats.bytesInUse = stats.bytesInUse - oldSize + newSize;
+			stats.peakBytesInUse = std::max(stats.peakBytesInUse, stats.bytesInUse);
+			return block;
+		}
+		if (oldSize > LARGEST_SIZE_CLASS && newSize > LARGEST_SIZE_CLASS) {
+			void* resized = std::realloc(block, newSize);
+			if (!resized) {
+				if (bIsGrowing) {
+					stats.failedAllocationCount++;
+					return nullptr;
+				}
+				resized = block;
+			}
+			stats.largeBytes = stats.largeBytes - oldSize + newSize;
+			stats.bytesInUse = stats.bytesInUse - oldSize + newSize;
+			stats.peakBytesInUse = std::max(stats.peakBytesInUse, stats.bytesInUse);
+			return resized;
+		}
+	}
+
+	void* newBlock = allocator.AllocateBlock(newSize);
+	if (!newBlock) {
+		if (!block || bIsGrowing) {
+			stats.failedAllocationCount++;
+			return nullptr;
+		}
+		// Lua expects shrinking to never fail: keep the old, bigger block. When it is freed
+		// with its new size it joins the free list of that smaller class, which is still
+		// safe (a large block's memory then stays with the pools instead of going back to malloc)
+		if (oldSize > LARGEST_SIZE_CLASS) {
+			stats.largeBytes -= oldSize;
+			if (newSize > LARGEST_SIZE_CLASS) {
+				stats.largeBytes += newSize;
+			}
+		}
+		stats.bytesInUse = stats.bytesInUse - oldSize + newSize;
+		return block;
+	}
+	stats.allocationCount++;
+	if (block) {
+		std::memcpy(newBlock, block, std::min(oldSize, newSize));
+		allocator.ReleaseBlock(block, oldSize);
+		stats.freeCount++;
+	}
+	stats.bytesInUse = stats.bytesInUse - oldSize + newSize;
+	stats.peakBytesInUse = std::max(stats.peakBytesInUse, stats.bytesInUse);
+	return newBlock;
+}
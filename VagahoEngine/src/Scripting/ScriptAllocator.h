@@ -0,0 +1,55 @@
+#pragma once
+
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+struct ScriptMemoryStats {
+	size_t bytesInUse;			// what Lua asked for and didn't free yet
+	size_t peakBytesInUse;
+	size_t budget;				// 0 when unlimited
+	size_t pageBytes;			// reserved by the size class pools
+	size_t largeBytes;			// blocks above the largest size class, from malloc
+	uint64_t allocationCount;
+	uint64_t freeCount;
+	uint64_t failedAllocationCount;		// refused because of the budget, Lua collects and retries first
+};
+
+////////////////////////////////////////////////////////////////////////////////
+/// SCRIPT ALLOCATOR
+////////////////////////////////////////////////////////////////////////////////
+/// lua_Alloc for one Lua state. Small blocks (most Lua strings, tables and
+/// closures) come from per size class free lists carved out of 64 KB pages, so
+/// they don't fragment the process heap. Bigger blocks go to malloc.
+/// Lua passes the old size of every block it frees or resizes, so blocks carry
+/// no header. Growing past the budget fails the allocation, which makes Lua run
+/// an emergency collection and raise a memory error if that isn't enough.
+/// Pages are kept until the allocator is destroyed. Not thread safe, like the
+/// Lua state it belongs to.
+////////////////////////////////////////////////////////////////////////////////
+class ScriptAllocator {
+private:
+	struct FreeBlock {
+		FreeBlock* next;
+	};
+
+	std::vector<FreeBlock*> freeLists;		// per size class
+	std::vector<void*> pages;
+	ScriptMemoryStats stats = {};
+
+	void* AllocateBlock(size_t size);
+	void ReleaseBlock(void* block, size_t size);
+
+public:
+	explicit ScriptAllocator(size_t budget = 0);
+	~ScriptAllocator();
+
+	ScriptAllocator(const ScriptAllocator&) = delete;
+	ScriptAllocator& operator =(const ScriptAllocator&) = delete;
+
+	// The lua_Alloc, userdata is the ScriptAllocator
+	static void* Allocate(void* userdata, void* block, size_t oldSize, size_t newSize);
+
+	void SetBudget(size_t budget) { stats.budget = budget; }
+	const ScriptMemoryStats& GetStats() const { return stats; }
+};
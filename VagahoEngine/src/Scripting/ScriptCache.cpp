@@ -0,0 +1,96 @@
+#include "ScriptCache.h"
+
+#include "../Logger/Logger.h"
+#include "../Utils/HashUtils.h"
+#include "../Utils/MappedFile.h"
+
+#include <lua/lua.hpp>
+
+#include <filesystem>
+#include <fstream>
+#include <vector>
+#include <cstdio>
+
+namespace {
+
+	int WriteBytecode(lua_State*, const void* data, size_t size, void* userdata) {
+		auto* bytecode = static_cast<std::vector<char>*>(userdata);
+		const char* bytes = static_cast<const char*>(data);
+		bytecode->insert(bytecode->end(), bytes, bytes + size);
+		return 0;
+	}
+}
+
+ScriptCache::ScriptCache(const std::string& directory) : directory(directory) {
+}
+
+int ScriptCache::Load(lua_State* L, const std::string& filepath) {
+	MappedFile source;
+	if (!source.Open(filepath)) {
+		lua_pushfstring(L, "cannot open %s", filepath.c_str());
+		return LUA_ERRFILE;
+	}
+	const char* sourceText = reinterpret_cast<const char*>(source.GetData());
+	const std::string chunkName = "@" + filepath;
+
+	// The release goes into the key, bytecode isn't portable across Lua versions
+	const uint64_t hash = Fnv1a64(source.GetData(), source.GetSize(), Fnv1a64(LUA_RELEASE, sizeof(LUA_RELEASE) - 1));
+	char hashText[17];
+	std::snprintf(hashText, sizeof(hashText), "%016llx", static_cast<unsigned long long>(hash));
+	const std::string scriptName = std::filesystem::path(filepath).stem().string();
+	const std::string cachePath = directory + "/" + scriptName + "-" + hashText + ".luac";
+
+	MappedFile cached;
+	if (cached.Open(cachePath)) {
+		const int status = luaL_loadbufferx(L, reinterpret_cast<const char*>(cached.GetData()), cached.GetSize(), chunkName.c_str(), "b");
+		if (status == LUA_OK) {
+			hitCount++;
+			LOG_AT(VERBOSE, Scripting, "Script {} loaded from {}", filepath, cachePath);
+			return LUA_OK;
+		}
+		LOG_AT(WARNING, Scripting, "Discarding cached bytecode {}: {}", cachePath, lua_tostring(L, -1));
+		lua_pop(L, 1);
+	}
+
+	missCount++;
+	const int status = luaL_loadbufferx(L, sourceText, source.GetSize(), chunkName.c_str(), "t");
+	if (status == LUA_OK) {
+		Store(cachePath, scriptName, L);
+	}
+	return status;
+}
+
+void ScriptCache::Store(const std::string& cachePath, const std::string& scriptName, lua_State* L) {
+	std::vector<char> bytecode;
+	// Debug info is kept, errors keep their file and line
+	if (lua_dump(L, WriteBytecode, &bytecode, 0) != 0 || bytecode.empty()) {
+		return;
+	}
+
+	std::error_code error;
+	std::filesystem::create_directories(directory, error);
+	// Drop the script's stale entries, one file per script is enough
+	for (const auto& entry : std::filesystem::directory_iterator(directory, error)) {
+		const std::string filename = entry.path().filename().string();
+		if (entry.path().extension() == ".luac" && filename.rfind(scriptName + "-", 0) == 0 &&
+			filename.size() == scriptName.size() + 1 + 16 + 5) {
+			std::filesystem::remove(entry.path(), error);
+		}
+	}
+
+	// Written next to the final name and renamed, a crash never leaves a half written cache file
+	const std::string temporaryPath = cachePath + ".tmp";
+	{
+		std::ofstream file(temporaryPath, std::ios::binary | std::ios::trunc);
+		file.write(bytecode.data(), static_cast<std::streamsize>(bytecode.size()));
+		if (!file) {
+			LOG_AT(WARNING, Scripting, "Can't write script cache {}", temporaryPath);
+			return;
+		}
+	}
+	std::filesystem::rename(temporaryPath, cachePath, error);
+	if (error) {
+		LOG_AT(WARNING, Scripting, "Can't write script cache {}: {}", cachePath, error.message());
+		std::filesystem::remove(temporaryPath, error);
+	}
+}
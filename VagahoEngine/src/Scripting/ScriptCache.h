@@ -0,0 +1,34 @@
+#pragma once
+
+#include <string>
+#include <cstdint>
+
+struct lua_State;
+
+////////////////////////////////////////////////////////////////////////////////
+/// SCRIPT CACHE
+////////////////////////////////////////////////////////////////////////////////
+/// Compiled Lua chunks on disk, keyed by a hash of the script source (and the
+/// Lua release). A script whose source didn't change since the last run is
+/// loaded as bytecode and skips the parser. Otherwise it is compiled from source
+/// and its bytecode (lua_dump) replaces the script's previous cache file.
+/// Cache files are named <script name>-<hash>.luac. Bytecode the Lua build
+/// rejects (another version or number format) counts as a miss.
+////////////////////////////////////////////////////////////////////////////////
+class ScriptCache {
+private:
+	std::string directory;
+	uint64_t hitCount = 0;
+	uint64_t missCount = 0;
+
+	void Store(const std::string& cachePath, const std::string& scriptName, lua_State* L);
+
+public:
+	explicit ScriptCache(const std::string& directory);
+
+	// Like luaL_loadfile: pushes the chunk (or an error message) and returns the Lua status
+	int Load(lua_State* L, const std::string& filepath);
+
+	uint64_t GetHitCount() const { return hitCount; }
+	uint64_t GetMissCount() const { return missCount; }
+};
@@ -0,0 +1,458 @@
+#include "ScriptEngine.h"
+
+#include "../Logger/Logger.h"
+#include "../Components/TransformComponent.h"
+#include "../Components/RigidbodyComponent.h"
+
+#include <sol/sol.hpp>
+#include <glm/glm.hpp>
+
+#include <tuple>
+#include <chrono>
+#include <algorithm>
+#include <stdexcept>
+
+struct ScriptEngine::Behaviour {
+	std::string name;
+	sol::protected_function update;
+	sol::protected_function run;
+	bool bHasUpdate = false;		// cleared when update fails
+	bool bHasRun = false;
+};
+
+struct ScriptEngine::Coroutine {
+	sol::thread thread;				// the coroutine's own Lua stack
+	sol::coroutine function;
+	Entity entity { 0 };
+	int behaviourIndex = -1;
+	uint32_t generation = 0;
+	ScriptWait wait = ScriptWait::None;
+	bool bIsActive = false;
+	bool bHasStarted = false;
+};
+
+namespace {
+
+	// Lua indices are 1 based, errors are turned into Lua errors by sol
+	const Entity& GetBatchEntity(const ScriptBatch& batch, size_t index) {
+		if (index < 1 || index > batch.count) {
+			throw std::out_of_range("batch index out of range");
+		}
+		return batch.entities[index - 1];
+	}
+
+	template <typename TComponent>
+	TComponent& GetEntityComponent(const Entity& entity) {
+		if (!entity.bHasComponent<TComponent>()) {
+			throw std::logic_error("entity doesn't have the requested component");
+		}
+		return entity.GetComponent<TComponent>();
+	}
+
+	template <typename TComponent>
+	TComponent& GetBatchComponent(const ScriptBatch& batch, size_t index) {
+		return GetEntityComponent<TComponent>(GetBatchEntity(batch, index));
+	}
+
+	bool bIsWaitEvent(int wait) {
+		return wait == static_cast<int>(ScriptWait::Collision) || wait == static_cast<int>(ScriptWait::KeyPressed);
+	}
+}
+
+ScriptEngine::ScriptEngine() : lua(std::make_unique<sol::state>(sol::default_at_panic, &ScriptAllocator::Allocate, &allocator)) {
+	lua->open_libraries(sol::lib::base, sol::lib::math, sol::lib::string, sol::lib::table, sol::lib::coroutine);
+	RegisterBindings();
+	(*lua)["Behaviours"] = lua->create_table();
+
+	// Collection only happens in StepGarbageCollector (and in Lua's emergency collection on a failed allocation)
+	lua_gc(lua->lua_state(), LUA_GCSTOP);
+	gcStats.bytesAfterLastCycle = allocator.GetStats().bytesInUse;
+	LOG_AT(INFO, Scripting, "Script engine started ({})", LUA_RELEASE);
+}
+
+ScriptEngine::~ScriptEngine() {
+	// The behaviours and coroutines hold references into the state, release them first
+	coroutines.clear();
+	behaviours.clear();
+	lua.reset();
+}
+
+void ScriptEngine::RegisterBindings() {
+	lua->new_usertype<glm::vec2>("vec2",
+		sol::constructors<glm::vec2(), glm::vec2(float, float)>(),
+		"x", &glm::vec2::x,
+		"y", &glm::vec2::y
+	);
+
+	lua->new_usertype<TransformComponent>("TransformComponent",
+		"position", &TransformComponent::position,
+		"scale", &TransformComponent::scale,
+		"rotation", &TransformComponent::rotation
+	);
+
+	lua->new_usertype<RigidbodyComponent>("RigidbodyComponent",
+		"velocity", &RigidbodyComponent::velocity
+	);
+
+	// Plain numbers in and out for the common fields, the cheapest way across the boundary
+	lua->new_usertype<ScriptBatch>("ScriptBatch",
+		sol::no_constructor,
+		"count", sol::readonly_property([](const ScriptBatch& batch) { return batch.count; }),
+		"id", [](const ScriptBatch& batch, size_t index) {
+			return GetBatchEntity(batch, index).GetId();
+		},
+		"position", [](const ScriptBatch& batch, size_t index) {
+			const glm::vec2& position = GetBatchComponent<TransformComponent>(batch, index).position;
+			return std::make_tuple(position.x, position.y);
+		},
+		"set_position", [](const ScriptBatch& batch, size_t index, float x, float y) {
+			GetBatchComponent<TransformComponent>(batch, index).position = glm::vec2(x, y);
+		},
+		"velocity", [](const ScriptBatch& batch, size_t index) {
+			const glm::vec2& velocity = GetBatchComponent<RigidbodyComponent>(batch, index).velocity;
+			return std::make_tuple(velocity.x, velocity.y);
+		},
+		"set_velocity", [](const ScriptBatch& batch, size_t index, float x, float y) {
+			GetBatchComponent<RigidbodyComponent>(batch, index).velocity = glm::vec2(x, y);
+		},
+		"has_rigidbody", [](const ScriptBatch& batch, size_t index) {
+			return GetBatchEntity(batch, index).bHasComponent<RigidbodyComponent>();
+		},
+		"transform", [](const ScriptBatch& batch, size_t index) -> TransformComponent& {
+			return GetBatchComponent<TransformComponent>(batch, index);
+		},
+		"rigidbody", [](const ScriptBatch& batch, size_t index) -> RigidbodyComponent& {
+			return GetBatchComponent<RigidbodyComponent>(batch, index);
+		}
+	);
+
+	// The entity a run function gets, same accessors as a batch without the index
+	lua->new_usertype<Entity>("Entity",
+		sol::no_constructor,
+		"id", &Entity::GetId,
+		"position", [](const Entity& entity) {
+			const glm::vec2& position = GetEntityComponent<TransformComponent>(entity).position;
+			return std::make_tuple(position.x, position.y);
+		},
+		"set_position", [](const Entity& entity, float x, float y) {
+			GetEntityComponent<TransformComponent>(entity).position = glm::vec2(x, y);
+		},
+		"velocity", [](const Entity& entity) {
+			const glm::vec2& velocity = GetEntityComponent<RigidbodyComponent>(entity).velocity;
+			return std::make_tuple(velocity.x, velocity.y);
+		},
+		"set_velocity", [](const Entity& entity, float x, float y) {
+			GetEntityComponent<RigidbodyComponent>(entity).velocity = glm::vec2(x, y);
+		},
+		"has_rigidbody", [](const Entity& entity) {
+			return entity.bHasComponent<RigidbodyComponent>();
+		},
+		"transform", [](const Entity& entity) -> TransformComponent& {
+			return GetEntityComponent<TransformComponent>(entity);
+		},
+		"rigidbody", [](const Entity& entity) -> RigidbodyComponent& {
+			return GetEntityComponent<RigidbodyComponent>(entity);
+		}
+	);
+
+	lua->set_function("log", [](const std::string& message) {
+		LOG_AT(INFO, Scripting, message);
+	});
+
+	// The waits yield the coroutine with what it waits on, UpdateCoroutines parks it accordingly
+	// Outside of a coroutine they raise the usual "attempt to yield from outside a coroutine"
+	(*lua)["Events"] = lua->create_table_with(
+		"Collision", static_cast<int>(ScriptWait::Collision),
+		"KeyPressed", static_cast<int>(ScriptWait::KeyPressed)
+	);
+	lua->set_function("wait_frame", sol::yielding([]() {
+		return static_cast<int>(ScriptWait::Frame);
+	}));
+	lua->set_function("wait", sol::yielding([](double seconds) {
+		return std::make_tuple(static_cast<int>(ScriptWait::Time), seconds);
+	}));
+	lua->set_function("wait_event", sol::yielding([](int event) {
+		if (!bIsWaitEvent(event)) {
+			throw std::invalid_argument("wait_event expects a value of the Events table");
+		}
+		return event;
+	}));
+}
+
+bool ScriptEngine::RunFile(const std::string& filepath) {
+	lua_State* L = lua->lua_state();
+	if (scriptCache.Load(L, filepath) != LUA_OK) {
+		LOG_AT(ERROR, Scripting, "Script {} failed to load: {}", filepath, lua_tostring(L, -1));
+		lua_pop(L, 1);
+		return false;
+	}
+	sol::protected_function chunk = sol::stack::pop<sol::protected_function>(L);
+	sol::protected_function_result result = chunk();
+	if (!result.valid()) {
+		sol::error error = result;
+		LOG_AT(ERROR, Scripting, "Script {} failed: {}", filepath, error.what());
+		return false;
+	}
+	LOG_AT(INFO, Scripting, "Script {} loaded", filepath);
+	return true;
+}
+
+bool ScriptEngine::RunString(const std::string& code, const std::string& chunkName) {
+	sol::protected_function_result result = lua->safe_script(code, sol::script_pass_on_error, chunkName);
+	if (!result.valid()) {
+		sol::error error = result;
+		LOG_AT(ERROR, Scripting, "Script {} failed: {}", chunkName, error.what());
+		return false;
+	}
+	return true;
+}
+
+void ScriptEngine::SetRandomSeed(uint32_t seed) {
+	(*lua)["math"]["randomseed"](static_cast<lua_Integer>(seed));
+}
+
+int ScriptEngine::GetBehaviourIndex(const std::string& name) {
+	for (size_t i = 0; i < behaviours.size(); i++) {
+		if (behaviours[i]->name == name) {
+			return static_cast<int>(i);
+		}
+	}
+
+	auto behaviour = std::make_unique<Behaviour>();
+	behaviour->name = name;
+	sol::optional<sol::protected_function> update = (*lua)["Behaviours"][name]["update"];
+	if (update) {
+		behaviour->update = *update;
+		behaviour->bHasUpdate = true;
+	}
+	sol::optional<sol::protected_function> run = (*lua)["Behaviours"][name]["run"];
+	if (run) {
+		behaviour->run = *run;
+		behaviour->bHasRun = true;
+	}
+	if (!update && !run) {
+		LOG_AT(ERROR, Scripting, "Behaviour '{}' has no update or run function, entities using it won't run", name);
+	}
+	behaviours.push_back(std::move(behaviour));
+	return static_cast<int>(behaviours.size() - 1);
+}
+
+bool ScriptEngine::bHasUpdate(int behaviourIndex) const {
+	return behaviours[behaviourIndex]->bHasUpdate;
+}
+
+bool ScriptEngine::bHasRun(int behaviourIndex) const {
+	return behaviours[behaviourIndex]->bHasRun;
+}
+
+void ScriptEngine::UpdateBehaviour(int behaviourIndex, const ScriptBatch& batch, double deltaTime) {
+	Behaviour& behaviour = *behaviours[behaviourIndex];
+	if (!behaviour.bHasUpdate) {
+		return;
+	}
+	sol::protected_function_result result = behaviour.update(std::cref(batch), deltaTime);
+	if (!result.valid()) {
+		sol::error error = result;
+		// Keep the frame going but don't spam the log with the same error every frame
+		LOG_AT(ERROR, Scripting, "Behaviour '{}' failed and is disabled: {}", behaviour.name, error.what());
+		behaviour.bHasUpdate = false;
+	}
+}
+
+void ScriptEngine::StepGarbageCollector(double availableMs) {
+	const ScriptMemoryStats& memoryStats = allocator.GetStats();
+	if (!gcStats.bIsCycleRunning) {
+		const bool bHasGrown = memoryStats.bytesInUse > gcStats.bytesAfterLastCycle * (1.0 + gcSettings.cycleGrowth);
+		const bool bIsUnderPressure = memoryStats.budget != 0 && memoryStats.bytesInUse > memoryStats.budget * gcSettings.budgetPressure;
+		if (!bHasGrown && !bIsUnderPressure) {
+			gcStats.lastSliceMs = 0.0;
+			return;
+		}
+		gcStats.bIsCycleRunning = true;
+	}
+
+	const double sliceMs = std::clamp(availableMs, gcSettings.minSliceMs, gcSettings.maxSliceMs);
+	const auto startTime = std::chrono::steady_clock::now();
+	double elapsedMs = 0.0;
+	lua_State* L = lua->lua_state();
+	while (elapsedMs < sliceMs) {
+		// Returns 1 when the step finished a cycle
+		if (lua_gc(L, LUA_GCSTEP, gcSettings.stepSizeKB)) {
+			gcStats.bIsCycleRunning = false;
+			gcStats.cyclesCompleted++;
+			gcStats.bytesAfterLastCycle = memoryStats.bytesInUse;
+			elapsedMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startTime).count();
+			break;
+		}
+		elapsedMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startTime).count();
+	}
+	gcStats.lastSliceMs = elapsedMs;
+	gcStats.longestSliceMs = std::max(gcStats.longestSliceMs, elapsedMs);
+}
+
+void ScriptEngine::StartCoroutine(int behaviourIndex, Entity entity) {
+	const Behaviour& behaviour = *behaviours[behaviourIndex];
+	if (!behaviour.bHasRun) {
+		return;
+	}
+	StopCoroutine(entity);
+
+	int slot;
+	if (!freeCoroutineSlots.empty()) {
+		slot = freeCoroutineSlots.back();
+		freeCoroutineSlots.pop_back();
+	}
+	else {
+		slot = static_cast<int>(coroutines.size());
+		coroutines.push_back(std::make_unique<Coroutine>());
+	}
+
+	Coroutine& coroutine = *coroutines[slot];
+	coroutine.thread = sol::thread::create(lua->lua_state());
+	coroutine.function = sol::coroutine(coroutine.thread.state(), behaviour.run);
+	coroutine.entity = entity;
+	coroutine.behaviourIndex = behaviourIndex;
+	coroutine.wait = ScriptWait::None;
+	coroutine.bIsActive = true;
+	coroutine.bHasStarted = false;
+	activeCoroutineCount++;
+
+	const size_t entityId = static_cast<size_t>(entity.GetId());
+	if (entityId >= entityCoroutines.size()) {
+		entityCoroutines.resize(entityId + 1, -1);
+	}
+	entityCoroutines[entityId] = slot;
+	readyCoroutines.push_back(CoroutineResume{ CoroutineHandle{ slot, coroutine.generation }, ScriptWait::None, 0 });
+}
+
+void ScriptEngine::StopCoroutine(Entity entity) {
+	const size_t entityId = static_cast<size_t>(entity.GetId());
+	if (entityId < entityCoroutines.size() && entityCoroutines[entityId] >= 0) {
+		ReleaseCoroutine(entityCoroutines[entityId]);
+	}
+}
+
+void ScriptEngine::ReleaseCoroutine(int slot) {
+	// Timers and wait list entries still naming the slot are skipped by their generation
+	Coroutine& coroutine = *coroutines[slot];
+	entityCoroutines[static_cast<size_t>(coroutine.entity.GetId())] = -1;
+	coroutine.function = sol::coroutine();
+	coroutine.thread = sol::thread();
+	coroutine.wait = ScriptWait::None;
+	coroutine.bIsActive = false;
+	coroutine.generation++;
+	freeCoroutineSlots.push_back(slot);
+	activeCoroutineCount--;
+}
+
+bool ScriptEngine::bIsCurrent(const CoroutineHandle& handle) const {
+	const Coroutine& coroutine = *coroutines[handle.slot];
+	return coroutine.bIsActive && coroutine.generation == handle.generation;
+}
+
+ScriptEngine::Coroutine* ScriptEngine::GetEntityCoroutine(Entity entity, ScriptWait wait) {
+	const size_t entityId = static_cast<size_t>(entity.GetId());
+	if (entityId >= entityCoroutines.size() || entityCoroutines[entityId] < 0) {
+		return nullptr;
+	}
+	Coroutine* coroutine = coroutines[entityCoroutines[entityId]].get();
+	return coroutine->wait == wait ? coroutine : nullptr;
+}
+
+void ScriptEngine::UpdateCoroutines(double deltaTime) {
+	// Whatever becomes ready while these run (wait_frame) waits for the next call
+	resumingCoroutines.swap(readyCoroutines);
+	coroutineTimers.Advance(deltaTime, [this](const CoroutineHandle& handle) {
+		if (bIsCurrent(handle) && coroutines[handle.slot]->wait == ScriptWait::Time) {
+			coroutines[handle.slot]->wait = ScriptWait::None;
+			resumingCoroutines.push_back(CoroutineResume{ handle, ScriptWait::Time, 0 });
+		}
+	});
+
+	for (const CoroutineResume& resume : resumingCoroutines) {
+		if (bIsCurrent(resume.handle)) {
+			ResumeCoroutine(resume, deltaTime);
+		}
+	}
+	resumingCoroutines.clear();
+}
+
+void ScriptEngine::ResumeCoroutine(const CoroutineResume& resume, double deltaTime) {
+	Coroutine& coroutine = *coroutines[resume.handle.slot];
+	coroutine.wait = ScriptWait::None;
+
+	bool bHasEnded = false;
+	{
+		sol::protected_function_result result;
+		if (!coroutine.bHasStarted) {
+			coroutine.bHasStarted = true;
+			result = coroutine.function(coroutine.entity);
+		}
+		else if (resume.reason == ScriptWait::Frame) {
+			result = coroutine.function(deltaTime);
+		}
+		else if (resume.reason == ScriptWait::Time) {
+			result = coroutine.function();
+		}
+		else {
+			result = coroutine.function(resume.value);
+		}
+
+		if (!result.valid()) {
+			sol::error error = result;
+			LOG_AT(ERROR, Scripting, "Coroutine of behaviour '{}' on entity {} failed: {}", behaviours[coroutine.behaviourIndex]->name, coroutine.entity.GetId(), error.what());
+			bHasEnded = true;
+		}
+		else if (result.status() != sol::call_status::yielded) {
+			// The run function returned
+			bHasEnded = true;
+		}
+		else {
+			// A bare coroutine.yield() waits a frame, like wait_frame()
+			const int wait = result.return_count() > 0 ? result.get<int>(0) : static_cast<int>(ScriptWait::Frame);
+			const CoroutineHandle handle { resume.handle.slot, coroutine.generation };
+			if (wait == static_cast<int>(ScriptWait::Time)) {
+				coroutine.wait = ScriptWait::Time;
+				coroutineTimers.Schedule(result.get<double>(1), handle);
+			}
+			else if (wait == static_cast<int>(ScriptWait::Collision)) {
+				coroutine.wait = ScriptWait::Collision;
+			}
+			else if (wait == static_cast<int>(ScriptWait::KeyPressed)) {
+				coroutine.wait = ScriptWait::KeyPressed;
+				keyPressedWaiters.push_back(handle);
+			}
+			else {
+				coroutine.wait = ScriptWait::Frame;
+				readyCoroutines.push_back(CoroutineResume{ handle, ScriptWait::Frame, 0 });
+			}
+		}
+	}
+
+	// After the result is gone, it still refers to the coroutine's stack
+	if (bHasEnded) {
+		ReleaseCoroutine(resume.handle.slot);
+	}
+}
+
+void ScriptEngine::OnCollision(Entity a, Entity b) {
+	// Both sides wake up, each with the other one's id
+	if (Coroutine* coroutine = GetEntityCoroutine(a, ScriptWait::Collision)) {
+		coroutine->wait = ScriptWait::None;
+		readyCoroutines.push_back(CoroutineResume{ CoroutineHandle{ entityCoroutines[a.GetId()], coroutine->generation }, ScriptWait::Collision, static_cast<int>(b.GetId()) });
+	}
+	if (Coroutine* coroutine = GetEntityCoroutine(b, ScriptWait::Collision)) {
+		coroutine->wait = ScriptWait::None;
+		readyCoroutines.push_back(CoroutineResume{ CoroutineHandle{ entityCoroutines[b.GetId()], coroutine->generation }, ScriptWait::Collision, static_cast<int>(a.GetId()) });
+	}
+}
+
+void ScriptEngine::OnKeyPressed(int keyCode) {
+	for (const CoroutineHandle& handle : keyPressedWaiters) {
+		if (bIsCurrent(handle) && coroutines[handle.slot]->wait == ScriptWait::KeyPressed) {
+			coroutines[handle.slot]->wait = ScriptWait::None;
+			readyCoroutines.push_back(CoroutineResume{ handle, ScriptWait::KeyPressed, keyCode });
+		}
+	}
+	keyPressedWaiters.clear();
+}
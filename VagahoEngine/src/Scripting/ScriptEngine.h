@@ -0,0 +1,181 @@
+#pragma once
+
+#include "../ECS/ECS.h"
+#include "ScriptCache.h"
+#include "ScriptAllocator.h"
+#include "../Utils/TimerWheel.h"
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <cstddef>
+
+// Compiled scripts are kept here between runs (see ScriptCache)
+const std::string SCRIPT_CACHE_DIRECTORY = "./cache/scripts";
+// Lua allocations past this fail (after an emergency collection)
+const size_t SCRIPT_MEMORY_BUDGET = 64 * 1024 * 1024;
+
+// Resolution of wait(seconds), and the span of the timer wheel before timers wrap around
+const double SCRIPT_TIMER_TICK = 1.0 / 120.0;
+const size_t SCRIPT_TIMER_SLOTS = 512;
+
+// What a script coroutine is parked on, the values of the Lua Events table
+enum class ScriptWait : uint8_t {
+	None,			// running, or queued to resume on the next frame
+	Frame,			// wait_frame(), returns the next frame's deltaTime
+	Time,			// wait(seconds)
+	Collision,		// wait_event(Events.Collision), returns the id of the other entity
+	KeyPressed		// wait_event(Events.KeyPressed), returns the key code
+};
+
+// The Lua collector doesn't run on its own, the engine steps it in time slices (StepGarbageCollector)
+struct ScriptGcSettings {
+	double maxSliceMs = 1.0;		// most time one frame spends collecting
+	double minSliceMs = 0.25;		// even when the frame has no time left, so a cycle always finishes
+	int stepSizeKB = 4;				// work per lua_gc step, the slice is checked between steps
+	double cycleGrowth = 1.0;		// start a cycle once memory grew this much (1.0 = doubled) since the last one
+	double budgetPressure = 0.75;	// or once this fraction of the memory budget is in use
+};
+
+struct ScriptGcStats {
+	bool bIsCycleRunning;
+	uint64_t cyclesCompleted;
+	size_t bytesAfterLastCycle;
+	double lastSliceMs;
+	double longestSliceMs;
+};
+
+// sol.hpp is heavy, it is only included by ScriptEngine.cpp
+namespace sol {
+	class state;
+}
+
+// Entities sharing one behaviour, handed to Lua in a single call
+// Lua reads and writes their components in place through it, nothing is copied
+struct ScriptBatch {
+	const Entity* entities;
+	size_t count;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+/// SCRIPT ENGINE
+////////////////////////////////////////////////////////////////////////////////
+/// Owns the Lua state. Scripts register behaviours in the global Behaviours table:
+///
+///   Behaviours.hover = {
+///       update = function(batch, deltaTime)
+///           for i = 1, batch.count do
+///               local x, y = batch:position(i)
+///               batch:set_position(i, x, y + deltaTime)
+///           end
+///       end
+///   }
+///
+/// A behaviour is called once per frame with every entity using it (see
+/// ScriptSystem), so the cost of crossing into Lua doesn't grow with the entity
+/// count. The batch exposes the components as views into the ECS pools:
+///   batch.count, batch:id(i), batch:position(i), batch:set_position(i, x, y),
+///   batch:velocity(i), batch:set_velocity(i, x, y), batch:has_rigidbody(i),
+///   batch:transform(i), batch:rigidbody(i) (references, fields are writable)
+/// Scripts can't create or destroy entities from a batch, the views point into
+/// the component pools and would be invalidated by a resize.
+///
+/// Sequential logic goes in a run function instead, started as a coroutine for
+/// each entity using the behaviour (an entity's behaviour can have both):
+///
+///   Behaviours.patrol = {
+///       run = function(entity)
+///           while true do
+///               entity:set_velocity(50, 0)
+///               wait(2.0)
+///               entity:set_velocity(-50, 0)
+///               local other = wait_event(Events.Collision)
+///           end
+///       end
+///   }
+///
+/// A parked coroutine sits in the timer wheel or in an event wait list and
+/// costs nothing until it is due. Coroutines resume at the start of the next
+/// ScriptSystem update after their wait ends, and stop when their entity is
+/// destroyed or their run function returns.
+////////////////////////////////////////////////////////////////////////////////
+class ScriptEngine {
+private:
+	struct Behaviour;
+	struct Coroutine;
+
+	struct CoroutineHandle {
+		int slot;
+		uint32_t generation;		// a slot reused by another coroutine doesn't match anymore
+	};
+
+	struct CoroutineResume {
+		CoroutineHandle handle;
+		ScriptWait reason;
+		int value;					// returned by wait_event
+	};
+
+	// Declared before the state, it has to outlive it
+	ScriptAllocator allocator { SCRIPT_MEMORY_BUDGET };
+	std::unique_ptr<sol::state> lua;
+	ScriptGcSettings gcSettings;
+	ScriptGcStats gcStats = {};
+	ScriptCache scriptCache { SCRIPT_CACHE_DIRECTORY };
+	std::vector<std::unique_ptr<Behaviour>> behaviours;		// indexed by behaviour index
+
+	std::vector<std::unique_ptr<Coroutine>> coroutines;		// slots, reused once a coroutine ends
+	std::vector<int> freeCoroutineSlots;
+	std::vector<int> entityCoroutines;						// slot by entity id, -1 when the entity has none
+	TimerWheel<CoroutineHandle> coroutineTimers { SCRIPT_TIMER_TICK, SCRIPT_TIMER_SLOTS };
+	std::vector<CoroutineHandle> keyPressedWaiters;
+	std::vector<CoroutineResume> readyCoroutines;			// resumed by the next UpdateCoroutines
+	std::vector<CoroutineResume> resumingCoroutines;
+	size_t activeCoroutineCount = 0;
+
+	void RegisterBindings();
+	bool bIsCurrent(const CoroutineHandle& handle) const;
+	Coroutine* GetEntityCoroutine(Entity entity, ScriptWait wait);
+	void ResumeCoroutine(const CoroutineResume& resume, double deltaTime);
+	void ReleaseCoroutine(int slot);
+
+public:
+	ScriptEngine();
+	~ScriptEngine();
+
+	ScriptEngine(const ScriptEngine&) = delete;
+	ScriptEngine& operator =(const ScriptEngine&) = delete;
+
+	// Runs a script file, from the bytecode cache when its source didn't change
+	// Errors are logged and return false
+	bool RunFile(const std::string& filepath);
+	bool RunString(const std::string& code, const std::string& chunkName);
+	// Reseeds math.random, Lua seeds it randomly at startup
+	void SetRandomSeed(uint32_t seed);
+
+	// Stable index of Behaviours[name]. Unknown names get an index too, they are reported once and never run
+	int GetBehaviourIndex(const std::string& name);
+	bool bHasUpdate(int behaviourIndex) const;
+	bool bHasRun(int behaviourIndex) const;
+	void UpdateBehaviour(int behaviourIndex, const ScriptBatch& batch, double deltaTime);
+
+	// Coroutines of the behaviours' run functions, one per entity at most
+	// A started coroutine first runs on the next UpdateCoroutines
+	void StartCoroutine(int behaviourIndex, Entity entity);
+	void StopCoroutine(Entity entity);
+	// Advances the timers and resumes the coroutines whose wait ended since the last call
+	void UpdateCoroutines(double deltaTime);
+	// Wake the coroutines waiting on these events
+	void OnCollision(Entity a, Entity b);
+	void OnKeyPressed(int keyCode);
+	size_t GetCoroutineCount() const { return activeCoroutineCount; }
+
+	// Runs the incremental collector for up to availableMs (clamped to the settings' slice)
+	// Call it once per frame with the frame's spare time
+	void StepGarbageCollector(double availableMs);
+	void SetGcSettings(const ScriptGcSettings& settings) { gcSettings = settings; }
+	const ScriptGcStats& GetGcStats() const { return gcStats; }
+	const ScriptMemoryStats& GetMemoryStats() const { return allocator.GetStats(); }
+
+	sol::state& GetState() { return *lua; }
+	const ScriptCache& GetScriptCache() const { return scriptCache; }
+};
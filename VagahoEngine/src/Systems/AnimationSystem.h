@@ -1,7 +1,5 @@
 #pragma once
 
-#include <SDL2/SDL.h>
-
 #include "../ECS/ECS.h"
 #include "../Components/SpriteComponent.h"
 #include "../Components/AnimationComponent.h"
@@ -13,12 +11,14 @@ public:
 		AddRequiredComponent<AnimationComponent>();
 	}
 
-	void Update() {
+	// Frames follow the game time rather than the wall clock, a replay shows the same frames
+	void Update(double deltaTime) {
 		for (auto entity : GetSystemEntities()) {
 			AnimationComponent& animation	= entity.GetComponent<AnimationComponent>();
 			SpriteComponent&	sprite		= entity.GetComponent<SpriteComponent>();
 
-			animation.currentFrame = ((SDL_GetTicks() - animation.startTime) * animation.frameChangeRate / 1000) % animation.totalFrames;
+			animation.elapsedTime += deltaTime;
+			animation.currentFrame = static_cast<int>(animation.elapsedTime * animation.frameChangeRate) % animation.totalFrames;
 			sprite.srcRect.x = animation.currentFrame * sprite.width;
 		}
 	}
@@ -40,7 +40,7 @@ private:
 
 	//// Called when a collision starts between two entities
 	//void OnCollisionStart(Entity& entity1, Entity& entity2) {
-	//	LOG_INFO("Collision started between Entity " + std::to_string(entity1.GetId()) + " and Entity " + std::to_string(entity2.GetId()));
+	//	LOG_AT(INFO, Collision, "Collision started between Entity {} and Entity {}", entity1.GetId(), entity2.GetId());
 	//	// TODO: Add broadcast function here.
 	//	entity1.Destroy();
 	//	entity2.Destroy();
@@ -48,14 +48,14 @@ private:
 	//}
 
 	//void OnCollisionStay(Entity& entity1, Entity& entity2) {
-	//	// LOG_INFO("Collision ongoing between Entity " + std::to_string(entity1.GetId()) + " and Entity " + std::to_string(entity2.GetId()));
+	//	// LOG_AT(VERBOSE, Collision, "Collision ongoing between Entity {} and Entity {}", entity1.GetId(), entity2.GetId());
 	//	// TODO: Replace with broadcast or event system call
 	//	// Add logic for continuous collision handling
 	//}
 
 	//// Called when a collision ends between two entities
 	//void OnCollisionEnd(int entityId1, int entityId2) {
-	//	LOG_INFO("Collision ended between Entity " + std::to_string(entityId1) + " and Entity " + std::to_string(entityId2));
+	//	LOG_AT(INFO, Collision, "Collision ended between Entity {} and Entity {}", entityId1, entityId2);
 	//	// TODO: Add broadcast function here.
 	//}
 
@@ -70,27 +70,26 @@ public:
 	// Main update function called every frame
 	void Update(std::unique_ptr<EventManager>& eventManager) {
 		// Get all entities with required components for collision
-		auto collisionEntities = GetSystemEntities();
-		// Set to keep track of collisions in the current frame
-		std::unordered_set<std::pair<int, int>, PairHash> currentCollisions;
+		// No copy of the list, collision handlers only queue destruction so it doesn't change during the pass
+		const auto& collisionEntities = GetSystemEntities();
 
 		// Outer loop: iterate through all entities
-		for (std::vector<Entity>::iterator i = collisionEntities.begin(); i != collisionEntities.end(); i++)
+		for (std::vector<Entity>::const_iterator i = collisionEntities.begin(); i != collisionEntities.end(); i++)
 		{
 			Entity a = *i;
 			// Get components of the first entity
-			auto aTransform		= a.GetComponent<TransformComponent>();
-			auto aCollider		= a.GetComponent<BoxColliderComponent>();
+			const auto& aTransform	= a.GetComponent<TransformComponent>();
+			const auto& aCollider	= a.GetComponent<BoxColliderComponent>();
 
 			// Inner loop: compare with all other entities
-			for (std::vector<Entity>::iterator j = i; j != collisionEntities.end(); j++)
+			for (std::vector<Entity>::const_iterator j = i; j != collisionEntities.end(); j++)
 			{
 				Entity b = *j;
 				// bypass if comparing same entities
 				if (a == b) continue;
 				// Get components of the second entity
-				auto bTransform	= b.GetComponent<TransformComponent>();
-				auto bCollider	= b.GetComponent<BoxColliderComponent>();
+				const auto& bTransform	= b.GetComponent<TransformComponent>();
+				const auto& bCollider	= b.GetComponent<BoxColliderComponent>();
 				
 				// Check for collision between the two entities
 				bool bCollisionHappened = CheckAABBCollision(
@@ -104,14 +103,11 @@ public:
 					bCollider.height		* bTransform.scale.y
 				);
 
-				// Create a unique pair for these two entities
-				// This ensures that the pair (A,B) is the same as (B,A) for consistent tracking
-				auto entityPair = CreateEntityPair(a.GetId(), b.GetId());
-
 				if (bCollisionHappened) {
-					// LOG_WARNING("Entity " + std::to_string(entityFirst.GetId()) + " is colliding with " + std::to_string(entitySecond.GetId()));
+					// LOG_AT(VERBOSE, Collision, "Entity {} is colliding with {}", entityFirst.GetId(), entitySecond.GetId());
 					
-					eventManager->BroadcastEvent<CollisionEvent>(a, b);
+					// Delivered after the collision pass, see Game::Update
+					eventManager->QueueEvent<CollisionEvent>(a, b);
 					
 					
 					//// A collision is currently happening between entityFirst and entitySecond
@@ -7,17 +7,20 @@
 #include "../Events/CollisionEvent.h"
 
 class DamageSystem : public System {
+private:
+	EventConnection collisionConnection;
+
 public:
 	DamageSystem() {
 		AddRequiredComponent<BoxColliderComponent>();
 	}
 
 	void SubscribeToEvents(std::unique_ptr<EventManager>& eventManager) {
-		eventManager->Subscribe<CollisionEvent>(this, &DamageSystem::OnCollision);
+		collisionConnection = eventManager->Subscribe<&DamageSystem::OnCollision>(this);
 	}
 
 	void OnCollision(CollisionEvent& event) {
-		LOG_INFO("The Damage system received and event collision between entities " + std::to_string(event.a.GetId()) + " and " + std::to_string(event.b.GetId()));
+		LOG_AT(INFO, Collision, "The Damage system received and event collision between entities {} and {}", event.a.GetId(), event.b.GetId());
 		event.a.Destroy();
 		event.b.Destroy();
 	}
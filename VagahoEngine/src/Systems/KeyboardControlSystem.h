@@ -6,19 +6,20 @@
 #include "../Events/KeyPressedEvent.h"
 
 class KeyboardControlSystem : public System {
+private:
+	EventConnection keyPressedConnection;
+
 public:
 	KeyboardControlSystem() {
 
 	}
 
 	void SubscribeToEvents(std::unique_ptr<EventManager>& eventManager) {
-		eventManager->Subscribe<KeyPressedEvent>(this, &KeyboardControlSystem::OnKeyPressed);
+		keyPressedConnection = eventManager->Subscribe<&KeyboardControlSystem::OnKeyPressed>(this);
 	}
 
 	void OnKeyPressed(KeyPressedEvent& event) {
-		std::string keyCode = std::to_string(event.symbol);
-		std::string keySymbol(1, event.symbol);
-		LOG_WARNING("Key pressed event broadcasted: [" + keyCode + "] " + keySymbol);
+		LOG_AT(INFO, Events, "Key pressed event broadcasted: [{}] {}", event.symbol, static_cast<char>(event.symbol));
 	}
 	
 	void Update() {
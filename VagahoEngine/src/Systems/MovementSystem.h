@@ -15,16 +15,14 @@ public:
 		
 		for (auto entity : GetSystemEntities()) {
 			TransformComponent& transform = entity.GetComponent<TransformComponent>(); // call this as reference since we are changing the current value
-			const RigidbodyComponent rigidbody = entity.GetComponent<RigidbodyComponent>();
+			const RigidbodyComponent& rigidbody = entity.GetComponent<RigidbodyComponent>();
 
 			transform.position.x += rigidbody.velocity.x * deltaTime;
 			transform.position.y += rigidbody.velocity.y * deltaTime;
 			
-			/*LOG_INFO(
-				"Entity id = " 
-				+ std::to_string(entity.GetId()) 
-				+ " position: (" + std::to_string(transform.position.x) 
-				+ ", " + std::to_string(transform.position.y) + ")"
+			/*LOG_AT(
+				VERBOSE, ECS, "Entity id = {} position: ({}, {})",
+				entity.GetId(), transform.position.x, transform.position.y
 			);*/
 		}
 	
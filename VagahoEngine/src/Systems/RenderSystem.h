@@ -10,6 +10,15 @@
 #include <algorithm>
 
 class RenderSystem : public System {
+private:
+	// Pointers into the component pools, nothing is added to the pools while the system draws
+	struct RenderableEntity {
+		const TransformComponent* transformComponent;
+		const SpriteComponent* spriteComponent;
+	};
+	// Refilled every frame, keeps its capacity so drawing doesn't allocate
+	std::vector<RenderableEntity> renderableEntities;
+
 public:
 	RenderSystem() {
 		AddRequiredComponent<TransformComponent>();
@@ -17,18 +26,12 @@ public:
 	}
 
 	void Update(SDL_Renderer* renderer, std::unique_ptr<AssetManager>& assetManager) {
-		// Create a vector with both Sprite and Transform component of all entities
-
-		struct RenderableEntity {
-			TransformComponent transformComponent;
-			SpriteComponent spriteComponent;
-		};
-
-		std::vector<RenderableEntity> renderableEntities;
+		// Collect both Sprite and Transform component of all entities
+		renderableEntities.clear();
 		for (auto entity : GetSystemEntities()) {
 			RenderableEntity renderableEntity;
-			renderableEntity.spriteComponent = entity.GetComponent<SpriteComponent>();
-			renderableEntity.transformComponent = entity.GetComponent<TransformComponent>();
+			renderableEntity.spriteComponent = &entity.GetComponent<SpriteComponent>();
+			renderableEntity.transformComponent = &entity.GetComponent<TransformComponent>();
 			renderableEntities.emplace_back(renderableEntity);
 		}
 
@@ -37,13 +40,13 @@ public:
 			renderableEntities.begin(), 
 			renderableEntities.end(), 
 			[](const RenderableEntity& a, const RenderableEntity& b) {
-				return a.spriteComponent.zIndex < b.spriteComponent.zIndex;
+				return a.spriteComponent->zIndex < b.spriteComponent->zIndex;
 			});
 		
 
-		for (auto entity : renderableEntities) {
-			const TransformComponent transform = entity.transformComponent;
-			const SpriteComponent sprite = entity.spriteComponent;
+		for (const RenderableEntity& entity : renderableEntities) {
+			const TransformComponent& transform = *entity.transformComponent;
+			const SpriteComponent& sprite = *entity.spriteComponent;
 			
 			// Set the source rectangle of original sprite texture
 			SDL_Rect srcRect = sprite.srcRect;
@@ -68,4 +71,3 @@ public:
 		}
 	}
 };
-
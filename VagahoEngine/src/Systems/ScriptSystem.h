@@ -0,0 +1,85 @@
+#pragma once
+
+#include "../ECS/ECS.h"
+#include "../Components/ScriptComponent.h"
+#include "../Scripting/ScriptEngine.h"
+#include "../EventManager/EventManager.h"
+#include "../Events/CollisionEvent.h"
+#include "../Events/KeyPressedEvent.h"
+
+class ScriptSystem : public System {
+private:
+	ScriptEngine& scriptEngine;
+
+	// Entities of each behaviour with an update function, indexed by behaviour index
+	// Kept as entities come and go, so entities that only run a coroutine aren't visited every frame
+	std::vector<std::vector<Entity>> batches;
+	std::vector<int> batchPositions;		// position in its batch by entity id, -1 when in none
+
+	EventConnection collisionConnection;
+	EventConnection keyPressedConnection;
+
+public:
+	ScriptSystem(ScriptEngine& scriptEngine) : scriptEngine(scriptEngine) {
+		AddRequiredComponent<ScriptComponent>();
+	}
+
+	// Wakes the coroutines waiting on events
+	void SubscribeToEvents(std::unique_ptr<EventManager>& eventManager) {
+		collisionConnection = eventManager->Subscribe<&ScriptSystem::OnCollision>(this);
+		keyPressedConnection = eventManager->Subscribe<&ScriptSystem::OnKeyPressed>(this);
+	}
+
+	void OnCollision(CollisionEvent& event) {
+		scriptEngine.OnCollision(event.a, event.b);
+	}
+
+	void OnKeyPressed(KeyPressedEvent& event) {
+		scriptEngine.OnKeyPressed(event.symbol);
+	}
+
+	virtual void OnEntityAdded(Entity entity) override {
+		ScriptComponent& script = entity.GetComponent<ScriptComponent>();
+		script.behaviourIndex = scriptEngine.GetBehaviourIndex(script.behaviour);
+
+		if (scriptEngine.bHasUpdate(script.behaviourIndex)) {
+			if (script.behaviourIndex >= static_cast<int>(batches.size())) {
+				batches.resize(script.behaviourIndex + 1);
+			}
+			if (entity.GetId() >= batchPositions.size()) {
+				batchPositions.resize(entity.GetId() + 1, -1);
+			}
+			batchPositions[entity.GetId()] = static_cast<int>(batches[script.behaviourIndex].size());
+			batches[script.behaviourIndex].push_back(entity);
+		}
+		if (scriptEngine.bHasRun(script.behaviourIndex)) {
+			scriptEngine.StartCoroutine(script.behaviourIndex, entity);
+		}
+	}
+
+	// Called for every destroyed entity, scripted or not
+	virtual void OnEntityRemoved(Entity entity) override {
+		scriptEngine.StopCoroutine(entity);
+
+		if (entity.GetId() >= batchPositions.size() || batchPositions[entity.GetId()] < 0) {
+			return;
+		}
+		std::vector<Entity>& batch = batches[entity.GetComponent<ScriptComponent>().behaviourIndex];
+		const int position = batchPositions[entity.GetId()];
+		batch[position] = batch.back();
+		batchPositions[batch[position].GetId()] = position;
+		batch.pop_back();
+		batchPositions[entity.GetId()] = -1;
+	}
+
+	// Coroutines whose wait ended first, then one Lua call per behaviour whatever the number of entities using it
+	void Update(double deltaTime) {
+		scriptEngine.UpdateCoroutines(deltaTime);
+
+		for (size_t i = 0; i < batches.size(); i++) {
+			if (!batches[i].empty()) {
+				scriptEngine.UpdateBehaviour(static_cast<int>(i), ScriptBatch{ batches[i].data(), batches[i].size() }, deltaTime);
+			}
+		}
+	}
+};
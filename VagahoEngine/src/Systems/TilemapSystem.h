@@ -0,0 +1,163 @@
+#pragma once
+
+#include "../ECS/ECS.h"
+#include "../Components/TransformComponent.h"
+#include "../Components/TilemapComponent.h"
+#include "../AssetManager/AssetManager.h"
+
+#include <SDL2/SDL.h>
+#include <unordered_map>
+#include <algorithm>
+#include <cmath>
+
+////////////////////////////////////////////////////////////////////////////////
+/// The tilemap is one entity instead of one entity per tile.
+/// Chunks of TILEMAP_CHUNK_SIZE x TILEMAP_CHUNK_SIZE tiles are pre-rendered into
+/// target textures, only the chunks inside the camera are drawn, and a chunk is
+/// rebaked only when one of its tiles (or the tileset texture) changed.
+////////////////////////////////////////////////////////////////////////////////
+class TilemapSystem : public System {
+private:
+	struct ChunkCache {
+		std::vector<SDL_Texture*> chunkTextures;	// nullptr until the chunk is first visible
+		SDL_Texture* tileset = nullptr;				// tileset the chunks were baked from
+	};
+
+	std::unordered_map<EntityId, ChunkCache> chunkCaches;
+
+	void DestroyChunkCache(ChunkCache& cache) {
+		for (auto chunkTexture : cache.chunkTextures) {
+			SDL_DestroyTexture(chunkTexture);
+		}
+		cache.chunkTextures.clear();
+		cache.tileset = nullptr;
+	}
+
+	void BakeChunk(SDL_Renderer* renderer, SDL_Texture* tileset, const TilemapComponent& tilemap, int chunkX, int chunkY, SDL_Texture*& chunkTexture) {
+		const int firstX = chunkX * TILEMAP_CHUNK_SIZE;
+		const int firstY = chunkY * TILEMAP_CHUNK_SIZE;
+		// Edge chunks are smaller when the map size isn't a multiple of the chunk size
+		const int chunkColumns = std::min(TILEMAP_CHUNK_SIZE, tilemap.columns - firstX);
+		const int chunkRows = std::min(TILEMAP_CHUNK_SIZE, tilemap.rows - firstY);
+
+		if (!chunkTexture) {
+			chunkTexture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_TARGET, chunkColumns * tilemap.tileSize, chunkRows * tilemap.tileSize);
+			SDL_SetTextureBlendMode(chunkTexture, SDL_BLENDMODE_BLEND);
+		}
+
+		SDL_Texture* previousTarget = SDL_GetRenderTarget(renderer);
+		SDL_SetRenderTarget(renderer, chunkTexture);
+		SDL_SetRenderDrawColor(renderer, 0, 0, 0, 0);
+		SDL_RenderClear(renderer);
+
+		for (int y = 0; y < chunkRows; y++) {
+			for (int x = 0; x < chunkColumns; x++) {
+				const int tileId = tilemap.GetTile(firstX + x, firstY + y);
+				if (tileId < 0) {
+					continue;
+				}
+				SDL_Rect srcRect = {
+					(tileId % tilemap.tilesetColumns) * tilemap.tileSize,
+					(tileId / tilemap.tilesetColumns) * tilemap.tileSize,
+					tilemap.tileSize,
+					tilemap.tileSize
+				};
+				SDL_Rect destRect = { x * tilemap.tileSize, y * tilemap.tileSize, tilemap.tileSize, tilemap.tileSize };
+				SDL_RenderCopy(renderer, tileset, &srcRect, &destRect);
+			}
+		}
+
+		SDL_SetRenderTarget(renderer, previousTarget);
+	}
+
+public:
+	TilemapSystem() {
+		AddRequiredComponent<TransformComponent>();
+		AddRequiredComponent<TilemapComponent>();
+	}
+
+	~TilemapSystem() {
+		for (auto& chunkCache : chunkCaches) {
+			DestroyChunkCache(chunkCache.second);
+		}
+	}
+
+	virtual void OnEntityRemoved(Entity entity) override {
+		auto chunkCache = chunkCaches.find(entity.GetId());
+		if (chunkCache != chunkCaches.end()) {
+			DestroyChunkCache(chunkCache->second);
+			chunkCaches.erase(chunkCache);
+		}
+	}
+
+	// Target textures lose their content when the render device is reset, bake everything again
+	void InvalidateChunks() {
+		for (auto& chunkCache : chunkCaches) {
+			chunkCache.second.tileset = nullptr;
+		}
+	}
+
+	void Update(SDL_Renderer* renderer, std::unique_ptr<AssetManager>& assetManager, const SDL_Rect& camera) {
+		for (auto entity : GetSystemEntities()) {
+			const TransformComponent& transform = entity.GetComponent<TransformComponent>();
+			TilemapComponent& tilemap = entity.GetComponent<TilemapComponent>();
+
+			SDL_Texture* tileset = assetManager->GetTexture(tilemap.assetId);
+			if (!tileset || tilemap.columns <= 0 || tilemap.rows <= 0) {
+				continue;
+			}
+
+			const int chunkColumns = tilemap.GetChunkColumns();
+			const int chunkRows = tilemap.GetChunkRows();
+			ChunkCache& cache = chunkCaches[entity.GetId()];
+
+			// Map resized, or the tileset texture was swapped (hot reload, eviction): rebake every chunk
+			if (cache.chunkTextures.size() != tilemap.dirtyChunks.size()) {
+				DestroyChunkCache(cache);
+				cache.chunkTextures.resize(tilemap.dirtyChunks.size(), nullptr);
+			}
+			if (cache.tileset != tileset) {
+				std::fill(tilemap.dirtyChunks.begin(), tilemap.dirtyChunks.end(), 1);
+				cache.tileset = tileset;
+			}
+
+			// Size of a chunk on screen
+			const double chunkWidth = TILEMAP_CHUNK_SIZE * tilemap.tileSize * transform.scale.x;
+			const double chunkHeight = TILEMAP_CHUNK_SIZE * tilemap.tileSize * transform.scale.y;
+
+			// Range of chunks overlapping the camera
+			const int firstChunkX = std::max(0, static_cast<int>(std::floor((camera.x - transform.position.x) / chunkWidth)));
+			const int firstChunkY = std::max(0, static_cast<int>(std::floor((camera.y - transform.position.y) / chunkHeight)));
+			const int lastChunkX = std::min(chunkColumns - 1, static_cast<int>(std::floor((camera.x + camera.w - transform.position.x) / chunkWidth)));
+			const int lastChunkY = std::min(chunkRows - 1, static_cast<int>(std::floor((camera.y + camera.h - transform.position.y) / chunkHeight)));
+
+			for (int chunkY = firstChunkY; chunkY <= lastChunkY; chunkY++) {
+				for (int chunkX = firstChunkX; chunkX <= lastChunkX; chunkX++) {
+					const int chunkIndex = chunkY * chunkColumns + chunkX;
+					SDL_Texture*& chunkTexture = cache.chunkTextures[chunkIndex];
+
+					if (tilemap.dirtyChunks[chunkIndex] || !chunkTexture) {
+						BakeChunk(renderer, tileset, tilemap, chunkX, chunkY, chunkTexture);
+						tilemap.dirtyChunks[chunkIndex] = 0;
+					}
+
+					// Snap both edges and take the difference, so neighbouring chunks never leave a seam
+					const int tilesWide = std::min(TILEMAP_CHUNK_SIZE, tilemap.columns - chunkX * TILEMAP_CHUNK_SIZE);
+					const int tilesHigh = std::min(TILEMAP_CHUNK_SIZE, tilemap.rows - chunkY * TILEMAP_CHUNK_SIZE);
+					const double left = transform.position.x + chunkX * chunkWidth - camera.x;
+					const double top = transform.position.y + chunkY * chunkHeight - camera.y;
+					const double right = left + tilesWide * tilemap.tileSize * transform.scale.x;
+					const double bottom = top + tilesHigh * tilemap.tileSize * transform.scale.y;
+
+					SDL_Rect destRect = {
+						static_cast<int>(left),
+						static_cast<int>(top),
+						static_cast<int>(right) - static_cast<int>(left),
+						static_cast<int>(bottom) - static_cast<int>(top)
+					};
+					SDL_RenderCopy(renderer, chunkTexture, NULL, &destRect);
+				}
+			}
+		}
+	}
+};
@@ -0,0 +1,60 @@
+#include "ThreadPool.h"
+#include "../Profiler/Profiler.h"
+
+#include <algorithm>
+
+ThreadPool::ThreadPool(unsigned int threadCount, const std::string& name) : name(name) {
+	if (threadCount == 0) {
+		// hardware_concurrency() is allowed to return 0 when it can't tell
+		unsigned int hardwareThreads = std::thread::hardware_concurrency();
+		threadCount = std::max(1u, hardwareThreads > 1 ? hardwareThreads - 1 : 1u);
+	}
+
+	workers.reserve(threadCount);
+	for (unsigned int i = 0; i < threadCount; i++) {
+		workers.emplace_back(&ThreadPool::WorkerLoop, this, i);
+	}
+}
+
+ThreadPool::~ThreadPool() {
+	{
+		std::lock_guard<std::mutex> lock(jobsMutex);
+		bIsStopping = true;
+	}
+	jobsCondition.notify_all();
+
+	// Workers finish the jobs that are already queued before they exit
+	for (auto& worker : workers) {
+		worker.join();
+	}
+}
+
+void ThreadPool::Enqueue(std::function<void()> job) {
+	{
+		std::lock_guard<std::mutex> lock(jobsMutex);
+		jobs.push_back(std::move(job));
+	}
+	jobsCondition.notify_one();
+}
+
+unsigned int ThreadPool::GetThreadCount() const {
+	return static_cast<unsigned int>(workers.size());
+}
+
+void ThreadPool::WorkerLoop(unsigned int workerIndex) {
+	Profiler::SetThreadName(name + " " + std::to_string(workerIndex));
+	while (true) {
+		std::function<void()> job;
+		{
+			std::unique_lock<std::mutex> lock(jobsMutex);
+			jobsCondition.wait(lock, [this]() { return bIsStopping || !jobs.empty(); });
+			if (bIsStopping && jobs.empty()) {
+				return;
+			}
+			job = std::move(jobs.front());
+			jobs.pop_front();
+		}
+		PROFILE_SCOPE("Job");
+		job();
+	}
+}
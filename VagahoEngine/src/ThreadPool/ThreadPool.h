@@ -0,0 +1,40 @@
+#pragma once
+
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <string>
+
+////////////////////////////////////////////////////////////////////////////////
+/// THREAD POOL
+////////////////////////////////////////////////////////////////////////////////
+/// A fixed set of worker threads that pull jobs from a shared FIFO queue.
+/// Jobs must not touch the SDL renderer, only the main thread is allowed to do that.
+////////////////////////////////////////////////////////////////////////////////
+class ThreadPool {
+private:
+	std::vector<std::thread> workers;
+	std::deque<std::function<void()>> jobs;
+
+	std::mutex jobsMutex;
+	std::condition_variable jobsCondition;
+	bool bIsStopping = false;
+	std::string name;
+
+	void WorkerLoop(unsigned int workerIndex);
+
+public:
+	// threadCount = 0 uses one thread less than the hardware threads, leaving a core to the main thread
+	// Workers are named "<name> <index>" in the profiler
+	ThreadPool(unsigned int threadCount = 0, const std::string& name = "Worker");
+	~ThreadPool();
+
+	ThreadPool(const ThreadPool&) = delete;
+	ThreadPool& operator =(const ThreadPool&) = delete;
+
+	void Enqueue(std::function<void()> job);
+	unsigned int GetThreadCount() const;
+};
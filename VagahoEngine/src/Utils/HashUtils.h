@@ -1,6 +1,7 @@
 #pragma once
 
 #include <cstddef>
+#include <cstdint>
 #include <utility>
 
 // Custom hash function for std::pair<int, int>
@@ -15,4 +16,17 @@ struct PairHash {
 		// Combine 2 hashes -> Use bitwise XOR (^) and left shift (<<) to create a unique hash
 		return hash1 ^ (hash2 << 1);
 	}
-};
\ No newline at end of file
+};
+
+// 64-bit FNV-1a, for content hashes (cache keys), not for hash tables
+const uint64_t FNV1A_64_OFFSET_BASIS	= 0xcbf29ce484222325ull;
+const uint64_t FNV1A_64_PRIME			= 0x100000001b3ull;
+
+inline uint64_t Fnv1a64(const void* data, std::size_t size, uint64_t hash = FNV1A_64_OFFSET_BASIS) {
+	const unsigned char* bytes = static_cast<const unsigned char*>(data);
+	for (std::size_t i = 0; i < size; i++) {
+		hash ^= bytes[i];
+		hash *= FNV1A_64_PRIME;
+	}
+	return hash;
+}
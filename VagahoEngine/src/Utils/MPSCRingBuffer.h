@@ -0,0 +1,86 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <cstddef>
+#include <cstdint>
+
+////////////////////////////////////////////////////////////////////////////////
+/// MPSC RING BUFFER
+////////////////////////////////////////////////////////////////////////////////
+/// Bounded lock-free queue for many producers and one consumer (Vyukov's
+/// bounded queue). Every cell carries a sequence number that tells whether it
+/// is free for the producer at that position or filled for the consumer, so a
+/// push is one CAS on the write position and no locks. A full buffer makes
+/// TryPush fail instead of blocking. Values are written and read in place.
+////////////////////////////////////////////////////////////////////////////////
+template <typename T>
+class MPSCRingBuffer {
+private:
+	struct alignas(64) Cell {
+		std::atomic<size_t> sequence;
+		T value;
+	};
+
+	std::unique_ptr<Cell[]> cells;
+	size_t mask;
+
+	// Written by every producer, kept off the consumer's cache line
+	alignas(64) std::atomic<size_t> enqueuePosition;
+	alignas(64) std::atomic<size_t> dequeuePosition;
+
+public:
+	// capacity must be a power of two
+	explicit MPSCRingBuffer(size_t capacity) : cells(new Cell[capacity]), mask(capacity - 1), enqueuePosition(0), dequeuePosition(0) {
+		for (size_t i = 0; i < capacity; i++) {
+			cells[i].sequence.store(i, std::memory_order_relaxed);
+		}
+	}
+
+	MPSCRingBuffer(const MPSCRingBuffer&) = delete;
+	MPSCRingBuffer& operator =(const MPSCRingBuffer&) = delete;
+
+	// fill(T&) writes the value in place, returns false if the buffer is full
+	template <typename TFill>
+	bool TryPush(TFill&& fill) {
+		size_t position = enqueuePosition.load(std::memory_order_relaxed);
+		while (true) {
+			Cell& cell = cells[position & mask];
+			const size_t sequence = cell.sequence.load(std::memory_order_acquire);
+			const intptr_t difference = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(position);
+			if (difference == 0) {
+				if (enqueuePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+					fill(cell.value);
+					cell.sequence.store(position + 1, std::memory_order_release);
+					return true;
+				}
+			}
+			else if (difference < 0) {
+				return false;
+			}
+			else {
+				position = enqueuePosition.load(std::memory_order_relaxed);
+			}
+		}
+	}
+
+	// Consumer thread only. consume(T&) reads the value in place, returns false if the buffer is empty
+	template <typename TConsume>
+	bool TryPop(TConsume&& consume) {
+		const size_t position = dequeuePosition.load(std::memory_order_relaxed);
+		Cell& cell = cells[position & mask];
+		const size_t sequence = cell.sequence.load(std::memory_order_acquire);
+		if (static_cast<intptr_t>(sequence) - static_cast<intptr_t>(position + 1) < 0) {
+			return false;
+		}
+		consume(cell.value);
+		cell.sequence.store(position + mask + 1, std::memory_order_release);
+		dequeuePosition.store(position + 1, std::memory_order_release);
+		return true;
+	}
+
+	// Number of values pushed / popped so far, e.g. to wait until everything pushed before a point is consumed
+	size_t GetPushCount() const { return enqueuePosition.load(std::memory_order_acquire); }
+	size_t GetPopCount() const { return dequeuePosition.load(std::memory_order_acquire); }
+	size_t GetCapacity() const { return mask + 1; }
+};
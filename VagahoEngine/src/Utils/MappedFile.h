@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+////////////////////////////////////////////////////////////////////////////////
+/// MAPPED FILE
+////////////////////////////////////////////////////////////////////////////////
+/// Read-only memory mapping of a whole file (mmap on POSIX, file mapping on Windows).
+/// The OS pages the bytes in on first access, nothing is copied into the heap.
+/// An empty file opens as an empty buffer (GetSize() == 0).
+////////////////////////////////////////////////////////////////////////////////
+class MappedFile {
+private:
+	const uint8_t* data = nullptr;
+	size_t size = 0;
+#ifdef _WIN32
+	void* fileHandle = nullptr;
+	void* mappingHandle = nullptr;
+#else
+	int fileDescriptor = -1;
+#endif
+
+public:
+	MappedFile() = default;
+	~MappedFile();
+
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator =(const MappedFile&) = delete;
+
+	bool Open(const std::string& filepath);
+	void Close();
+
+	bool bIsOpen() const { return data != nullptr; }
+	const uint8_t* GetData() const { return data; }
+	size_t GetSize() const { return size; }
+};
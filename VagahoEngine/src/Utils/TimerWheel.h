@@ -0,0 +1,81 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <cmath>
+#include <algorithm>
+
+////////////////////////////////////////////////////////////////////////////////
+/// TIMER WHEEL
+////////////////////////////////////////////////////////////////////////////////
+/// Hashed timing wheel: a timer due at tick t sits in slot t % slotCount.
+/// Advancing only visits the slots of the ticks that passed, so the cost of a
+/// frame depends on the timers that come due (and the few sharing their slot
+/// from a later rotation), not on how many are waiting.
+/// Timers fire at the first tick at or after their due time, the resolution is
+/// tickDuration. Delays longer than a rotation stay in their slot and are
+/// skipped until their rotation comes.
+////////////////////////////////////////////////////////////////////////////////
+template <typename T>
+class TimerWheel {
+private:
+	struct Timer {
+		uint64_t dueTick;
+		T value;
+	};
+
+	std::vector<std::vector<Timer>> slots;
+	std::vector<Timer> dueTimers;		// reused by Advance, timers can be scheduled from its callback
+	double tickDuration;
+	double pendingTime = 0.0;
+	uint64_t currentTick = 0;
+	size_t timerCount = 0;
+
+public:
+	// slotCount must be a power of two
+	TimerWheel(double tickDuration, size_t slotCount) : slots(slotCount), tickDuration(tickDuration) {}
+
+	void Schedule(double delay, T value) {
+		const uint64_t ticks = std::max<uint64_t>(1, static_cast<uint64_t>(std::ceil((pendingTime + delay) / tickDuration)));
+		const uint64_t dueTick = currentTick + ticks;
+		slots[dueTick & (slots.size() - 1)].push_back(Timer{ dueTick, value });
+		timerCount++;
+	}
+
+	// Calls onDue(value) for every timer due by the end of deltaTime
+	template <typename TCallback>
+	void Advance(double deltaTime, TCallback&& onDue) {
+		pendingTime += deltaTime;
+		const uint64_t ticks = static_cast<uint64_t>(pendingTime / tickDuration);
+		if (ticks == 0) {
+			return;
+		}
+		pendingTime -= ticks * tickDuration;
+		const uint64_t lastTick = currentTick + ticks;
+
+		// A long frame visits each slot once at most
+		const uint64_t visitedTicks = std::min<uint64_t>(ticks, slots.size());
+		for (uint64_t tick = lastTick - visitedTicks + 1; tick <= lastTick && timerCount != 0; tick++) {
+			std::vector<Timer>& slot = slots[tick & (slots.size() - 1)];
+			auto firstDue = std::partition(slot.begin(), slot.end(), [lastTick](const Timer& timer) {
+				return timer.dueTick > lastTick;
+			});
+			dueTimers.insert(dueTimers.end(), firstDue, slot.end());
+			timerCount -= slot.end() - firstDue;
+			slot.erase(firstDue, slot.end());
+		}
+		currentTick = lastTick;
+
+		// Due timers fire in due order
+		std::stable_sort(dueTimers.begin(), dueTimers.end(), [](const Timer& a, const Timer& b) {
+			return a.dueTick < b.dueTick;
+		});
+		for (const Timer& timer : dueTimers) {
+			onDue(timer.value);
+		}
+		dueTimers.clear();
+	}
+
+	size_t GetTimerCount() const { return timerCount; }
+};
@@ -0,0 +1,283 @@
+#include "WorldStreamer.h"
+
+#include "../Logger/Logger.h"
+#include "../Profiler/Profiler.h"
+#include "../Components/TransformComponent.h"
+#include "../Components/TilemapComponent.h"
+#include "../Components/BoxColliderComponent.h"
+#include "../Components/WorldRegionComponent.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+
+// Regions decode on a couple of threads, they are small and the texture loaders need the cores more
+const unsigned int WORLD_LOADER_THREADS = 2;
+
+WorldStreamer::WorldStreamer(const WorldStreamerSettings& settings) {
+	this->settings = settings;
+	solidTileIds.insert(settings.solidTileIds.begin(), settings.solidTileIds.end());
+	if (!settings.bDecodeOnCallingThread) {
+		loaderThreads = std::make_unique<ThreadPool>(WORLD_LOADER_THREADS, "World loader");
+	}
+}
+
+WorldStreamer::~WorldStreamer() {
+	// Join before the decode targets go away
+	loaderThreads.reset();
+}
+
+bool WorldStreamer::Open(const std::string& filepath) {
+	if (!file.Open(filepath)) {
+		LOG_AT(ERROR, World, "Can't open region map {}", filepath);
+		return false;
+	}
+	data = file.GetData();
+	size = file.GetSize();
+	return ReadHeader();
+}
+
+bool WorldStreamer::Open(const uint8_t* data, size_t size) {
+	file.Close();
+	this->data = data;
+	this->size = size;
+	return ReadHeader();
+}
+
+bool WorldStreamer::ReadHeader() {
+	if (size < sizeof(RegionMapHeader)) {
+		LOG_AT(ERROR, World, "Region map is truncated");
+		return false;
+	}
+	std::memcpy(&header, data, sizeof(RegionMapHeader));
+	if (std::memcmp(header.magic, REGION_MAP_MAGIC, sizeof(REGION_MAP_MAGIC)) != 0 || header.version != REGION_MAP_VERSION || header.regionSize == 0) {
+		LOG_AT(ERROR, World, "Not a version {} region map", REGION_MAP_VERSION);
+		return false;
+	}
+
+	const size_t regionCount = static_cast<size_t>(header.regionColumns) * header.regionRows;
+	if (sizeof(RegionMapHeader) + regionCount * sizeof(RegionMapEntry) > size) {
+		LOG_AT(ERROR, World, "Region map is truncated");
+		return false;
+	}
+	entries.resize(regionCount);
+	std::memcpy(entries.data(), data + sizeof(RegionMapHeader), regionCount * sizeof(RegionMapEntry));
+	for (const RegionMapEntry& entry : entries) {
+		if (entry.offset + static_cast<uint64_t>(entry.columns) * entry.rows * sizeof(int32_t) > size) {
+			LOG_AT(ERROR, World, "Region map is truncated");
+			return false;
+		}
+	}
+
+	regions.clear();
+	regions.resize(regionCount);
+	LOG_AT(INFO, World, "Region map {}x{} tiles in {} regions", header.columns, header.rows, regionCount);
+	return true;
+}
+
+double WorldStreamer::GetRegionWorldSize() const {
+	return header.regionSize * settings.tileSize * settings.scale;
+}
+
+double WorldStreamer::GetRegionDistance(int regionX, int regionY, const glm::vec2& focus) const {
+	const double regionWorldSize = GetRegionWorldSize();
+	const double left = regionX * regionWorldSize;
+	const double top = regionY * regionWorldSize;
+	const double distanceX = std::max({ left - focus.x, focus.x - (left + regionWorldSize), 0.0 });
+	const double distanceY = std::max({ top - focus.y, focus.y - (top + regionWorldSize), 0.0 });
+	return std::max(distanceX, distanceY);
+}
+
+void WorldStreamer::RequestRegion(int regionIndex) {
+	Region& region = regions[regionIndex];
+	region.state = RegionState::Loading;
+	region.generation++;
+	loadingRegionCount++;
+	activeRegionIndices.push_back(regionIndex);
+
+	const uint32_t generation = region.generation;
+	if (settings.bDecodeOnCallingThread) {
+		DecodedRegion decodedRegion = DecodeRegion(regionIndex, generation);
+		std::lock_guard<std::mutex> lock(decodedRegionsMutex);
+		decodedRegions.push_back(std::move(decodedRegion));
+		return;
+	}
+	loaderThreads->Enqueue([this, regionIndex, generation]() {
+		DecodedRegion decodedRegion = DecodeRegion(regionIndex, generation);
+		std::lock_guard<std::mutex> lock(decodedRegionsMutex);
+		decodedRegions.push_back(std::move(decodedRegion));
+	});
+}
+
+WorldStreamer::DecodedRegion WorldStreamer::DecodeRegion(int regionIndex, uint32_t generation) const {
+	PROFILE_SCOPE("DecodeRegion");
+	const auto start = std::chrono::steady_clock::now();
+	const RegionMapEntry& entry = entries[regionIndex];
+
+	DecodedRegion decodedRegion;
+	decodedRegion.regionIndex = regionIndex;
+	decodedRegion.generation = generation;
+	decodedRegion.tiles.resize(static_cast<size_t>(entry.columns) * entry.rows);
+	std::memcpy(decodedRegion.tiles.data(), data + entry.offset, decodedRegion.tiles.size() * sizeof(int32_t));
+
+	// One collider per horizontal run of solid tiles instead of one per tile
+	if (!solidTileIds.empty()) {
+		for (int y = 0; y < static_cast<int>(entry.rows); y++) {
+			int runStart = -1;
+			for (int x = 0; x <= static_cast<int>(entry.columns); x++) {
+				const bool bIsSolid = x < static_cast<int>(entry.columns) && solidTileIds.count(decodedRegion.tiles[static_cast<size_t>(y) * entry.columns + x]) != 0;
+				if (bIsSolid && runStart < 0) {
+					runStart = x;
+				}
+				else if (!bIsSolid && runStart >= 0) {
+					decodedRegion.colliders.push_back({ runStart, y, x - runStart });
+					runStart = -1;
+				}
+			}
+		}
+	}
+
+	decodedRegion.decodeMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+	return decodedRegion;
+}
+
+void WorldStreamer::CreateRegionEntities(ECSManager& ecsManager, DecodedRegion& decodedRegion) {
+	Region& region = regions[decodedRegion.regionIndex];
+	const RegionMapEntry& entry = entries[decodedRegion.regionIndex];
+	const int regionX = decodedRegion.regionIndex % header.regionColumns;
+	const int regionY = decodedRegion.regionIndex / header.regionColumns;
+	const glm::vec2 origin(regionX * GetRegionWorldSize(), regionY * GetRegionWorldSize());
+	const double tileWorldSize = settings.tileSize * settings.scale;
+
+	Entity tilemap = ecsManager.CreateEntity();
+	tilemap.AddComponent<TransformComponent>(origin, glm::vec2(settings.scale, settings.scale), 0.0);
+	tilemap.AddComponent<TilemapComponent>(settings.tilesetAssetId, static_cast<int>(entry.columns), static_cast<int>(entry.rows), settings.tileSize, settings.tilesetColumns, std::move(decodedRegion.tiles));
+	tilemap.AddComponent<WorldRegionComponent>(decodedRegion.regionIndex);
+	region.entities.push_back(tilemap);
+
+	for (const RegionCollider& collider : decodedRegion.colliders) {
+		Entity colliderEntity = ecsManager.CreateEntity();
+		colliderEntity.AddComponent<TransformComponent>(origin + glm::vec2(collider.x * tileWorldSize, collider.y * tileWorldSize), glm::vec2(settings.scale, settings.scale), 0.0);
+		colliderEntity.AddComponent<BoxColliderComponent>(collider.width * settings.tileSize, settings.tileSize);
+		colliderEntity.AddComponent<WorldRegionComponent>(decodedRegion.regionIndex);
+		region.entities.push_back(colliderEntity);
+	}
+
+	region.state = RegionState::Resident;
+	region.sizeInBytes = static_cast<size_t>(entry.columns) * entry.rows * sizeof(int32_t) + decodedRegion.colliders.size() * sizeof(RegionCollider);
+	residentRegionCount++;
+	residentEntityCount += static_cast<int>(region.entities.size());
+	residentBytes += region.sizeInBytes;
+	loadedRegionCount++;
+	lastRegionDecodeMs = decodedRegion.decodeMs;
+}
+
+void WorldStreamer::SpawnDecodedRegions(ECSManager& ecsManager) {
+	std::vector<DecodedRegion> finishedRegions;
+	{
+		std::lock_guard<std::mutex> lock(decodedRegionsMutex);
+		finishedRegions.swap(decodedRegions);
+	}
+	for (DecodedRegion& decodedRegion : finishedRegions) {
+		Region& region = regions[decodedRegion.regionIndex];
+		if (region.state != RegionState::Loading || region.generation != decodedRegion.generation) {
+			continue;
+		}
+		loadingRegionCount--;
+		CreateRegionEntities(ecsManager, decodedRegion);
+	}
+}
+
+void WorldStreamer::UnloadRegion(int regionIndex) {
+	Region& region = regions[regionIndex];
+	if (region.state == RegionState::Unloaded) {
+		return;
+	}
+	if (region.state == RegionState::Loading) {
+		// The decode still finishes, its result is dropped because the generation moved on
+		region.generation++;
+		loadingRegionCount--;
+	}
+	else if (region.state == RegionState::Resident) {
+		for (Entity& entity : region.entities) {
+			// Something else may already have destroyed the entity and its id been reused
+			if (entity.bHasComponent<WorldRegionComponent>() && entity.GetComponent<WorldRegionComponent>().regionIndex == regionIndex) {
+				entity.Destroy();
+			}
+		}
+		residentRegionCount--;
+		residentEntityCount -= static_cast<int>(region.entities.size());
+		residentBytes -= region.sizeInBytes;
+		unloadedRegionCount++;
+		region.entities.clear();
+		region.sizeInBytes = 0;
+	}
+	region.state = RegionState::Unloaded;
+	activeRegionIndices.erase(std::find(activeRegionIndices.begin(), activeRegionIndices.end(), regionIndex));
+}
+
+void WorldStreamer::Update(ECSManager& ecsManager, const glm::vec2& focus) {
+	if (regions.empty()) {
+		return;
+	}
+
+	// Spawn what the loader threads finished since the last frame
+	SpawnDecodedRegions(ecsManager);
+
+	// Only the regions around the focus point are visited, the cost doesn't grow with the map
+	const double regionWorldSize = GetRegionWorldSize();
+	const double loadDistance = settings.viewDistance;
+	const double unloadDistance = settings.viewDistance + regionWorldSize * 0.5;
+	const int reach = static_cast<int>(std::ceil(unloadDistance / regionWorldSize)) + 1;
+	const int focusRegionX = static_cast<int>(std::floor(focus.x / regionWorldSize));
+	const int focusRegionY = static_cast<int>(std::floor(focus.y / regionWorldSize));
+
+	for (int regionY = std::max(0, focusRegionY - reach); regionY <= std::min(static_cast<int>(header.regionRows) - 1, focusRegionY + reach); regionY++) {
+		for (int regionX = std::max(0, focusRegionX - reach); regionX <= std::min(static_cast<int>(header.regionColumns) - 1, focusRegionX + reach); regionX++) {
+			const int regionIndex = regionY * header.regionColumns + regionX;
+			if (regions[regionIndex].state == RegionState::Unloaded && GetRegionDistance(regionX, regionY, focus) <= loadDistance) {
+				RequestRegion(regionIndex);
+			}
+		}
+	}
+
+	// Decoded right away, so they are spawned before the systems run this frame
+	if (settings.bDecodeOnCallingThread) {
+		SpawnDecodedRegions(ecsManager);
+	}
+
+	// Active regions can be anywhere after a jump of the focus point, so they are checked one by one
+	for (size_t i = activeRegionIndices.size(); i-- > 0;) {
+		const int regionIndex = activeRegionIndices[i];
+		const int regionX = regionIndex % header.regionColumns;
+		const int regionY = regionIndex / header.regionColumns;
+		if (GetRegionDistance(regionX, regionY, focus) > unloadDistance) {
+			UnloadRegion(regionIndex);
+		}
+	}
+}
+
+void WorldStreamer::UnloadAll() {
+	while (!activeRegionIndices.empty()) {
+		UnloadRegion(activeRegionIndices.back());
+	}
+}
+
+glm::vec2 WorldStreamer::GetWorldSize() const {
+	const double tileWorldSize = settings.tileSize * settings.scale;
+	return glm::vec2(header.columns * tileWorldSize, header.rows * tileWorldSize);
+}
+
+WorldStreamStats WorldStreamer::GetStats() const {
+	WorldStreamStats stats;
+	stats.totalRegions			= static_cast<int>(regions.size());
+	stats.residentRegions		= residentRegionCount;
+	stats.loadingRegions		= loadingRegionCount;
+	stats.residentEntities		= residentEntityCount;
+	stats.residentBytes			= residentBytes;
+	stats.regionsLoaded			= loadedRegionCount;
+	stats.regionsUnloaded		= unloadedRegionCount;
+	stats.lastRegionDecodeMs	= lastRegionDecodeMs;
+	return stats;
+}
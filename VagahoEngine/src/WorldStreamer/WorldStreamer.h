@@ -0,0 +1,136 @@
+#pragma once
+
+#include "../ECS/ECS.h"
+#include "../MapLoader/MapLoader.h"
+#include "../ThreadPool/ThreadPool.h"
+#include "../Utils/MappedFile.h"
+
+#include <glm/glm.hpp>
+
+#include <string>
+#include <vector>
+#include <unordered_set>
+#include <mutex>
+#include <memory>
+#include <cstdint>
+
+struct WorldStreamerSettings {
+	std::string tilesetAssetId;
+	int tileSize = 32;						// tile resolution in the tileset
+	int tilesetColumns = 1;
+	double scale = 1.0;
+	double viewDistance = 1024.0;			// world pixels around the focus point that have to be resident
+	std::vector<int> solidTileIds;			// tiles that get a box collider
+	bool bDecodeOnCallingThread = false;	// regions are resident in the Update that requests them, for reproducible replays
+};
+
+struct WorldStreamStats {
+	int totalRegions;
+	int residentRegions;
+	int loadingRegions;
+	int residentEntities;
+	size_t residentBytes;					// tile and collider data of the resident regions
+	uint64_t regionsLoaded;
+	uint64_t regionsUnloaded;
+	double lastRegionDecodeMs;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+/// WORLD STREAMER
+////////////////////////////////////////////////////////////////////////////////
+/// Keeps only the regions of a region map (.vworld) near a focus point alive.
+/// Regions inside viewDistance are decoded on loader threads and turned into a
+/// tilemap entity plus collider entities on the main thread. Regions further
+/// than viewDistance + half a region are unloaded again, the extra half region
+/// stops regions on the border from loading and unloading every frame.
+/// With bDecodeOnCallingThread the decode runs inside Update instead, replays
+/// rely on it to see the same entities at the same tick.
+/// Memory and load time depend on the view distance, not on the map size.
+////////////////////////////////////////////////////////////////////////////////
+class WorldStreamer {
+private:
+	enum class RegionState : uint8_t {
+		Unloaded,
+		Loading,
+		Resident
+	};
+
+	struct Region {
+		RegionState state = RegionState::Unloaded;
+		uint32_t generation = 0;			// bumped on every request and cancel, stale decodes are dropped
+		std::vector<Entity> entities;
+		size_t sizeInBytes = 0;
+	};
+
+	// Solid tiles of a region merged into horizontal runs, in tiles relative to the region
+	struct RegionCollider {
+		int x;
+		int y;
+		int width;
+	};
+
+	struct DecodedRegion {
+		int regionIndex;
+		uint32_t generation;
+		std::vector<int> tiles;
+		std::vector<RegionCollider> colliders;
+		double decodeMs;
+	};
+
+	WorldStreamerSettings settings;
+	std::unordered_set<int> solidTileIds;
+
+	MappedFile file;						// only used when the streamer opened a loose file
+	const uint8_t* data = nullptr;
+	size_t size = 0;
+	RegionMapHeader header = {};
+	std::vector<RegionMapEntry> entries;
+	std::vector<Region> regions;
+	std::vector<int> activeRegionIndices;	// loading or resident, so the unload pass doesn't scan the whole map
+
+	std::mutex decodedRegionsMutex;
+	std::vector<DecodedRegion> decodedRegions;
+
+	// Stats
+	int loadingRegionCount = 0;
+	int residentRegionCount = 0;
+	int residentEntityCount = 0;
+	size_t residentBytes = 0;
+	uint64_t loadedRegionCount = 0;
+	uint64_t unloadedRegionCount = 0;
+	double lastRegionDecodeMs = 0.0;
+
+	// Last member: destroyed (and joined) first, while the decode targets above still exist
+	std::unique_ptr<ThreadPool> loaderThreads;
+
+	bool ReadHeader();
+	double GetRegionWorldSize() const;
+	// Distance from the focus point to the region rectangle along the furthest axis
+	double GetRegionDistance(int regionX, int regionY, const glm::vec2& focus) const;
+
+	void RequestRegion(int regionIndex);
+	DecodedRegion DecodeRegion(int regionIndex, uint32_t generation) const;
+	void CreateRegionEntities(ECSManager& ecsManager, DecodedRegion& decodedRegion);
+	void SpawnDecodedRegions(ECSManager& ecsManager);
+	void UnloadRegion(int regionIndex);
+
+public:
+	WorldStreamer(const WorldStreamerSettings& settings);
+	~WorldStreamer();
+
+	WorldStreamer(const WorldStreamer&) = delete;
+	WorldStreamer& operator =(const WorldStreamer&) = delete;
+
+	// Open once per streamer, another world gets a new streamer
+	bool Open(const std::string& filepath);
+	// Stream from bytes owned by someone else (e.g. a mounted archive), they must outlive the streamer
+	bool Open(const uint8_t* data, size_t size);
+
+	// Request regions coming into view, spawn the decoded ones and unload the ones out of range
+	void Update(ECSManager& ecsManager, const glm::vec2& focus);
+	void UnloadAll();
+
+	// Whole map size in world pixels
+	glm::vec2 GetWorldSize() const;
+	WorldStreamStats GetStats() const;
+};
@@ -0,0 +1,209 @@
+#include "../../src/Logger/BinaryLogFormat.h"
+#include "../../src/Logger/LogFormat.h"
+#include "../../src/Logger/LogLevels.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+////////////////////////////////////////////////////////////////////////////////
+/// LOG DECODER
+////////////////////////////////////////////////////////////////////////////////
+/// Prints a binary log either as the text the log file would have had, or as
+/// JSON Lines (one object per record) for scripts.
+///   LogDecoder <file.vlog> [--json]
+////////////////////////////////////////////////////////////////////////////////
+namespace {
+
+	const char* const LEVEL_LABELS[] = { "[VERBOSE]", "[INFO   ]", "[WARNING]", "[ERROR  ]" };
+	const char* const LEVEL_NAMES[] = { "verbose", "info", "warning", "error" };
+	const char* const CATEGORY_NAMES[] = { "General", "ECS", "Assets", "Events", "Collision", "World", "Scripting" };
+	static_assert(std::size(CATEGORY_NAMES) == static_cast<size_t>(LogCategory::Count), "Category names are out of sync with LogCategory");
+
+	struct CallSite {
+		uint8_t level = INFO;
+		uint8_t category = 0;
+		uint32_t line = 0;
+		std::string file;
+		std::string format;
+	};
+
+	bool ReadString(const uint8_t*& cursor, const uint8_t* end, std::string& text) {
+		uint64_t length;
+		if (!ReadVarint(cursor, end, length) || length > static_cast<uint64_t>(end - cursor)) {
+			return false;
+		}
+		text.assign(reinterpret_cast<const char*>(cursor), static_cast<size_t>(length));
+		cursor += length;
+		return true;
+	}
+
+	const char* GetFilename(const std::string& path) {
+		const size_t separator = path.find_last_of("/\\");
+		return path.c_str() + (separator == std::string::npos ? 0 : separator + 1);
+	}
+
+	std::string FormatDateTime(std::time_t second) {
+		std::tm localTime;
+#ifdef _WIN32
+		localtime_s(&localTime, &second);
+#else
+		localtime_r(&second, &localTime);
+#endif
+		char dateTime[32];
+		std::strftime(dateTime, sizeof(dateTime), "%Y-%m-%d %H:%M:%S", &localTime);
+		return dateTime;
+	}
+
+	void AppendJsonString(std::string& output, const std::string& text) {
+		output += '"';
+		for (const char c : text) {
+			switch (c) {
+				case '"':	output += "\\\"";	break;
+				case '\\':	output += "\\\\";	break;
+				case '\n':	output += "\\n";	break;
+				case '\r':	output += "\\r";	break;
+				case '\t':	output += "\\t";	break;
+				default:
+					if (static_cast<unsigned char>(c) < 0x20) {
+						char escaped[8];
+						std::snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+						output += escaped;
+					}
+					else {
+						output += c;
+					}
+			}
+		}
+		output += '"';
+	}
+}
+
+int main(int argc, char* argv[]) {
+	if (argc < 2 || argc > 3 || (argc == 3 && std::strcmp(argv[2], "--json") != 0)) {
+		std::fprintf(stderr, "Usage: LogDecoder <file.vlog> [--json]\n");
+		return EXIT_FAILURE;
+	}
+	const bool bJson = argc == 3;
+
+	std::ifstream file(argv[1], std::ios::binary);
+	if (!file) {
+		std::fprintf(stderr, "Can't open %s\n", argv[1]);
+		return EXIT_FAILURE;
+	}
+	const std::vector<uint8_t> bytes((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+	BinaryLogHeader header;
+	if (bytes.size() < sizeof(header)) {
+		std::fprintf(stderr, "%s is not a binary log\n", argv[1]);
+		return EXIT_FAILURE;
+	}
+	std::memcpy(&header, bytes.data(), sizeof(header));
+	if (std::memcmp(header.magic, BINARY_LOG_MAGIC, sizeof(BINARY_LOG_MAGIC)) != 0 || header.version != BINARY_LOG_VERSION ||
+		header.clockNumerator <= 0 || header.clockDenominator <= 0) {
+		std::fprintf(stderr, "%s is not a version %u binary log\n", argv[1], BINARY_LOG_VERSION);
+		return EXIT_FAILURE;
+	}
+
+	std::vector<CallSite> callSites;
+	int64_t timestamp = header.startTimestamp;
+	std::string message;
+	std::string output;
+
+	const uint8_t* cursor = bytes.data() + sizeof(header);
+	const uint8_t* end = bytes.data() + bytes.size();
+	while (cursor < end) {
+		const BinaryLogChunk chunk = static_cast<BinaryLogChunk>(*cursor++);
+		if (chunk == BinaryLogChunk::CallSite) {
+			uint64_t id;
+			uint64_t line;
+			CallSite callSite;
+			if (!ReadVarint(cursor, end, id) || end - cursor < 2) {
+				break;
+			}
+			callSite.level = *cursor++;
+			callSite.category = *cursor++;
+			if (!ReadVarint(cursor, end, line) || !ReadString(cursor, end, callSite.file) || !ReadString(cursor, end, callSite.format) ||
+				id != callSites.size() || callSite.level > ERROR || callSite.category >= static_cast<uint8_t>(LogCategory::Count)) {
+				break;
+			}
+			callSite.line = static_cast<uint32_t>(line);
+			callSites.push_back(std::move(callSite));
+			continue;
+		}
+		if (chunk != BinaryLogChunk::Record) {
+			break;
+		}
+
+		uint64_t id;
+		uint64_t delta;
+		uint64_t sizeAndTruncated;
+		if (!ReadVarint(cursor, end, id) || !ReadVarint(cursor, end, delta) || !ReadVarint(cursor, end, sizeAndTruncated) || id >= callSites.size()) {
+			break;
+		}
+		const uint64_t payloadSize = sizeAndTruncated >> 1;
+		if (payloadSize > static_cast<uint64_t>(end - cursor)) {
+			break;
+		}
+		const CallSite& callSite = callSites[static_cast<size_t>(id)];
+		timestamp += ZigZagDecode(delta);
+
+		message.clear();
+		FormatLogMessage(callSite.format.c_str(), cursor, static_cast<size_t>(payloadSize), message);
+		if (sizeAndTruncated & 1) {
+			message += "...";
+		}
+		cursor += payloadSize;
+
+		// Ticks to whole seconds and milliseconds without overflowing for nanosecond clocks
+		const int64_t ticksPerSecond = header.clockDenominator / header.clockNumerator;
+		const std::time_t second = static_cast<std::time_t>(ticksPerSecond > 0 ? timestamp / ticksPerSecond : timestamp * header.clockNumerator);
+		const std::string dateTime = FormatDateTime(second);
+		const char* categoryName = CATEGORY_NAMES[callSite.category];
+
+		output.clear();
+		if (bJson) {
+			output += "{\"time\":";
+			AppendJsonString(output, dateTime);
+			output += ",\"timestamp\":" + std::to_string(timestamp);
+			output += ",\"level\":\"";
+			output += LEVEL_NAMES[callSite.level];
+			output += "\",\"category\":\"";
+			output += categoryName;
+			output += "\",\"file\":";
+			AppendJsonString(output, GetFilename(callSite.file));
+			output += ",\"line\":" + std::to_string(callSite.line);
+			output += ",\"format\":";
+			AppendJsonString(output, callSite.format);
+			output += ",\"message\":";
+			AppendJsonString(output, message);
+			output += "}\n";
+		}
+		else {
+			output += LEVEL_LABELS[callSite.level];
+			output += "[" + dateTime + "]";
+			if (callSite.category != 0) {
+				output += "[";
+				output += categoryName;
+				output += "]";
+			}
+			output += ":[File: ";
+			output += GetFilename(callSite.file);
+			output += ", Line: " + std::to_string(callSite.line) + "]: ";
+			output += message;
+			output += '\n';
+		}
+		std::fwrite(output.data(), 1, output.size(), stdout);
+	}
+
+	if (cursor < end) {
+		std::fprintf(stderr, "Corrupt or truncated log at byte %zu\n", static_cast<size_t>(cursor - bytes.data()));
+		return EXIT_FAILURE;
+	}
+	return EXIT_SUCCESS;
+}